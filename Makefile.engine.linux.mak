@@ -6,7 +6,7 @@ ASSEMBLY := engine
 EXTENSION := .so
 COMPILER_FLAGS := -g -fdeclspec -fPIC
 INCLUDE_FLAGS := -Iengine/src -I$(VULKAN_SDK)/include 
-LINKER_FLAGS := -g -shared -lvulkan -lxcb -lX11 -lX11-xcb -lglfw -lGL -lGLU -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
+LINKER_FLAGS := -g -shared -lpthread -lvulkan -lxcb -lX11 -lX11-xcb -lglfw -lGL -lGLU -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
 DEFINES := -D_DEBUG -DOEXPORT
 
 # Make does not offer a recursive wildcard function, so here's one:
@@ -8,10 +8,12 @@ layout(binding = 0) uniform uniform_object {
 
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec2 inTexCoord;
+// Per instance, locations 2-5
+layout(location = 2) in mat4 in_model;
 
 layout(location = 0) out vec2 fragTexCoord;
 
 void main() {
-        gl_Position = ubo.projection * ubo.view * vec4(in_position, 1.0);  
+        gl_Position = ubo.projection * ubo.view * in_model * vec4(in_position, 1.0);  
      fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -2,20 +2,98 @@
 
 #include "core/logger.h"
 #include "core/omemory.h"
+#include "memory/virtual_arena.h"
+#include "platform/platform.h"
 
-void *_darray_create(u64 length, u64 stride) {
-  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
-  u64 array_size = length * stride;
-  u64 *new_array = oallocate(header_size + array_size, MEMORY_TAG_DARRAY);
-  oset_memory(new_array, 0, header_size + array_size);
+static void *darray_init_header(u64 *new_array, u64 length, u64 stride) {
   new_array[DARRAY_CAPACITY] = length;
   new_array[DARRAY_LENGTH] = 0;
   new_array[DARRAY_STRIDE] = stride;
+  new_array[DARRAY_RESERVED] = 0;
   return (void *)(new_array + DARRAY_FIELD_LENGTH);
 }
 
+/**
+ * @brief Rebuilds the arena behind a virtual darray from its header. The
+ * whole capacity is committed, rounded up to the page size.
+ */
+static virtual_arena darray_arena(u64 *header) {
+  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+  u64 page_size = platform_get_page_size();
+  u64 stride = header[DARRAY_STRIDE];
+  u64 committed = header_size + header[DARRAY_CAPACITY] * stride;
+  u64 reserved = header_size + header[DARRAY_RESERVED] * stride;
+  virtual_arena arena;
+  arena.memory = header;
+  arena.committed_size = (committed + page_size - 1) & ~(page_size - 1);
+  arena.reserved_size = (reserved + page_size - 1) & ~(page_size - 1);
+  return arena;
+}
+
+/**
+ * @brief Grows a virtual darray in place to at least capacity elements, or
+ * to everything already committed if that's more.
+ */
+static b8 darray_commit(u64 *header, u64 capacity) {
+  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+  u64 stride = header[DARRAY_STRIDE];
+  virtual_arena arena = darray_arena(header);
+  if (!virtual_arena_commit(&arena, header_size + capacity * stride)) {
+    return false;
+  }
+  capacity = (arena.committed_size - header_size) / stride;
+  if (capacity > header[DARRAY_RESERVED]) {
+    capacity = header[DARRAY_RESERVED];
+  }
+  header[DARRAY_CAPACITY] = capacity;
+  return true;
+}
+
+void *_darray_create(u64 length, u64 stride) {
+  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+  u64 array_size = length * stride;
+  // oallocate hands back zeroed memory already.
+  u64 *new_array = oallocate(header_size + array_size, MEMORY_TAG_DARRAY);
+  return darray_init_header(new_array, length, stride);
+}
+
+void *_darray_create_uninit(u64 length, u64 stride) {
+  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+  u64 array_size = length * stride;
+  u64 *new_array =
+      oallocate_uninit(header_size + array_size, MEMORY_TAG_DARRAY);
+  return darray_init_header(new_array, length, stride);
+}
+
+void *_darray_create_virtual(u64 max_length, u64 stride) {
+  if (max_length == 0 || stride == 0) {
+    OERROR("_darray_create_virtual requires a non-zero length and stride.");
+    return 0;
+  }
+  u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+  virtual_arena arena;
+  if (!virtual_arena_create(header_size + max_length * stride, &arena)) {
+    return 0;
+  }
+  // Commit the header's page; whatever fits alongside it is the capacity.
+  if (!virtual_arena_commit(&arena, header_size)) {
+    virtual_arena_destroy(&arena);
+    return 0;
+  }
+  u64 *header = arena.memory;
+  darray_init_header(header, 0, stride);
+  header[DARRAY_RESERVED] = max_length;
+  darray_commit(header, 0);
+  return header + DARRAY_FIELD_LENGTH;
+}
+
 void _darray_destroy(void *array) {
-  u64 *header = (u64 *)array - DARRAY_FIELD_LENGTH;
+  u64 *header = darray_header(array);
+  if (header[DARRAY_RESERVED]) {
+    virtual_arena arena = darray_arena(header);
+    virtual_arena_destroy(&arena);
+    return;
+  }
   u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
   u64 total_size =
       header_size + header[DARRAY_CAPACITY] * header[DARRAY_STRIDE];
@@ -23,48 +101,160 @@ void _darray_destroy(void *array) {
 }
 
 u64 _darray_field_get(void *array, u64 field) {
-  u64 *header = (u64 *)array - DARRAY_FIELD_LENGTH;
-  return header[field];
+  return darray_header(array)[field];
 }
 
 void _darray_field_set(void *array, u64 field, u64 value) {
-  u64 *header = (u64 *)array - DARRAY_FIELD_LENGTH;
-  header[field] = value;
+  darray_header(array)[field] = value;
 }
 
-void *_darray_resize(void *array) {
-  u64 length = darray_length(array);
-  u64 stride = darray_stride(array);
-  void *temp =
-      _darray_create((DARRAY_RESIZE_FACTOR * darray_capacity(array)), stride);
+/** @brief Moves the elements into a new block of exactly capacity. */
+static void *darray_reallocate(void *array, u64 capacity) {
+  u64 *header = darray_header(array);
+  u64 length = header[DARRAY_LENGTH];
+  u64 stride = header[DARRAY_STRIDE];
+  // Everything up to length is copied over, and nothing past it is readable.
+  void *temp = _darray_create_uninit(capacity, stride);
   ocopy_memory(temp, array, length * stride);
-
-  _darray_field_set(temp, DARRAY_LENGTH, length);
+  darray_header(temp)[DARRAY_LENGTH] = length;
   _darray_destroy(array);
   return temp;
 }
 
+/**
+ * @brief Grows array to hold at least min_capacity elements, by at least the
+ * resize factor. Virtual darrays grow in place and stop at their reservation;
+ * check the capacity afterwards.
+ */
+static void *darray_grow(void *array, u64 min_capacity) {
+  u64 *header = darray_header(array);
+  u64 capacity = header[DARRAY_CAPACITY];
+  u64 new_capacity = capacity * DARRAY_RESIZE_FACTOR;
+  if (new_capacity < min_capacity) {
+    new_capacity = min_capacity;
+  }
+
+  if (header[DARRAY_RESERVED]) {
+    // A failed commit leaves capacity as is.
+    if (min_capacity > header[DARRAY_RESERVED]) {
+      OERROR("darray - virtual darray is full at %llu elements.",
+             header[DARRAY_RESERVED]);
+      return array;
+    }
+    if (new_capacity > header[DARRAY_RESERVED]) {
+      new_capacity = header[DARRAY_RESERVED];
+    }
+    darray_commit(header, new_capacity);
+    return array;
+  }
+
+  if (new_capacity < DARRAY_MIN_GROW_CAPACITY) {
+    new_capacity = DARRAY_MIN_GROW_CAPACITY;
+  }
+  return darray_reallocate(array, new_capacity);
+}
+
+void *_darray_resize(void *array) {
+  return darray_grow(array, darray_capacity(array) + 1);
+}
+
+void *_darray_reserve(void *array, u64 capacity) {
+  if (capacity <= darray_capacity(array)) {
+    return array;
+  }
+  if (darray_header(array)[DARRAY_RESERVED]) {
+    return darray_grow(array, capacity);
+  }
+  return darray_reallocate(array, capacity);
+}
+
+void *_darray_shrink_to_fit(void *array) {
+  u64 *header = darray_header(array);
+  if (header[DARRAY_LENGTH] == header[DARRAY_CAPACITY]) {
+    return array;
+  }
+  if (header[DARRAY_RESERVED]) {
+    // Hand back whole pages past the last element; the page holding it stays.
+    u64 header_size = DARRAY_FIELD_LENGTH * sizeof(u64);
+    virtual_arena arena = darray_arena(header);
+    virtual_arena_decommit(
+        &arena, header_size + header[DARRAY_LENGTH] * header[DARRAY_STRIDE]);
+    header[DARRAY_CAPACITY] =
+        (arena.committed_size - header_size) / header[DARRAY_STRIDE];
+    if (header[DARRAY_CAPACITY] > header[DARRAY_RESERVED]) {
+      header[DARRAY_CAPACITY] = header[DARRAY_RESERVED];
+    }
+    return array;
+  }
+  return darray_reallocate(array, header[DARRAY_LENGTH]);
+}
+
 void *_darray_push(void *array, const void *value_ptr) {
-  u64 length = darray_length(array);
+  u64 *header = darray_header(array);
+  u64 length = header[DARRAY_LENGTH];
+  u64 stride = header[DARRAY_STRIDE];
+  if (length >= header[DARRAY_CAPACITY]) {
+    array = darray_grow(array, length + 1);
+    header = darray_header(array);
+    // A full virtual darray can't grow.
+    if (length >= header[DARRAY_CAPACITY]) {
+      return array;
+    }
+  }
+
+  ocopy_memory((u8 *)array + length * stride, value_ptr, stride);
+  header[DARRAY_LENGTH] = length + 1;
+  return array;
+}
+
+void *_darray_push_n(void *array, const void *values, u64 count) {
+  u64 *header = darray_header(array);
+  u64 length = header[DARRAY_LENGTH];
+  u64 stride = header[DARRAY_STRIDE];
+  if (length + count > header[DARRAY_CAPACITY]) {
+    array = darray_grow(array, length + count);
+    header = darray_header(array);
+    if (length + count > header[DARRAY_CAPACITY]) {
+      return array;
+    }
+  }
+
+  ocopy_memory((u8 *)array + length * stride, values, count * stride);
+  header[DARRAY_LENGTH] = length + count;
+  return array;
+}
+
+void *_darray_append_array(void *array, void *other) {
   u64 stride = darray_stride(array);
-  if (length >= darray_capacity(array)) {
-    array = _darray_resize(array);
+  if (darray_stride(other) != stride) {
+    OERROR("_darray_append_array - stride mismatch (%llu vs %llu).", stride,
+           darray_stride(other));
+    return array;
+  }
+  u64 count = darray_length(other);
+  if (other != array) {
+    return _darray_push_n(array, other, count);
   }
 
-  u64 addr = (u64)array;
-  addr += (length * stride);
-  ocopy_memory((void *)addr, value_ptr, stride);
-  _darray_field_set(array, DARRAY_LENGTH, length + 1);
+  // Appending to itself: growing may move the source, so copy afterwards.
+  u64 length = darray_length(array);
+  if (length + count > darray_capacity(array)) {
+    array = darray_grow(array, length + count);
+    if (length + count > darray_capacity(array)) {
+      return array;
+    }
+  }
+  ocopy_memory((u8 *)array + length * stride, array, count * stride);
+  darray_length_set(array, length + count);
   return array;
 }
 
 void _darray_pop(void *array, void *dest) {
-  u64 length = darray_length(array);
-  u64 stride = darray_stride(array);
-  u64 addr = (u64)(array);
-  addr += ((length - 1) * stride);
-  ocopy_memory(dest, (void *)addr, stride);
-  _darray_field_set(array, DARRAY_LENGTH, length - 1);
+  u64 *header = darray_header(array);
+  u64 length = header[DARRAY_LENGTH];
+  u64 stride = header[DARRAY_STRIDE];
+  ocopy_memory(dest, (u8 *)array + (length - 1) * stride, stride);
+  header[DARRAY_LENGTH] = length - 1;
 }
 
 void *_darray_pop_at(void *array, u64 index, void *dest) {
@@ -79,40 +269,64 @@ void *_darray_pop_at(void *array, u64 index, void *dest) {
   u64 addr = (u64)array;
   ocopy_memory(dest, (void *)(addr + (index * stride)), stride);
 
-  // If not least element, snip out the entry
+  // If not the last element, close the gap with the elements after it.
   if (index != length - 1) {
-    ocopy_memory((void *)(addr + (index * stride)),
+    omove_memory((void *)(addr + (index * stride)),
                  (void *)(addr + ((index + 1) * stride)),
-                 stride * (length - index));
+                 stride * (length - index - 1));
   }
 
-  _darray_field_set(array, DARRAY_LENGTH, length - 1);
+  darray_length_set(array, length - 1);
   return array;
 }
 
+void _darray_remove_swap(void *array, u64 index, void *dest) {
+  u64 *header = darray_header(array);
+  u64 length = header[DARRAY_LENGTH];
+  u64 stride = header[DARRAY_STRIDE];
+  if (index >= length) {
+    OERROR("Index outside the bounds of this array. Length: %i, index: %i",
+           length, index);
+    return;
+  }
+
+  u8 *element = (u8 *)array + index * stride;
+  if (dest) {
+    ocopy_memory(dest, element, stride);
+  }
+  if (index != length - 1) {
+    ocopy_memory(element, (u8 *)array + (length - 1) * stride, stride);
+  }
+  header[DARRAY_LENGTH] = length - 1;
+}
+
 void *_darray_insert_at(void *array, u64 index, void *value_ptr) {
   u64 length = darray_length(array);
   u64 stride = darray_stride(array);
-  if (index >= length) {
+  // Inserting at length appends.
+  if (index > length) {
     OERROR("Index outside the bounds of this array. Length: %i, index: %i",
            length, index);
     return array;
   }
 
   if (length >= darray_capacity(array)) {
-    array = _darray_resize(array);
+    array = darray_grow(array, length + 1);
+    if (length >= darray_capacity(array)) {
+      return array;
+    }
   }
 
   u64 addr = (u64)array;
 
-  // If not least element, copy the rest outward
-  if (index != length - 1) {
-    ocopy_memory((void *)(addr + ((index + 1) * stride)),
+  // Unless appending, shift the elements from index onward up by one.
+  if (index != length) {
+    omove_memory((void *)(addr + ((index + 1) * stride)),
                  (void *)(addr + (index * stride)), stride * (length - index));
   }
 
   ocopy_memory((void *)(addr + (index * stride)), value_ptr, stride);
 
-  _darray_field_set(array, DARRAY_LENGTH, length + 1);
+  darray_length_set(array, length + 1);
   return array;
 }
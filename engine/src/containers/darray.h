@@ -7,41 +7,92 @@
   u64 capacity = num elements that can be held
   u64 length = num elements currently held
   u64 stride = size of each element
+  u64 reserved = max elements of a virtual darray, 0 otherwise
   void* elements
 */
 
-enum { DARRAY_CAPACITY, DARRAY_LENGTH, DARRAY_STRIDE, DARRAY_FIELD_LENGTH };
+enum {
+  DARRAY_CAPACITY,
+  DARRAY_LENGTH,
+  DARRAY_STRIDE,
+  DARRAY_RESERVED,
+  DARRAY_FIELD_LENGTH
+};
 
 OAPI void *_darray_create(u64 length, u64 stride);
+OAPI void *_darray_create_uninit(u64 length, u64 stride);
+OAPI void *_darray_create_virtual(u64 max_length, u64 stride);
 OAPI void _darray_destroy(void *array);
 
 OAPI u64 _darray_field_get(void *array, u64 field);
 OAPI void _darray_field_set(void *array, u64 field, u64 value);
 
 OAPI void *_darray_resize(void *array);
+OAPI void *_darray_reserve(void *array, u64 capacity);
+OAPI void *_darray_shrink_to_fit(void *array);
 
 OAPI void *_darray_push(void *array, const void *value_ptr);
+OAPI void *_darray_push_n(void *array, const void *values, u64 count);
+OAPI void *_darray_append_array(void *array, void *other);
 OAPI void _darray_pop(void *array, void *dest);
 
 OAPI void *_darray_insert_at(void *array, u64 index, void *value_ptr);
 OAPI void *_darray_pop_at(void *array, u64 index, void *dest);
+OAPI void _darray_remove_swap(void *array, u64 index, void *dest);
+
+/** @brief The header in front of a darray's elements. */
+OINLINE u64 *darray_header(void *array) {
+  return (u64 *)array - DARRAY_FIELD_LENGTH;
+}
 
 #define DARRAY_DEFAULT_CAPACITY 1
 #define DARRAY_RESIZE_FACTOR 2
+// The smallest capacity a darray grows to, so small arrays skip the 1, 2, 4
+// steps.
+#define DARRAY_MIN_GROW_CAPACITY 8
 
 #define darray_create(type)                                                    \
   _darray_create(DARRAY_DEFAULT_CAPACITY, sizeof(type))
 
-#define darray_reserve(type, capacity) _darray_create(capacity, sizeof(type))
+#define darray_create_with_capacity(type, capacity)                            \
+  _darray_create(capacity, sizeof(type))
+
+// Like darray_create_with_capacity, but the elements are not zeroed.
+#define darray_create_with_capacity_uninit(type, capacity)                     \
+  _darray_create_uninit(capacity, sizeof(type))
+
+/**
+ * Creates a darray over reserved address space for up to max_length elements.
+ * It grows by committing more pages in place, so it never moves: element
+ * pointers stay valid and nothing is copied. Pushing past max_length fails.
+ * Returns 0 if the address space couldn't be reserved. Its memory isn't
+ * counted under MEMORY_TAG_DARRAY.
+ */
+#define darray_create_virtual(type, max_length)                                \
+  _darray_create_virtual(max_length, sizeof(type))
 
 #define darray_destroy(array) _darray_destroy(array);
 
+/** Grows array so capacity elements fit without another resize. */
+#define darray_reserve(array, capacity) array = _darray_reserve(array, capacity)
+
+/** Frees any capacity past the current length. */
+#define darray_shrink_to_fit(array) array = _darray_shrink_to_fit(array)
+
 #define darray_push(array, value)                                              \
   {                                                                            \
     typeof(value) temp = value;                                                \
     array = _darray_push(array, &temp);                                        \
   }
 
+/** Copies count elements from values_ptr onto the end, growing at most once. */
+#define darray_push_n(array, values_ptr, count)                                \
+  array = _darray_push_n(array, values_ptr, count)
+
+/** Appends every element of the darray other, which may be array itself. */
+#define darray_append_array(array, other)                                      \
+  array = _darray_append_array(array, other)
+
 #define darray_pop(array, value_ptr) _darray_pop(array, value_ptr)
 
 #define darray_insert_at(array, index, value)                                  \
@@ -53,13 +104,20 @@ OAPI void *_darray_pop_at(void *array, u64 index, void *dest);
 #define darray_pop_at(array, index, value_ptr)                                 \
   _darray_pop_at(array, index, value_ptr)
 
-#define darray_clear(array) _darray_field_set(array, DARRAY_LENGTH, 0);
+/**
+ * Removes the element at index in O(1) by moving the last element into its
+ * place, so order isn't kept. value_ptr may be 0.
+ */
+#define darray_remove_swap(array, index, value_ptr)                            \
+  _darray_remove_swap(array, index, value_ptr)
+
+#define darray_clear(array) darray_header(array)[DARRAY_LENGTH] = 0;
 
-#define darray_capacity(array) _darray_field_get(array, DARRAY_CAPACITY)
+#define darray_capacity(array) (darray_header(array)[DARRAY_CAPACITY])
 
-#define darray_length(array) _darray_field_get(array, DARRAY_LENGTH)
+#define darray_length(array) (darray_header(array)[DARRAY_LENGTH])
 
-#define darray_stride(array) _darray_field_get(array, DARRAY_STRIDE)
+#define darray_stride(array) (darray_header(array)[DARRAY_STRIDE])
 
 #define darray_length_set(array, value)                                        \
-  _darray_field_set(array, DARRAY_LENGTH, value)
+  darray_header(array)[DARRAY_LENGTH] = (value)
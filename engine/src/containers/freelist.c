@@ -0,0 +1,270 @@
+#include "freelist.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+typedef struct freelist_node {
+  u64 offset;
+  u64 size;
+  struct freelist_node *next;
+} freelist_node;
+
+typedef struct internal_state {
+  u64 total_size;
+  u64 max_entries;
+  // Free blocks, sorted by offset
+  freelist_node *head;
+  // Nodes not currently tracking a free block
+  freelist_node *unused;
+  freelist_node *nodes;
+} internal_state;
+
+// Lower bound on tracked blocks so small lists are still usable.
+#define FREELIST_MIN_ENTRIES 20
+
+static freelist_node *get_node(internal_state *state);
+static void return_node(internal_state *state, freelist_node *node);
+
+void freelist_create(u64 total_size, u64 *memory_requirement, void *memory,
+                     freelist *out_list) {
+  // Enough nodes to track a reasonable number of free blocks for the size
+  u64 max_entries = total_size / (sizeof(void *) * sizeof(freelist_node));
+  if (max_entries < FREELIST_MIN_ENTRIES) {
+    max_entries = FREELIST_MIN_ENTRIES;
+  }
+
+  *memory_requirement =
+      sizeof(internal_state) + (sizeof(freelist_node) * max_entries);
+  if (!memory) {
+    return;
+  }
+
+  out_list->memory = memory;
+  ozero_memory(out_list->memory, *memory_requirement);
+
+  internal_state *state = out_list->memory;
+  state->nodes = (void *)((u8 *)out_list->memory + sizeof(internal_state));
+  state->max_entries = max_entries;
+  state->total_size = total_size;
+
+  freelist_clear(out_list);
+}
+
+void freelist_destroy(freelist *list) {
+  if (list && list->memory) {
+    // Memory is owned by the caller, just invalidate it.
+    internal_state *state = list->memory;
+    ozero_memory(list->memory, sizeof(internal_state) +
+                                   sizeof(freelist_node) * state->max_entries);
+    list->memory = 0;
+  }
+}
+
+b8 freelist_allocate_block(freelist *list, u64 size, u64 *out_offset) {
+  if (!list || !out_offset || !list->memory || size == 0) {
+    return false;
+  }
+
+  internal_state *state = list->memory;
+  freelist_node *node = state->head;
+  freelist_node *previous = 0;
+  while (node) {
+    if (node->size == size) {
+      // Exact match, the whole node is used up.
+      *out_offset = node->offset;
+      if (previous) {
+        previous->next = node->next;
+      } else {
+        state->head = node->next;
+      }
+      return_node(state, node);
+      return true;
+    } else if (node->size > size) {
+      // Take from the front of the block.
+      *out_offset = node->offset;
+      node->size -= size;
+      node->offset += size;
+      return true;
+    }
+
+    previous = node;
+    node = node->next;
+  }
+
+  u64 free_space = freelist_free_space(list);
+  OWARN("freelist_allocate_block - no block with enough free space found "
+        "(requested: %lluB, available: %lluB).",
+        size, free_space);
+  return false;
+}
+
+b8 freelist_free_block(freelist *list, u64 size, u64 offset) {
+  if (!list || !list->memory || !size) {
+    return false;
+  }
+
+  internal_state *state = list->memory;
+  if (offset + size > state->total_size) {
+    OERROR("freelist_free_block - range [%llu, %llu) is outside of the list "
+           "(size %llu).",
+           offset, offset + size, state->total_size);
+    return false;
+  }
+
+  // Find the free blocks on either side of the range.
+  freelist_node *previous = 0;
+  freelist_node *node = state->head;
+  while (node && node->offset < offset) {
+    previous = node;
+    node = node->next;
+  }
+
+  // Overlapping either neighbour means this range was never allocated.
+  if ((previous && previous->offset + previous->size > offset) ||
+      (node && offset + size > node->offset)) {
+    OERROR("freelist_free_block - range [%llu, %llu) overlaps free space. "
+           "Possible double free.",
+           offset, offset + size);
+    return false;
+  }
+
+  b8 joins_previous = previous && previous->offset + previous->size == offset;
+  b8 joins_next = node && offset + size == node->offset;
+
+  if (joins_previous && joins_next) {
+    // Fills the gap between two free blocks; merge all three.
+    previous->size += size + node->size;
+    previous->next = node->next;
+    return_node(state, node);
+  } else if (joins_previous) {
+    previous->size += size;
+  } else if (joins_next) {
+    node->offset = offset;
+    node->size += size;
+  } else {
+    freelist_node *new_node = get_node(state);
+    if (!new_node) {
+      OERROR("freelist_free_block - out of nodes to track free blocks. The "
+             "range [%llu, %llu) is lost.",
+             offset, offset + size);
+      return false;
+    }
+    new_node->offset = offset;
+    new_node->size = size;
+    new_node->next = node;
+    if (previous) {
+      previous->next = new_node;
+    } else {
+      state->head = new_node;
+    }
+  }
+
+  return true;
+}
+
+b8 freelist_resize(freelist *list, u64 new_size) {
+  if (!list || !list->memory) {
+    return false;
+  }
+
+  internal_state *state = list->memory;
+  if (new_size < state->total_size) {
+    OERROR("freelist_resize - shrinking is not supported (%llu -> %llu).",
+           state->total_size, new_size);
+    return false;
+  }
+  if (new_size == state->total_size) {
+    return true;
+  }
+
+  u64 old_size = state->total_size;
+  state->total_size = new_size;
+  if (!freelist_free_block(list, new_size - old_size, old_size)) {
+    state->total_size = old_size;
+    return false;
+  }
+  return true;
+}
+
+void freelist_clear(freelist *list) {
+  if (!list || !list->memory) {
+    return;
+  }
+
+  internal_state *state = list->memory;
+
+  // Chain every node into the unused list.
+  state->unused = 0;
+  for (u64 i = state->max_entries; i > 0; --i) {
+    freelist_node *node = &state->nodes[i - 1];
+    node->offset = 0;
+    node->size = 0;
+    node->next = state->unused;
+    state->unused = node;
+  }
+
+  // One block covering everything.
+  state->head = get_node(state);
+  state->head->offset = 0;
+  state->head->size = state->total_size;
+  state->head->next = 0;
+}
+
+u64 freelist_free_space(freelist *list) {
+  if (!list || !list->memory) {
+    return 0;
+  }
+
+  u64 running_total = 0;
+  internal_state *state = list->memory;
+  freelist_node *node = state->head;
+  while (node) {
+    running_total += node->size;
+    node = node->next;
+  }
+
+  return running_total;
+}
+
+void freelist_get_stats(freelist *list, freelist_stats *out_stats) {
+  if (!out_stats) {
+    return;
+  }
+  ozero_memory(out_stats, sizeof(freelist_stats));
+  if (!list || !list->memory) {
+    return;
+  }
+
+  internal_state *state = list->memory;
+  out_stats->total_size = state->total_size;
+  freelist_node *node = state->head;
+  while (node) {
+    out_stats->free_space += node->size;
+    out_stats->free_block_count++;
+    if (node->size > out_stats->largest_free_block) {
+      out_stats->largest_free_block = node->size;
+    }
+    node = node->next;
+  }
+
+  if (out_stats->free_space) {
+    out_stats->fragmentation = 1.0f - ((f32)out_stats->largest_free_block /
+                                       (f32)out_stats->free_space);
+  }
+}
+
+static freelist_node *get_node(internal_state *state) {
+  freelist_node *node = state->unused;
+  if (node) {
+    state->unused = node->next;
+    node->next = 0;
+  }
+  return node;
+}
+
+static void return_node(internal_state *state, freelist_node *node) {
+  node->offset = 0;
+  node->size = 0;
+  node->next = state->unused;
+  state->unused = node;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief An offset allocator over a range of [0, total_size). It does not own
+ * or touch the memory it manages, which makes it suitable for sub-allocating
+ * GPU buffers. Free blocks are kept sorted by offset and adjacent blocks are
+ * coalesced on free.
+ */
+typedef struct freelist {
+  void *memory;
+} freelist;
+
+/**
+ * @brief Snapshot of the state of a freelist, used to track fragmentation.
+ */
+typedef struct freelist_stats {
+  u64 total_size;
+  u64 free_space;
+  u64 largest_free_block;
+  u32 free_block_count;
+  /** @brief 0 when all free space is contiguous, approaching 1 as free space
+   * is split into many small blocks. */
+  f32 fragmentation;
+} freelist_stats;
+
+/**
+ * @brief Creates a new freelist. Call twice; once with memory=0 to obtain the
+ * memory requirement, and again passing a block of that size.
+ * @param total_size The size of the range to be managed.
+ * @param memory_requirement Filled with the memory required by the freelist.
+ * @param memory A block of memory_requirement bytes, or 0.
+ * @param out_list The freelist to be initialized.
+ */
+OAPI void freelist_create(u64 total_size, u64 *memory_requirement,
+                          void *memory, freelist *out_list);
+OAPI void freelist_destroy(freelist *list);
+
+/**
+ * @brief Finds the first free block large enough for size and reserves it.
+ * @returns True on success, false if no block large enough exists.
+ */
+OAPI b8 freelist_allocate_block(freelist *list, u64 size, u64 *out_offset);
+
+/**
+ * @brief Returns a previously allocated range to the list, merging it with
+ * any neighbouring free blocks.
+ * @returns False if the range overlaps free space (i.e. a double free) or
+ * the list has run out of nodes to track free blocks.
+ */
+OAPI b8 freelist_free_block(freelist *list, u64 size, u64 offset);
+
+/**
+ * @brief Grows the managed range to new_size. The newly available space is
+ * appended to (or merged into) the last free block. Shrinking is not
+ * supported.
+ */
+OAPI b8 freelist_resize(freelist *list, u64 new_size);
+
+/** @brief Marks the entire range as free again. */
+OAPI void freelist_clear(freelist *list);
+
+OAPI u64 freelist_free_space(freelist *list);
+
+OAPI void freelist_get_stats(freelist *list, freelist_stats *out_stats);
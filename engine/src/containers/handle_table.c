@@ -0,0 +1,180 @@
+#include "handle_table.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+static void handle_table_grow(handle_table *table, u32 new_capacity);
+
+static u32 next_generation(u32 generation) {
+  generation = (generation + 1) & HANDLE_GENERATION_MASK;
+  // Generation 0 is never handed out, so handle 0 is never valid.
+  return generation ? generation : 1;
+}
+
+b8 handle_table_create(u64 element_size, u32 initial_capacity,
+                       handle_table *out_table) {
+  if (!out_table || element_size == 0) {
+    OERROR("handle_table_create requires a table and a non-zero element "
+           "size.");
+    return false;
+  }
+  ozero_memory(out_table, sizeof(handle_table));
+  out_table->element_size = element_size;
+  if (initial_capacity == 0) {
+    initial_capacity = 1;
+  }
+  handle_table_grow(out_table, initial_capacity);
+  return true;
+}
+
+void handle_table_destroy(handle_table *table) {
+  if (!table) {
+    return;
+  }
+  u32 capacity = table->capacity;
+  ofree(table->elements, table->element_size * capacity, MEMORY_TAG_ARRAY);
+  ofree(table->dense_handles, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+  ofree(table->generations, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+  ofree(table->dense_indices, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+  ofree(table->free_slots, sizeof(u32) * capacity, MEMORY_TAG_ARRAY);
+  ozero_memory(table, sizeof(handle_table));
+}
+
+u32 handle_table_insert(handle_table *table, const void *element) {
+  if (table->free_count == 0) {
+    if (table->capacity >= HANDLE_TABLE_MAX_CAPACITY) {
+      OERROR("handle_table_insert - table is at its maximum capacity of %u.",
+             HANDLE_TABLE_MAX_CAPACITY);
+      return INVALID_ID;
+    }
+    u32 new_capacity = table->capacity * 2;
+    if (new_capacity > HANDLE_TABLE_MAX_CAPACITY) {
+      new_capacity = HANDLE_TABLE_MAX_CAPACITY;
+    }
+    handle_table_grow(table, new_capacity);
+  }
+
+  u32 slot = table->free_slots[--table->free_count];
+  u32 dense_index = table->count++;
+  u32 handle = (table->generations[slot] << HANDLE_INDEX_BITS) | slot;
+  table->dense_indices[slot] = dense_index;
+  table->dense_handles[dense_index] = handle;
+
+  void *dest = (u8 *)table->elements + (dense_index * table->element_size);
+  if (element) {
+    ocopy_memory(dest, element, table->element_size);
+  } else {
+    ozero_memory(dest, table->element_size);
+  }
+  return handle;
+}
+
+b8 handle_table_remove(handle_table *table, u32 handle, void *out_element) {
+  if (!handle_table_is_valid(table, handle)) {
+    return false;
+  }
+
+  u32 slot = HANDLE_INDEX(handle);
+  u32 dense_index = table->dense_indices[slot];
+  u8 *removed = (u8 *)table->elements + (dense_index * table->element_size);
+  if (out_element) {
+    ocopy_memory(out_element, removed, table->element_size);
+  }
+
+  // Move the last element into the hole to keep storage dense.
+  u32 last_index = table->count - 1;
+  if (dense_index != last_index) {
+    u8 *last = (u8 *)table->elements + (last_index * table->element_size);
+    ocopy_memory(removed, last, table->element_size);
+    u32 moved_handle = table->dense_handles[last_index];
+    table->dense_handles[dense_index] = moved_handle;
+    table->dense_indices[HANDLE_INDEX(moved_handle)] = dense_index;
+  }
+  table->count--;
+
+  table->dense_indices[slot] = INVALID_ID;
+  table->generations[slot] = next_generation(table->generations[slot]);
+  table->free_slots[table->free_count++] = slot;
+  return true;
+}
+
+void *handle_table_get(handle_table *table, u32 handle) {
+  if (!handle_table_is_valid(table, handle)) {
+    return 0;
+  }
+  u32 dense_index = table->dense_indices[HANDLE_INDEX(handle)];
+  return (u8 *)table->elements + (dense_index * table->element_size);
+}
+
+b8 handle_table_is_valid(handle_table *table, u32 handle) {
+  if (!table || handle == INVALID_ID) {
+    return false;
+  }
+  u32 slot = HANDLE_INDEX(handle);
+  return slot < table->capacity && table->dense_indices[slot] != INVALID_ID &&
+         table->generations[slot] == HANDLE_GENERATION(handle);
+}
+
+void handle_table_clear(handle_table *table) {
+  for (u32 i = 0; i < table->count; ++i) {
+    u32 slot = HANDLE_INDEX(table->dense_handles[i]);
+    table->generations[slot] = next_generation(table->generations[slot]);
+    table->dense_indices[slot] = INVALID_ID;
+  }
+  table->count = 0;
+
+  // Rebuild the free stack so low slots are handed out first.
+  table->free_count = 0;
+  for (u32 i = table->capacity; i > 0; --i) {
+    table->free_slots[table->free_count++] = i - 1;
+  }
+}
+
+/**
+ * @brief Reallocates every array for new_capacity, keeping existing contents,
+ * and pushes the new slots onto the free stack.
+ */
+static void handle_table_grow(handle_table *table, u32 new_capacity) {
+  u32 old_capacity = table->capacity;
+  u64 element_size = table->element_size;
+
+  void *elements = oallocate(element_size * new_capacity, MEMORY_TAG_ARRAY);
+  u32 *dense_handles = oallocate(sizeof(u32) * new_capacity, MEMORY_TAG_ARRAY);
+  u32 *generations = oallocate(sizeof(u32) * new_capacity, MEMORY_TAG_ARRAY);
+  u32 *dense_indices = oallocate(sizeof(u32) * new_capacity, MEMORY_TAG_ARRAY);
+  u32 *free_slots = oallocate(sizeof(u32) * new_capacity, MEMORY_TAG_ARRAY);
+
+  if (old_capacity) {
+    ocopy_memory(elements, table->elements, element_size * table->count);
+    ocopy_memory(dense_handles, table->dense_handles,
+                 sizeof(u32) * table->count);
+    ocopy_memory(generations, table->generations, sizeof(u32) * old_capacity);
+    ocopy_memory(dense_indices, table->dense_indices,
+                 sizeof(u32) * old_capacity);
+    ocopy_memory(free_slots, table->free_slots,
+                 sizeof(u32) * table->free_count);
+    ofree(table->elements, element_size * old_capacity, MEMORY_TAG_ARRAY);
+    ofree(table->dense_handles, sizeof(u32) * old_capacity, MEMORY_TAG_ARRAY);
+    ofree(table->generations, sizeof(u32) * old_capacity, MEMORY_TAG_ARRAY);
+    ofree(table->dense_indices, sizeof(u32) * old_capacity, MEMORY_TAG_ARRAY);
+    ofree(table->free_slots, sizeof(u32) * old_capacity, MEMORY_TAG_ARRAY);
+  }
+
+  for (u32 i = old_capacity; i < new_capacity; ++i) {
+    generations[i] = 1;
+    dense_indices[i] = INVALID_ID;
+  }
+  // Push the new slots so the lowest index is handed out first.
+  u32 added = new_capacity - old_capacity;
+  for (u32 i = 0; i < added; ++i) {
+    free_slots[table->free_count + i] = new_capacity - 1 - i;
+  }
+
+  table->elements = elements;
+  table->dense_handles = dense_handles;
+  table->generations = generations;
+  table->dense_indices = dense_indices;
+  table->free_slots = free_slots;
+  table->free_count += added;
+  table->capacity = new_capacity;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief Number of low bits of a handle holding the slot index. The remaining
+ * high bits hold the slot's generation.
+ */
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GENERATION_MASK ((1u << (32 - HANDLE_INDEX_BITS)) - 1)
+/** @brief Largest number of slots a table can hold. */
+#define HANDLE_TABLE_MAX_CAPACITY HANDLE_INDEX_MASK
+
+/** @brief Gets the slot index encoded in a handle. */
+#define HANDLE_INDEX(handle) ((handle) & HANDLE_INDEX_MASK)
+/** @brief Gets the generation encoded in a handle. */
+#define HANDLE_GENERATION(handle) ((handle) >> HANDLE_INDEX_BITS)
+
+/**
+ * @brief A slot map which hands out generational u32 handles to fixed-size
+ * elements. A handle is a slot index plus the generation of that slot when it
+ * was issued. Removing an element bumps the slot's generation, so handles to
+ * removed elements fail validation even once the slot has been reused.
+ *
+ * Elements are stored densely in insertion order (with swap-remove), so the
+ * live elements can be iterated directly as elements[0..count). Pointers to
+ * elements are invalidated by any insert or remove.
+ *
+ * A handle of 0 or INVALID_ID is never valid.
+ */
+typedef struct handle_table {
+  u64 element_size;
+  u32 capacity;
+  u32 count;
+  /** @brief Dense element storage, capacity * element_size bytes. */
+  void *elements;
+  /** @brief Handle of each dense element. */
+  u32 *dense_handles;
+  /** @brief Per slot: current generation. */
+  u32 *generations;
+  /** @brief Per slot: index into elements, or INVALID_ID if the slot is free.
+   */
+  u32 *dense_indices;
+  /** @brief Stack of free slot indices. */
+  u32 *free_slots;
+  u32 free_count;
+} handle_table;
+
+/**
+ * @brief Creates a new handle table. The table grows as needed, up to
+ * HANDLE_TABLE_MAX_CAPACITY elements.
+ * @param element_size The size of each element in bytes.
+ * @param initial_capacity The number of elements to reserve space for.
+ * @param out_table The table to be initialized.
+ * @returns True on success.
+ */
+OAPI b8 handle_table_create(u64 element_size, u32 initial_capacity,
+                            handle_table *out_table);
+OAPI void handle_table_destroy(handle_table *table);
+
+/**
+ * @brief Copies element into the table (or zeroes the new element if element
+ * is 0), reusing a free slot if there is one.
+ * @returns The handle of the new element, or INVALID_ID if the table is full.
+ */
+OAPI u32 handle_table_insert(handle_table *table, const void *element);
+
+/**
+ * @brief Removes the element referred to by handle and frees its slot. The
+ * last element is moved into the hole.
+ * @param out_element If not 0, the removed element is copied here.
+ * @returns False if the handle is not valid.
+ */
+OAPI b8 handle_table_remove(handle_table *table, u32 handle,
+                            void *out_element);
+
+/**
+ * @brief Looks up the element for handle in O(1).
+ * @returns A pointer to the element, or 0 if the handle is stale or invalid.
+ */
+OAPI void *handle_table_get(handle_table *table, u32 handle);
+
+OAPI b8 handle_table_is_valid(handle_table *table, u32 handle);
+
+/** @brief Removes all elements. Every outstanding handle becomes invalid. */
+OAPI void handle_table_clear(handle_table *table);
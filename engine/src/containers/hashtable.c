@@ -0,0 +1,326 @@
+#include "hashtable.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+#include "core/ostring.h"
+
+// Control bytes. Live slots hold the top 7 bits of the hash, so never have the
+// high bit set.
+#define CONTROL_EMPTY 0x80
+#define CONTROL_DELETED 0xFE
+#define HASHTABLE_MIN_CAPACITY 16
+
+OINLINE u8 control_hash(u64 hash) { return (u8)(hash >> 57); }
+
+OINLINE b8 control_is_live(u8 control) { return control < CONTROL_EMPTY; }
+
+OINLINE u64 slots_size(u32 capacity, u64 value_size) {
+  return (u64)capacity * (sizeof(u64) + value_size + 1);
+}
+
+OINLINE void *slot_value(const hashtable *table, u32 slot) {
+  return (u8 *)table->values + (u64)slot * table->value_size;
+}
+
+/** @brief Smallest power-of-two capacity keeping count at most half full. */
+static u32 capacity_for(u32 count) {
+  u32 capacity = HASHTABLE_MIN_CAPACITY;
+  while (capacity / 2 < count) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+u64 hash_u64(u64 value) {
+  // splitmix64 finalizer.
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ull;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebull;
+  value ^= value >> 31;
+  return value;
+}
+
+u64 hash_string(const char *str) {
+  u64 hash = 0xcbf29ce484222325ull;
+  for (const u8 *c = (const u8 *)str; *c; ++c) {
+    hash ^= *c;
+    hash *= 0x100000001b3ull;
+  }
+  // FNV's low bits are weak and the probe start uses them; mix them in.
+  return hash_u64(hash);
+}
+
+OINLINE u64 key_hash(const hashtable *table, u64 key) {
+  return table->key_type == HASHTABLE_KEY_STRING
+             ? hash_string((const char *)key)
+             : hash_u64(key);
+}
+
+OINLINE b8 keys_equal(const hashtable *table, u64 stored, u64 key) {
+  return table->key_type == HASHTABLE_KEY_STRING
+             ? strings_equal((const char *)stored, (const char *)key)
+             : stored == key;
+}
+
+/** @brief Points the table at a fresh block of empty slots. */
+static b8 allocate_slots(hashtable *table, u32 capacity) {
+  // Keys first, then values, then control bytes, so keys and values keep the
+  // block's alignment.
+  u8 *block = oallocate_uninit(slots_size(capacity, table->value_size),
+                               MEMORY_TAG_DICT);
+  if (!block) {
+    return false;
+  }
+  table->keys = (u64 *)block;
+  table->values = block + (u64)capacity * sizeof(u64);
+  table->control = block + (u64)capacity * (sizeof(u64) + table->value_size);
+  oset_memory(table->control, CONTROL_EMPTY, capacity);
+  table->capacity = capacity;
+  table->count = 0;
+  table->tombstone_count = 0;
+  return true;
+}
+
+/** @brief The slot holding key, or INVALID_ID. */
+static u32 find_slot(const hashtable *table, u64 key, u64 hash) {
+  u32 mask = table->capacity - 1;
+  u8 tag = control_hash(hash);
+  // The load limit guarantees an empty slot, so the probe always ends.
+  for (u32 slot = hash & mask;; slot = (slot + 1) & mask) {
+    u8 control = table->control[slot];
+    if (control == CONTROL_EMPTY) {
+      return INVALID_ID;
+    }
+    if (control == tag && keys_equal(table, table->keys[slot], key)) {
+      return slot;
+    }
+  }
+}
+
+/** @brief The first empty or deleted slot on hash's probe path. */
+static u32 find_free_slot(const hashtable *table, u64 hash) {
+  u32 mask = table->capacity - 1;
+  u32 slot = hash & mask;
+  while (control_is_live(table->control[slot])) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/** @brief Moves every live entry into new_capacity slots, minus tombstones. */
+static b8 rehash(hashtable *table, u32 new_capacity) {
+  hashtable old = *table;
+  if (!allocate_slots(table, new_capacity)) {
+    *table = old;
+    OERROR("hashtable - failed to allocate %u slots.", new_capacity);
+    return false;
+  }
+
+  for (u32 i = 0; i < old.capacity; ++i) {
+    if (!control_is_live(old.control[i])) {
+      continue;
+    }
+    u64 hash = key_hash(table, old.keys[i]);
+    u32 slot = find_free_slot(table, hash);
+    table->control[slot] = old.control[i];
+    table->keys[slot] = old.keys[i];
+    ocopy_memory(slot_value(table, slot), slot_value(&old, i),
+                 table->value_size);
+    table->count++;
+  }
+
+  ofree(old.keys, slots_size(old.capacity, old.value_size), MEMORY_TAG_DICT);
+  return true;
+}
+
+/** @brief Makes sure one more entry can be added without passing 3/4 load. */
+static b8 make_room(hashtable *table) {
+  u64 used = (u64)table->count + table->tombstone_count + 1;
+  if (used * 4 <= (u64)table->capacity * 3) {
+    return true;
+  }
+  // Mostly tombstones: rehashing at the same size is enough.
+  u32 capacity = table->capacity;
+  if ((table->count + 1) * 2 > capacity) {
+    capacity *= 2;
+  }
+  return rehash(table, capacity);
+}
+
+static b8 set_entry(hashtable *table, u64 key, const void *value) {
+  u64 hash = key_hash(table, key);
+  u32 slot = find_slot(table, key, hash);
+  if (slot != INVALID_ID) {
+    ocopy_memory(slot_value(table, slot), value, table->value_size);
+    return true;
+  }
+
+  if (!make_room(table)) {
+    return false;
+  }
+  slot = find_free_slot(table, hash);
+  if (table->control[slot] == CONTROL_DELETED) {
+    table->tombstone_count--;
+  }
+  if (table->key_type == HASHTABLE_KEY_STRING) {
+    key = (u64)string_duplicate((const char *)key);
+  }
+  table->control[slot] = control_hash(hash);
+  table->keys[slot] = key;
+  ocopy_memory(slot_value(table, slot), value, table->value_size);
+  table->count++;
+  return true;
+}
+
+static void free_key(hashtable *table, u32 slot) {
+  if (table->key_type == HASHTABLE_KEY_STRING) {
+    char *key = (char *)table->keys[slot];
+    ofree(key, string_length(key) + 1, MEMORY_TAG_STRING);
+  }
+}
+
+static b8 remove_entry(hashtable *table, u64 key, void *out_value) {
+  u32 slot = find_slot(table, key, key_hash(table, key));
+  if (slot == INVALID_ID) {
+    return false;
+  }
+  if (out_value) {
+    ocopy_memory(out_value, slot_value(table, slot), table->value_size);
+  }
+  free_key(table, slot);
+  table->count--;
+
+  // No probe continues past an empty slot, so if the next slot is empty this
+  // one can be emptied too, along with any tombstones run just before it.
+  u32 mask = table->capacity - 1;
+  if (table->control[(slot + 1) & mask] != CONTROL_EMPTY) {
+    table->control[slot] = CONTROL_DELETED;
+    table->tombstone_count++;
+    return true;
+  }
+  table->control[slot] = CONTROL_EMPTY;
+  for (u32 prev = (slot - 1) & mask; table->control[prev] == CONTROL_DELETED;
+       prev = (prev - 1) & mask) {
+    table->control[prev] = CONTROL_EMPTY;
+    table->tombstone_count--;
+  }
+  return true;
+}
+
+static b8 check_key_type(const hashtable *table, hashtable_key_type type) {
+  if (table->key_type != type) {
+    OERROR("hashtable - %s key used on a table with %s keys.",
+           type == HASHTABLE_KEY_STRING ? "string" : "u64",
+           table->key_type == HASHTABLE_KEY_STRING ? "string" : "u64");
+    return false;
+  }
+  return true;
+}
+
+b8 hashtable_create(u64 value_size, u32 initial_count,
+                    hashtable_key_type key_type, hashtable *out_table) {
+  if (!out_table || value_size == 0) {
+    OERROR("hashtable_create requires a table and a non-zero value size.");
+    return false;
+  }
+  ozero_memory(out_table, sizeof(hashtable));
+  out_table->value_size = value_size;
+  out_table->key_type = key_type;
+  if (!allocate_slots(out_table, capacity_for(initial_count))) {
+    OERROR("hashtable_create - failed to allocate the table.");
+    return false;
+  }
+  return true;
+}
+
+void hashtable_destroy(hashtable *table) {
+  if (!table || !table->keys) {
+    return;
+  }
+  hashtable_clear(table);
+  ofree(table->keys, slots_size(table->capacity, table->value_size),
+        MEMORY_TAG_DICT);
+  ozero_memory(table, sizeof(hashtable));
+}
+
+b8 hashtable_reserve(hashtable *table, u32 count) {
+  u32 capacity = capacity_for(count);
+  if (capacity <= table->capacity) {
+    return true;
+  }
+  return rehash(table, capacity);
+}
+
+b8 hashtable_set(hashtable *table, const char *key, const void *value) {
+  if (!check_key_type(table, HASHTABLE_KEY_STRING)) {
+    return false;
+  }
+  return set_entry(table, (u64)key, value);
+}
+
+void *hashtable_get(hashtable *table, const char *key) {
+  if (!check_key_type(table, HASHTABLE_KEY_STRING)) {
+    return 0;
+  }
+  u32 slot = find_slot(table, (u64)key, hash_string(key));
+  return slot == INVALID_ID ? 0 : slot_value(table, slot);
+}
+
+b8 hashtable_remove(hashtable *table, const char *key, void *out_value) {
+  if (!check_key_type(table, HASHTABLE_KEY_STRING)) {
+    return false;
+  }
+  return remove_entry(table, (u64)key, out_value);
+}
+
+b8 hashtable_set_u64(hashtable *table, u64 key, const void *value) {
+  if (!check_key_type(table, HASHTABLE_KEY_U64)) {
+    return false;
+  }
+  return set_entry(table, key, value);
+}
+
+void *hashtable_get_u64(hashtable *table, u64 key) {
+  if (!check_key_type(table, HASHTABLE_KEY_U64)) {
+    return 0;
+  }
+  u32 slot = find_slot(table, key, hash_u64(key));
+  return slot == INVALID_ID ? 0 : slot_value(table, slot);
+}
+
+b8 hashtable_remove_u64(hashtable *table, u64 key, void *out_value) {
+  if (!check_key_type(table, HASHTABLE_KEY_U64)) {
+    return false;
+  }
+  return remove_entry(table, key, out_value);
+}
+
+void hashtable_clear(hashtable *table) {
+  if (table->key_type == HASHTABLE_KEY_STRING) {
+    for (u32 i = 0; i < table->capacity; ++i) {
+      if (control_is_live(table->control[i])) {
+        free_key(table, i);
+      }
+    }
+  }
+  oset_memory(table->control, CONTROL_EMPTY, table->capacity);
+  table->count = 0;
+  table->tombstone_count = 0;
+}
+
+b8 hashtable_next(hashtable *table, hashtable_iterator *iterator) {
+  for (u32 slot = iterator->next_slot; slot < table->capacity; ++slot) {
+    if (control_is_live(table->control[slot])) {
+      iterator->next_slot = slot + 1;
+      iterator->key = table->keys[slot];
+      iterator->string_key = table->key_type == HASHTABLE_KEY_STRING
+                                 ? (const char *)table->keys[slot]
+                                 : 0;
+      iterator->value = slot_value(table, slot);
+      return true;
+    }
+  }
+  iterator->next_slot = table->capacity;
+  return false;
+}
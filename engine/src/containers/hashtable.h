@@ -0,0 +1,118 @@
+#pragma once
+
+#include "defines.h"
+
+typedef enum hashtable_key_type {
+  /** @brief Null-terminated strings, copied into the table on insert. */
+  HASHTABLE_KEY_STRING,
+  HASHTABLE_KEY_U64
+} hashtable_key_type;
+
+/**
+ * @brief An open-addressing hash map from string or u64 keys to fixed-size
+ * values, stored inline.
+ *
+ * Each slot has a control byte, kept in its own array: empty, deleted, or the
+ * top 7 bits of the key's hash. Probing walks the control bytes linearly and
+ * only compares keys whose byte matches, so a miss rarely touches the keys or
+ * values at all.
+ *
+ * Removing leaves a tombstone unless the slot ends a probe chain. The table
+ * rehashes in place once tombstones and live entries fill 3/4 of it, and
+ * doubles when live entries alone pass half. Pointers to values are
+ * invalidated by any insert.
+ */
+typedef struct hashtable {
+  u64 value_size;
+  hashtable_key_type key_type;
+  /** @brief Number of slots; always a power of two. */
+  u32 capacity;
+  u32 count;
+  u32 tombstone_count;
+  /** @brief Per slot: the key, or for string tables the owned copy. */
+  u64 *keys;
+  /** @brief capacity * value_size bytes. */
+  void *values;
+  /** @brief Per slot control byte. */
+  u8 *control;
+} hashtable;
+
+/**
+ * @brief Walks the live entries of a table in slot order. Zero it to start;
+ * the table must not be modified until the walk ends.
+ */
+typedef struct hashtable_iterator {
+  u32 next_slot;
+  /** @brief The current key of a HASHTABLE_KEY_U64 table. */
+  u64 key;
+  /** @brief The current key of a HASHTABLE_KEY_STRING table. */
+  const char *string_key;
+  void *value;
+} hashtable_iterator;
+
+/**
+ * @brief Creates a new hashtable.
+ * @param value_size The size of each value in bytes.
+ * @param initial_count Entries to make room for before the first resize.
+ * @param key_type Whether keys are strings or u64s.
+ * @param out_table The table to be initialized.
+ * @returns True on success.
+ */
+OAPI b8 hashtable_create(u64 value_size, u32 initial_count,
+                         hashtable_key_type key_type, hashtable *out_table);
+
+/** @brief Frees the table and every string key it owns. */
+OAPI void hashtable_destroy(hashtable *table);
+
+/**
+ * @brief Grows the table so count entries fit without another resize.
+ * Never shrinks.
+ */
+OAPI b8 hashtable_reserve(hashtable *table, u32 count);
+
+/**
+ * @brief Copies value in under key, replacing any existing value.
+ * @returns False if the table couldn't grow.
+ */
+OAPI b8 hashtable_set(hashtable *table, const char *key, const void *value);
+
+/** @returns A pointer to the value stored under key, or 0 if none. */
+OAPI void *hashtable_get(hashtable *table, const char *key);
+
+/**
+ * @brief Removes key from the table.
+ * @param out_value If not 0, the removed value is copied here.
+ * @returns False if key wasn't present.
+ */
+OAPI b8 hashtable_remove(hashtable *table, const char *key, void *out_value);
+
+OAPI b8 hashtable_set_u64(hashtable *table, u64 key, const void *value);
+OAPI void *hashtable_get_u64(hashtable *table, u64 key);
+OAPI b8 hashtable_remove_u64(hashtable *table, u64 key, void *out_value);
+
+/** @brief Removes every entry, keeping the capacity. */
+OAPI void hashtable_clear(hashtable *table);
+
+/**
+ * @brief Advances to the next live entry.
+ * @returns False once every entry has been visited.
+ */
+OAPI b8 hashtable_next(hashtable *table, hashtable_iterator *iterator);
+
+/** @brief FNV-1a over a null-terminated string, with a final mix. */
+OAPI u64 hash_string(const char *str);
+
+/** @brief Scrambles an integer key so every bit affects the low bits. */
+OAPI u64 hash_u64(u64 value);
+
+#define hashtable_set_value(table, key, value)                                 \
+  {                                                                            \
+    typeof(value) temp = value;                                                \
+    hashtable_set(table, key, &temp);                                          \
+  }
+
+#define hashtable_set_value_u64(table, key, value)                             \
+  {                                                                            \
+    typeof(value) temp = value;                                                \
+    hashtable_set_u64(table, key, &temp);                                      \
+  }
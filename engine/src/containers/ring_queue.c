@@ -0,0 +1,192 @@
+#include "ring_queue.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+#define LOAD_RELAXED(value) __atomic_load_n(&(value), __ATOMIC_RELAXED)
+#define LOAD_ACQUIRE(value) __atomic_load_n(&(value), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(value, new_value)                                        \
+  __atomic_store_n(&(value), (new_value), __ATOMIC_RELEASE)
+
+OINLINE u8 *slot_at(ring_queue *queue, u64 position) {
+  return queue->slots + (position & (queue->capacity - 1)) * queue->slot_size;
+}
+
+/** @brief MPSC slots start with their sequence number; data follows. */
+OINLINE u64 *slot_sequence(u8 *slot) { return (u64 *)slot; }
+
+OINLINE void *slot_data(ring_queue *queue, u8 *slot) {
+  return queue->mode == RING_QUEUE_MODE_MPSC ? slot + sizeof(u64) : slot;
+}
+
+b8 ring_queue_create(u64 element_size, u32 capacity, ring_queue_mode mode,
+                     ring_queue *out_queue) {
+  if (!out_queue || element_size == 0 || capacity == 0) {
+    OERROR("ring_queue_create requires a queue and a non-zero element size "
+           "and capacity.");
+    return false;
+  }
+  if (capacity > (1u << 31)) {
+    OERROR("ring_queue_create - capacity %u is too large.", capacity);
+    return false;
+  }
+  ozero_memory(out_queue, sizeof(ring_queue));
+
+  u32 rounded = 1;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  out_queue->element_size = element_size;
+  out_queue->capacity = rounded;
+  out_queue->mode = mode;
+  out_queue->slot_size = element_size;
+  if (mode == RING_QUEUE_MODE_MPSC) {
+    // Keep every slot's sequence number 8-byte aligned.
+    out_queue->slot_size = (sizeof(u64) + element_size + 7) & ~7ull;
+  }
+
+  out_queue->slots =
+      oallocate_aligned(out_queue->slot_size * rounded, RING_QUEUE_CACHE_LINE,
+                        MEMORY_TAG_RING_QUEUE);
+  if (!out_queue->slots) {
+    OERROR("ring_queue_create - failed to allocate %u slots.", rounded);
+    return false;
+  }
+
+  if (mode == RING_QUEUE_MODE_MPSC) {
+    // A slot is free to write at position p when its sequence is p.
+    for (u32 i = 0; i < rounded; ++i) {
+      *slot_sequence(slot_at(out_queue, i)) = i;
+    }
+  }
+  return true;
+}
+
+void ring_queue_destroy(ring_queue *queue) {
+  if (!queue || !queue->slots) {
+    return;
+  }
+  ofree_aligned(queue->slots, queue->slot_size * queue->capacity,
+                RING_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+  ozero_memory(queue, sizeof(ring_queue));
+}
+
+static b8 push_single(ring_queue *queue, const void *element) {
+  if (queue->tail - queue->head == queue->capacity) {
+    return false;
+  }
+  ocopy_memory(slot_at(queue, queue->tail), element, queue->element_size);
+  queue->tail++;
+  return true;
+}
+
+static b8 pop_single(ring_queue *queue, void *out_element) {
+  if (queue->head == queue->tail) {
+    return false;
+  }
+  ocopy_memory(out_element, slot_at(queue, queue->head), queue->element_size);
+  queue->head++;
+  return true;
+}
+
+static b8 push_spsc(ring_queue *queue, const void *element) {
+  // Only this thread writes tail.
+  u64 tail = queue->tail;
+  if (tail - queue->cached_head == queue->capacity) {
+    queue->cached_head = LOAD_ACQUIRE(queue->head);
+    if (tail - queue->cached_head == queue->capacity) {
+      return false;
+    }
+  }
+  ocopy_memory(slot_at(queue, tail), element, queue->element_size);
+  // Publish the slot's contents along with the new tail.
+  STORE_RELEASE(queue->tail, tail + 1);
+  return true;
+}
+
+static b8 pop_spsc(ring_queue *queue, void *out_element) {
+  // Only this thread writes head.
+  u64 head = queue->head;
+  if (head == queue->cached_tail) {
+    queue->cached_tail = LOAD_ACQUIRE(queue->tail);
+    if (head == queue->cached_tail) {
+      return false;
+    }
+  }
+  ocopy_memory(out_element, slot_at(queue, head), queue->element_size);
+  // Hand the slot back only after it's been read.
+  STORE_RELEASE(queue->head, head + 1);
+  return true;
+}
+
+static b8 push_mpsc(ring_queue *queue, const void *element) {
+  u64 position = LOAD_RELAXED(queue->tail);
+  u8 *slot;
+  for (;;) {
+    slot = slot_at(queue, position);
+    u64 sequence = LOAD_ACQUIRE(*slot_sequence(slot));
+    i64 difference = (i64)sequence - (i64)position;
+    if (difference == 0) {
+      // The slot is free; claim it. On failure position is reloaded.
+      if (__atomic_compare_exchange_n(&queue->tail, &position, position + 1,
+                                      true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (difference < 0) {
+      // Still holds an element from one lap ago: full.
+      return false;
+    } else {
+      // Another producer claimed it first.
+      position = LOAD_RELAXED(queue->tail);
+    }
+  }
+
+  ocopy_memory(slot_data(queue, slot), element, queue->element_size);
+  STORE_RELEASE(*slot_sequence(slot), position + 1);
+  return true;
+}
+
+static b8 pop_mpsc(ring_queue *queue, void *out_element) {
+  u64 position = queue->head;
+  u8 *slot = slot_at(queue, position);
+  u64 sequence = LOAD_ACQUIRE(*slot_sequence(slot));
+  if (sequence != position + 1) {
+    // Empty, or the producer that claimed it hasn't finished writing.
+    return false;
+  }
+  ocopy_memory(out_element, slot_data(queue, slot), queue->element_size);
+  // Free the slot for the producer one lap ahead.
+  STORE_RELEASE(*slot_sequence(slot), position + queue->capacity);
+  STORE_RELEASE(queue->head, position + 1);
+  return true;
+}
+
+b8 ring_queue_push(ring_queue *queue, const void *element) {
+  switch (queue->mode) {
+  case RING_QUEUE_MODE_SPSC:
+    return push_spsc(queue, element);
+  case RING_QUEUE_MODE_MPSC:
+    return push_mpsc(queue, element);
+  default:
+    return push_single(queue, element);
+  }
+}
+
+b8 ring_queue_pop(ring_queue *queue, void *out_element) {
+  switch (queue->mode) {
+  case RING_QUEUE_MODE_SPSC:
+    return pop_spsc(queue, out_element);
+  case RING_QUEUE_MODE_MPSC:
+    return pop_mpsc(queue, out_element);
+  default:
+    return pop_single(queue, out_element);
+  }
+}
+
+u32 ring_queue_count(ring_queue *queue) {
+  // Read head first so the count can't go negative as both move on.
+  u64 head = LOAD_ACQUIRE(queue->head);
+  u64 tail = LOAD_ACQUIRE(queue->tail);
+  return (u32)(tail - head);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "defines.h"
+
+/** @brief Head and tail are kept this far apart to avoid false sharing. */
+#define RING_QUEUE_CACHE_LINE 64
+
+typedef enum ring_queue_mode {
+  /** @brief No synchronization; push and pop from the same thread. */
+  RING_QUEUE_MODE_SINGLE_THREADED,
+  /** @brief Lock-free, one producer thread and one consumer thread. */
+  RING_QUEUE_MODE_SPSC,
+  /** @brief Lock-free, any number of producer threads and one consumer. */
+  RING_QUEUE_MODE_MPSC
+} ring_queue_mode;
+
+/**
+ * @brief A fixed-capacity FIFO of fixed-size elements over a power-of-two
+ * ring of slots. Head and tail are free-running counters masked into the
+ * ring, each on its own cache line, so producer and consumer don't contend
+ * over one line.
+ *
+ * SPSC producers and consumers also keep a cached copy of the other side's
+ * index and only reload it when the queue looks full or empty. MPSC slots
+ * carry a sequence number; producers claim a slot by advancing the tail with
+ * a compare-exchange, then publish it by bumping its sequence, so the
+ * consumer never reads a slot still being written.
+ *
+ * Create and destroy are not thread-safe. Since the queue is 64-byte
+ * aligned, allocate it with oallocate_aligned if it isn't static or on the
+ * stack.
+ */
+typedef struct ring_queue {
+  u64 element_size;
+  /** @brief Bytes per slot, including the MPSC sequence number. */
+  u64 slot_size;
+  u32 capacity;
+  ring_queue_mode mode;
+  u8 *slots;
+
+  // Consumer side.
+  _Alignas(RING_QUEUE_CACHE_LINE) u64 head;
+  u64 cached_tail;
+
+  // Producer side.
+  _Alignas(RING_QUEUE_CACHE_LINE) u64 tail;
+  u64 cached_head;
+} ring_queue;
+
+/**
+ * @brief Creates a new ring queue.
+ * @param element_size The size of each element in bytes.
+ * @param capacity The most elements the queue holds at once; rounded up to a
+ * power of two.
+ * @param mode Which threads may push and pop.
+ * @param out_queue The queue to be initialized.
+ * @returns True on success.
+ */
+OAPI b8 ring_queue_create(u64 element_size, u32 capacity, ring_queue_mode mode,
+                          ring_queue *out_queue);
+OAPI void ring_queue_destroy(ring_queue *queue);
+
+/**
+ * @brief Copies element onto the back of the queue.
+ * @returns False if the queue is full.
+ */
+OAPI b8 ring_queue_push(ring_queue *queue, const void *element);
+
+/**
+ * @brief Copies the front element to out_element and removes it.
+ * @returns False if the queue is empty.
+ */
+OAPI b8 ring_queue_pop(ring_queue *queue, void *out_element);
+
+/**
+ * @brief Number of queued elements. Only a snapshot while other threads are
+ * pushing or popping.
+ */
+OAPI u32 ring_queue_count(ring_queue *queue);
@@ -0,0 +1,108 @@
+#include "containers/soa.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+/** @brief Bytes one field takes at capacity, padded to the alignment. */
+OINLINE u64 field_size(u64 stride, u64 capacity) {
+  return (stride * capacity + SOA_ALIGNMENT - 1) & ~(u64)(SOA_ALIGNMENT - 1);
+}
+
+/** @brief Moves every field into a new block holding capacity elements. */
+static b8 soa_reallocate(soa *s, u64 capacity) {
+  u64 block_size = 0;
+  for (u32 i = 0; i < s->field_count; ++i) {
+    block_size += field_size(s->field_strides[i], capacity);
+  }
+  u8 *block = oallocate_aligned(block_size, SOA_ALIGNMENT, MEMORY_TAG_ARRAY);
+  if (!block) {
+    OERROR("soa - failed to allocate %llu elements.", capacity);
+    return false;
+  }
+
+  u8 *field = block;
+  for (u32 i = 0; i < s->field_count; ++i) {
+    if (s->length) {
+      ocopy_memory(field, s->fields[i], s->length * s->field_strides[i]);
+    }
+    s->fields[i] = field;
+    field += field_size(s->field_strides[i], capacity);
+  }
+
+  if (s->block) {
+    ofree_aligned(s->block, s->block_size, SOA_ALIGNMENT, MEMORY_TAG_ARRAY);
+  }
+  s->block = block;
+  s->block_size = block_size;
+  s->capacity = capacity;
+  return true;
+}
+
+b8 soa_create(u32 field_count, const u64 *field_strides, u64 initial_capacity,
+              soa *out_soa) {
+  if (!out_soa || !field_strides || field_count == 0 ||
+      field_count > SOA_MAX_FIELDS) {
+    OERROR("soa_create requires a container and 1 to %u fields.",
+           SOA_MAX_FIELDS);
+    return false;
+  }
+  ozero_memory(out_soa, sizeof(soa));
+  for (u32 i = 0; i < field_count; ++i) {
+    if (field_strides[i] == 0) {
+      OERROR("soa_create - field %u has a zero stride.", i);
+      return false;
+    }
+    out_soa->field_strides[i] = field_strides[i];
+  }
+  out_soa->field_count = field_count;
+  return soa_reallocate(out_soa, initial_capacity ? initial_capacity : 1);
+}
+
+void soa_destroy(soa *s) {
+  if (!s || !s->block) {
+    return;
+  }
+  ofree_aligned(s->block, s->block_size, SOA_ALIGNMENT, MEMORY_TAG_ARRAY);
+  ozero_memory(s, sizeof(soa));
+}
+
+b8 soa_reserve(soa *s, u64 capacity) {
+  if (capacity <= s->capacity) {
+    return true;
+  }
+  return soa_reallocate(s, capacity);
+}
+
+b8 soa_push(soa *s, u64 *out_index) {
+  if (s->length == s->capacity && !soa_reallocate(s, s->capacity * 2)) {
+    return false;
+  }
+  u64 index = s->length++;
+  for (u32 i = 0; i < s->field_count; ++i) {
+    u64 stride = s->field_strides[i];
+    ozero_memory((u8 *)s->fields[i] + index * stride, stride);
+  }
+  if (out_index) {
+    *out_index = index;
+  }
+  return true;
+}
+
+void soa_remove_swap(soa *s, u64 index) {
+  if (index >= s->length) {
+    OERROR("Index outside the bounds of this soa. Length: %llu, index: %llu",
+           s->length, index);
+    return;
+  }
+  u64 last = --s->length;
+  if (index == last) {
+    return;
+  }
+  for (u32 i = 0; i < s->field_count; ++i) {
+    u64 stride = s->field_strides[i];
+    u8 *field = s->fields[i];
+    ocopy_memory(field + index * stride, field + last * stride, stride);
+  }
+}
+
+void soa_clear(soa *s) { s->length = 0; }
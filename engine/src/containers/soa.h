@@ -0,0 +1,116 @@
+#pragma once
+
+#include "defines.h"
+#include "math/math_types.h"
+
+#define SOA_MAX_FIELDS 16
+/** @brief Every field array starts on a cache line. */
+#define SOA_ALIGNMENT 64
+
+/**
+ * @brief Structure-of-arrays storage: one array per field, all indexed by the
+ * same element index and grown together. A loop touching two fields of every
+ * element streams through just those two arrays instead of striding over
+ * whole structs.
+ *
+ * All fields live in one block, each starting on a SOA_ALIGNMENT boundary.
+ * Pointers from soa_field are invalidated whenever the container grows.
+ * Elements are unordered once soa_remove_swap is used.
+ */
+typedef struct soa {
+  u32 field_count;
+  u64 field_strides[SOA_MAX_FIELDS];
+  void *fields[SOA_MAX_FIELDS];
+  u64 length;
+  u64 capacity;
+  void *block;
+  u64 block_size;
+} soa;
+
+/**
+ * @brief Creates a new SoA container.
+ * @param field_count How many fields each element has; at most
+ * SOA_MAX_FIELDS.
+ * @param field_strides The size of each field in bytes.
+ * @param initial_capacity Elements to make room for before the first resize.
+ * @param out_soa The container to be initialized.
+ * @returns True on success.
+ */
+OAPI b8 soa_create(u32 field_count, const u64 *field_strides,
+                   u64 initial_capacity, soa *out_soa);
+OAPI void soa_destroy(soa *s);
+
+/** @brief Grows every field so capacity elements fit. Never shrinks. */
+OAPI b8 soa_reserve(soa *s, u64 capacity);
+
+/**
+ * @brief Appends a zeroed element.
+ * @param out_index The new element's index.
+ * @returns False if the container couldn't grow.
+ */
+OAPI b8 soa_push(soa *s, u64 *out_index);
+
+/**
+ * @brief Removes the element at index in O(1) by moving the last element into
+ * its place in every field.
+ */
+OAPI void soa_remove_swap(soa *s, u64 index);
+
+/** @brief Sets the length to 0, keeping the capacity. */
+OAPI void soa_clear(soa *s);
+
+/** @returns The array holding field. */
+OINLINE void *soa_field(soa *s, u32 field) { return s->fields[field]; }
+
+#define soa_field_as(s, type, field) ((type *)soa_field(s, field))
+
+// Kernels over field arrays. They are plain loops over restrict-qualified
+// pointers so the compiler vectorizes them; keep them in the header so they
+// inline into the caller's loop.
+
+/** @brief out[i] += in[i] * scale for count elements. */
+OINLINE void soa_f32_add_scaled(f32 *restrict out, const f32 *restrict in,
+                                f32 scale, u64 count) {
+  for (u64 i = 0; i < count; ++i) {
+    out[i] += in[i] * scale;
+  }
+}
+
+/** @brief out[i] *= in[i] for count elements. */
+OINLINE void soa_f32_mul(f32 *restrict out, const f32 *restrict in,
+                         u64 count) {
+  for (u64 i = 0; i < count; ++i) {
+    out[i] *= in[i];
+  }
+}
+
+/** @brief Reads element index of three f32 fields as a vec3. */
+OINLINE vec3 soa_vec3_get(const f32 *x, const f32 *y, const f32 *z,
+                          u64 index) {
+  return (vec3){x[index], y[index], z[index]};
+}
+
+/** @brief Writes vector into element index of three f32 fields. */
+OINLINE void soa_vec3_set(f32 *x, f32 *y, f32 *z, u64 index, vec3 vector) {
+  x[index] = vector.x;
+  y[index] = vector.y;
+  z[index] = vector.z;
+}
+
+/**
+ * @brief Transforms count points, stored as x, y and z fields, by matrix in
+ * place, taking w as 1.
+ */
+OINLINE void soa_vec3_transform_points(const mat4 *matrix, f32 *restrict x,
+                                       f32 *restrict y, f32 *restrict z,
+                                       u64 count) {
+  const f32 *m = matrix->data;
+  for (u64 i = 0; i < count; ++i) {
+    f32 px = x[i];
+    f32 py = y[i];
+    f32 pz = z[i];
+    x[i] = px * m[0] + py * m[4] + pz * m[8] + m[12];
+    y[i] = px * m[1] + py * m[5] + pz * m[9] + m[13];
+    z[i] = px * m[2] + py * m[6] + pz * m[10] + m[14];
+  }
+}
@@ -7,6 +7,9 @@
 #include "core/event.h"
 #include "core/input.h"
 #include "core/omemory.h"
+#include "core/ostring.h"
+#include "core/profiler.h"
+#include "memory/frame_allocator.h"
 #include "memory/linear_allocator.h"
 #include "platform/platform.h"
 
@@ -22,16 +25,22 @@ typedef struct application_state {
   clock clock;
   f64 last_time;
   linear_allocator systems_allocator;
-
-  u64 memory_system_memory_requirement;
-  void *memory_system_state;
+  // Double-buffered scratch memory, swapped at the end of every frame. Backs
+  // the render packet.
+  frame_allocator frame_allocator;
 
   u64 logging_system_memory_requirement;
   void *logging_system_state;
 
+  u64 profiler_system_memory_requirement;
+  void *profiler_system_state;
+
 } application_state;
 
 static application_state *app_state;
+// Set on the thread that created the application; the frame allocator is
+// only handed out there.
+static _Thread_local b8 is_main_thread;
 
 // Event handlers
 b8 application_on_event(u16 code, void *sender, void *listener_inst,
@@ -48,6 +57,18 @@ b8 application_create(game *game_inst) {
     return false;
   }
 
+  is_main_thread = true;
+
+  // Memory first; everything below is allocated from its arena.
+  u64 memory_total_size = 1024ull * 1024 * 1024; // 1 gb
+  if (!initialize_memory(memory_total_size)) {
+    OFATAL("Failed to initialize memory system; shutting down.");
+    return false;
+  }
+  if (game_inst->app_config.track_allocations) {
+    memory_tracking_enable();
+  }
+
   game_inst->application_state =
       oallocate(sizeof(application_state), MEMORY_TAG_APPLICATION);
   app_state = game_inst->application_state;
@@ -55,19 +76,17 @@ b8 application_create(game *game_inst) {
   app_state->is_running = false;
   app_state->is_suspended = false;
 
+  // Reserved address space, committed as systems claim it, on huge pages
+  // where available.
   u64 systems_allocator_total_size = 64 * 1024 * 1024; // 64 mb
-  linear_allocator_create(systems_allocator_total_size, 0,
-                          &app_state->systems_allocator);
+  if (!linear_allocator_create_reserved(systems_allocator_total_size, true,
+                                        &app_state->systems_allocator)) {
+    OWARN("Failed to reserve the systems allocator; using the memory arena.");
+    linear_allocator_create(systems_allocator_total_size, 0,
+                            &app_state->systems_allocator);
+  }
   // Initialize subsystems
 
-  // Memory
-  initialize_memory(&app_state->memory_system_memory_requirement, 0);
-  app_state->memory_system_state =
-      linear_allocator_allocate(&app_state->systems_allocator,
-                                app_state->memory_system_memory_requirement);
-  initialize_memory(&app_state->memory_system_memory_requirement,
-                    app_state->memory_system_state);
-
   // Logging
   initialize_logging(&app_state->logging_system_memory_requirement, 0);
   app_state->logging_system_state =
@@ -79,6 +98,22 @@ b8 application_create(game *game_inst) {
     return false;
   }
 
+  // Profiler
+  initialize_profiler(&app_state->profiler_system_memory_requirement, 0);
+  app_state->profiler_system_state =
+      linear_allocator_allocate(&app_state->systems_allocator,
+                                app_state->profiler_system_memory_requirement);
+  initialize_profiler(&app_state->profiler_system_memory_requirement,
+                      app_state->profiler_system_state);
+
+  // Per-frame scratch memory, carved from the systems allocator
+  u64 frame_allocator_frame_size = 2 * 1024 * 1024; // 2 mb per frame
+  void *frame_allocator_memory = linear_allocator_allocate_aligned(
+      &app_state->systems_allocator, frame_allocator_frame_size * 2,
+      PLATFORM_ALLOCATION_ALIGNMENT);
+  frame_allocator_create(frame_allocator_frame_size, frame_allocator_memory,
+                         &app_state->frame_allocator);
+
   input_initialize();
   if (!event_initialize()) {
     OERROR("Event system failed initialization. Application cannot continue");
@@ -126,7 +161,9 @@ b8 application_run() {
   u8 frame_count = 0;
   f64 target_frame_seconds = 1.0f / 60; // 60 fps
 
-  OINFO(get_memory_usage_str());
+  char *memory_usage = get_memory_usage_str();
+  OINFO(memory_usage);
+  ofree(memory_usage, string_length(memory_usage) + 1, MEMORY_TAG_STRING);
 
   while (app_state->is_running) {
     if (!platform_pump_messages(&app_state->platform)) {
@@ -139,23 +176,37 @@ b8 application_run() {
       f64 current_time = app_state->clock.elapsed;
       f64 delta = (current_time - app_state->last_time);
       f64 frame_start_time = platform_get_absolute_time();
+      profiler_frame_begin();
 
+      OPROFILE_ZONE_BEGIN("Game Update");
       if (!app_state->game_inst->update(app_state->game_inst, (f32)delta)) {
         OFATAL("Game update failed, shutting down...");
         app_state->is_running = false;
         break;
       }
+      OPROFILE_ZONE_END();
 
-      if (!app_state->game_inst->render(app_state->game_inst, (f32)delta)) {
+      render_packet packet;
+      packet.delta_time = delta;
+      packet.frame_allocator =
+          frame_allocator_current(&app_state->frame_allocator);
+      packet.draw_item_count = 0;
+      packet.draw_items = 0;
+
+      // The game fills the packet's draw list for this frame
+      OPROFILE_ZONE_BEGIN("Game Render");
+      if (!app_state->game_inst->render(app_state->game_inst, (f32)delta,
+                                        &packet)) {
         OFATAL("Game render failed, shutting down...");
         app_state->is_running = false;
         break;
       }
+      OPROFILE_ZONE_END();
 
-      // TODO: be better than this
-      render_packet packet;
-      packet.delta_time = delta;
+      OPROFILE_ZONE_BEGIN("Renderer");
       renderer_draw_frame(&packet);
+      OPROFILE_ZONE_END();
+      profiler_frame_end();
 
       // Calculate frame time
       f64 frame_end_time = platform_get_absolute_time();
@@ -179,6 +230,12 @@ b8 application_run() {
       // frame ends
       input_update(delta);
 
+      // Close this frame's allocation counts and check the budget.
+      memory_frame_end();
+
+      // Release the scratch memory of the frame before this one.
+      frame_allocator_swap(&app_state->frame_allocator);
+
       // Update state
       app_state->last_time = current_time;
     }
@@ -195,11 +252,32 @@ b8 application_run() {
 
   renderer_shutdown();
 
+  shutdown_profiler(app_state->profiler_system_state);
+
   platform_shutdown(&app_state->platform);
 
+  // Logging state lives in the systems allocator, so stop logging to file
+  // before releasing it.
+  shutdown_logging(app_state->logging_system_state);
+  linear_allocator_destroy(&app_state->systems_allocator);
+
+  // Free app_state too so anything left over is a genuine leak when tracking.
+  app_state->game_inst->application_state = 0;
+  ofree(app_state, sizeof(application_state), MEMORY_TAG_APPLICATION);
+  app_state = 0;
+
+  shutdown_memory();
+
   return true;
 }
 
+struct stack_allocator *application_get_frame_allocator() {
+  if (!app_state || !is_main_thread) {
+    return 0;
+  }
+  return frame_allocator_current(&app_state->frame_allocator);
+}
+
 void application_get_framebuffer_size(u32 *width, u32 *height) {
   *width = app_state->width;
   *height = app_state->height;
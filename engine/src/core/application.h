@@ -3,6 +3,7 @@
 #include "defines.h"
 
 struct game;
+struct stack_allocator;
 
 typedef struct application_config {
 
@@ -21,6 +22,10 @@ typedef struct application_config {
   // application/window name
   char *name;
 
+  // record every allocation's call site, reporting leaks on shutdown. Needs
+  // OMEMORY_TRACKING; costs a table lookup per allocation and free.
+  b8 track_allocations;
+
 } application_config;
 
 OAPI b8 application_create(struct game *game_inst);
@@ -28,3 +33,12 @@ OAPI b8 application_create(struct game *game_inst);
 OAPI b8 application_run();
 
 OAPI void application_get_framebuffer_size(u32 *width, u32 *height);
+
+/**
+ * @brief Gets the current frame's scratch allocator. Allocations stay valid
+ * until the end of the next frame; scoped temporaries should free back to a
+ * marker instead.
+ * @returns The allocator, or 0 if the application hasn't been created or
+ * this isn't the thread that created it.
+ */
+OAPI struct stack_allocator *application_get_frame_allocator();
@@ -1,71 +1,739 @@
 #include "omemory.h"
 
+#include "core/asserts.h"
 #include "core/logger.h"
+#include "memory/dynamic_allocator.h"
 #include "platform/platform.h"
 
 #include "core/ostring.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+// The tracking macros would otherwise rename the definitions below.
+#undef oallocate
+#undef oallocate_uninit
+#undef oallocate_aligned
+#undef ofree
+#undef ofree_aligned
+
+/**
+ * @brief Allocation counters. Every field is only touched through the
+ * STAT_* macros below, so keeping count needs no lock when several threads
+ * allocate.
+ */
 struct memory_stats {
   u64 total_allocated;
+  u64 peak_allocated;
   u64 tagged_allocations[MEMORY_TAG_MAX_TAGS];
+  u64 tagged_peaks[MEMORY_TAG_MAX_TAGS];
+  u64 tagged_counts[MEMORY_TAG_MAX_TAGS];
 };
 
+// The counters are independent, so relaxed ordering is enough: each stays
+// exact, but a reader may see one updated before another.
+#define STAT_ADD(counter, value)                                               \
+  __atomic_add_fetch(&(counter), (value), __ATOMIC_RELAXED)
+#define STAT_SUB(counter, value)                                               \
+  __atomic_sub_fetch(&(counter), (value), __ATOMIC_RELAXED)
+#define STAT_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STAT_TAKE(counter)                                                     \
+  __atomic_exchange_n(&(counter), 0, __ATOMIC_RELAXED)
+
+/** @brief Arena allocations made during one frame. */
+typedef struct memory_frame_record {
+  u64 alloc_count;
+  u64 alloc_bytes;
+  u64 tagged_counts[MEMORY_TAG_MAX_TAGS];
+  u64 tagged_bytes[MEMORY_TAG_MAX_TAGS];
+  b8 over_budget;
+} memory_frame_record;
+
+#if OMEMORY_TRACKING == 1
+/** @brief Allocations from one call site since the last frame report. */
+typedef struct frame_call_site {
+  const char *file;
+  u32 line;
+  memory_tag tag;
+  // Number of frames the site allocated in.
+  u32 frames;
+  u64 last_frame;
+  // Allocations during last_frame.
+  u64 frame_count;
+  u64 frame_bytes;
+  u64 total_count;
+  u64 total_bytes;
+} frame_call_site;
+#endif
+
 static const char *memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "UNKNOWN    ", "ARRAY      ", "LINEAR_ALLC", "DARRAY     ", "DICT       ",
     "RING_QUEUE ", "BST        ", "STRING     ", "APPLICATION", "JOB        ",
     "TEXTURE    ", "MAT_INST   ", "RENDERER   ", "GAME       ", "TRANSFORM  ",
     "ENTITY     ", "ENTITY_NODE", "SCENE      "};
 
+#if OMEMORY_TRACKING == 1
+// Twice the site limit, so the call site table is never over half full.
+#define CALL_SITE_SLOTS (MEMORY_FRAME_MAX_CALL_SITES * 2)
+
+// Table slot markers. Real blocks are at least 16-aligned, so never 1.
+#define TRACKING_EMPTY ((void *)0)
+#define TRACKING_TOMBSTONE ((void *)1)
+#define TRACKING_INITIAL_CAPACITY 4096
+#define TRACKING_NOT_FOUND ((u64)-1)
+
+/** @brief A live allocation and where it was made. */
+typedef struct tracked_allocation {
+  void *block;
+  u64 size;
+  const char *file;
+  u32 line;
+  memory_tag tag;
+#if OMEMORY_TRACKING_BACKTRACE_DEPTH > 0
+  void *backtrace[OMEMORY_TRACKING_BACKTRACE_DEPTH];
+#endif
+} tracked_allocation;
+
+/**
+ * @brief Open-addressed table of live allocations keyed by block address,
+ * with linear probing. Its memory comes straight from the platform so
+ * tracking neither recurses nor shows up in the stats it checks.
+ */
+typedef struct allocation_tracker {
+  tracked_allocation *entries;
+  // Always a power of two.
+  u64 capacity;
+  u64 count;
+  u64 tombstones;
+} allocation_tracker;
+#endif
+
 typedef struct memory_system_state {
   struct memory_stats stats;
   u64 alloc_count;
+  u64 total_allocation_size;
+  u64 allocator_memory_requirement;
+  dynamic_allocator allocator;
+  void *allocator_block;
+  // Guards every call into allocator, which isn't thread-safe by itself, and
+  // the tracker and call site tables below.
+  platform_mutex allocator_mutex;
+
+  // Counts for the frame in progress; only touched through the STAT_* macros.
+  memory_frame_record current_frame;
+  memory_frame_record frame_history[MEMORY_FRAME_HISTORY];
+  // Slot the next closed frame is written to.
+  u32 frame_history_head;
+  u32 frame_history_count;
+  u64 frame_index;
+  b8 frame_budget_enabled;
+  b8 frame_budget_assert;
+  u64 frame_budget_allocations;
+  u64 frame_budget_bytes;
+  // Consecutive frames over budget, used to throttle the log.
+  u32 over_budget_streak;
+
+#if OMEMORY_TRACKING == 1
+  b8 tracking_enabled;
+  allocation_tracker tracker;
+  // Recorded only while tracking is enabled, in first-seen order.
+  frame_call_site call_sites[MEMORY_FRAME_MAX_CALL_SITES];
+  u32 call_site_count;
+  // Hashed on file, line and tag; each slot holds a call_sites index + 1,
+  // or 0 when empty.
+  u16 call_site_slots[CALL_SITE_SLOTS];
+  // Allocations from sites that didn't fit in call_sites.
+  u64 unlisted_site_count;
+  u64 report_start_frame;
+#endif
 } memory_system_state;
 
 static memory_system_state *state_ptr;
 
-void initialize_memory(u64 *memory_requirement, void *state) {
-  *memory_requirement = sizeof(memory_system_state);
-  if (state == 0) {
+static const char *call_site_file(const char *file) {
+  return file ? file : "(unknown)";
+}
+
+#if OMEMORY_TRACKING == 1
+/** @brief Spreads every input bit over the low bits used to pick a slot. */
+static u64 mix_bits(u64 hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+static u64 tracker_slot(const allocation_tracker *tracker, const void *block) {
+  // Blocks share their low bits through alignment, so mix them first.
+  return mix_bits((u64)block) & (tracker->capacity - 1);
+}
+
+/** @brief Index of block's entry, or TRACKING_NOT_FOUND if it isn't tracked. */
+static u64 tracker_find(const allocation_tracker *tracker, const void *block) {
+  u64 mask = tracker->capacity - 1;
+  for (u64 i = tracker_slot(tracker, block);; i = (i + 1) & mask) {
+    void *slot = tracker->entries[i].block;
+    if (slot == block) {
+      return i;
+    }
+    if (slot == TRACKING_EMPTY) {
+      return TRACKING_NOT_FOUND;
+    }
+  }
+}
+
+/** @brief Inserts without checking the load factor. */
+static void tracker_place(allocation_tracker *tracker,
+                          const tracked_allocation *entry) {
+  u64 mask = tracker->capacity - 1;
+  u64 i = tracker_slot(tracker, entry->block);
+  while (tracker->entries[i].block != TRACKING_EMPTY &&
+         tracker->entries[i].block != TRACKING_TOMBSTONE) {
+    i = (i + 1) & mask;
+  }
+  if (tracker->entries[i].block == TRACKING_TOMBSTONE) {
+    tracker->tombstones--;
+  }
+  tracker->entries[i] = *entry;
+  tracker->count++;
+}
+
+/** @brief Rebuilds the table at new_capacity, dropping tombstones. */
+static b8 tracker_rehash(allocation_tracker *tracker, u64 new_capacity) {
+  tracked_allocation *entries =
+      platform_allocate(new_capacity * sizeof(tracked_allocation), false);
+  if (!entries) {
+    return false;
+  }
+  platform_zero_memory(entries, new_capacity * sizeof(tracked_allocation));
+
+  tracked_allocation *old_entries = tracker->entries;
+  u64 old_capacity = tracker->capacity;
+  tracker->entries = entries;
+  tracker->capacity = new_capacity;
+  tracker->count = 0;
+  tracker->tombstones = 0;
+  for (u64 i = 0; i < old_capacity; ++i) {
+    void *block = old_entries[i].block;
+    if (block != TRACKING_EMPTY && block != TRACKING_TOMBSTONE) {
+      tracker_place(tracker, &old_entries[i]);
+    }
+  }
+  if (old_entries) {
+    platform_free(old_entries, false);
+  }
+  return true;
+}
+
+static void tracker_insert(allocation_tracker *tracker,
+                           const tracked_allocation *entry) {
+  // Keep probe runs short: at most 3/4 of slots in use, tombstones included.
+  if ((tracker->count + tracker->tombstones + 1) * 4 > tracker->capacity * 3) {
+    u64 capacity = tracker->capacity;
+    if ((tracker->count + 1) * 2 > capacity) {
+      capacity *= 2;
+    }
+    if (!tracker_rehash(tracker, capacity)) {
+      OERROR("Allocation tracking failed to grow; %p won't be tracked.",
+             entry->block);
+      return;
+    }
+  }
+  tracker_place(tracker, entry);
+}
+
+static void tracker_remove(allocation_tracker *tracker, u64 index) {
+  tracker->entries[index].block = TRACKING_TOMBSTONE;
+  tracker->count--;
+  tracker->tombstones++;
+}
+
+static void tracker_destroy(allocation_tracker *tracker) {
+  if (tracker->entries) {
+    platform_free(tracker->entries, false);
+  }
+  platform_zero_memory(tracker, sizeof(allocation_tracker));
+}
+
+static void track_allocation(void *block, u64 size, memory_tag tag,
+                             const char *file, u32 line) {
+  tracked_allocation entry = {block, size, file, line, tag};
+#if OMEMORY_TRACKING_BACKTRACE_DEPTH > 0
+  u32 frames = platform_capture_backtrace(entry.backtrace,
+                                          OMEMORY_TRACKING_BACKTRACE_DEPTH);
+  for (u32 i = frames; i < OMEMORY_TRACKING_BACKTRACE_DEPTH; ++i) {
+    entry.backtrace[i] = 0;
+  }
+#endif
+  tracker_insert(&state_ptr->tracker, &entry);
+}
+
+/**
+ * @brief Checks a free against the allocation it releases and stops
+ * tracking it. size and tag are corrected to what was allocated so the stats
+ * stay exact.
+ * @returns False if block isn't a live allocation and must not be freed.
+ */
+static b8 untrack_allocation(void *block, u64 *size, memory_tag *tag,
+                             const char *file, u32 line) {
+  allocation_tracker *tracker = &state_ptr->tracker;
+  u64 index = tracker_find(tracker, block);
+  if (index == TRACKING_NOT_FOUND) {
+    OERROR("ofree - %p freed at %s:%u is not a live allocation; double free "
+           "or not from oallocate. Ignoring.",
+           block, call_site_file(file), line);
+    return false;
+  }
+
+  tracked_allocation *entry = &tracker->entries[index];
+  if (entry->size != *size) {
+    OERROR("ofree - %p allocated as %lluB at %s:%u but freed as %lluB at "
+           "%s:%u.",
+           block, entry->size, call_site_file(entry->file), entry->line,
+           *size, call_site_file(file), line);
+    *size = entry->size;
+  }
+  if (entry->tag != *tag) {
+    OERROR("ofree - %p allocated as %s at %s:%u but freed as %s at %s:%u.",
+           block, memory_tag_strings[entry->tag], call_site_file(entry->file),
+           entry->line, memory_tag_strings[*tag], call_site_file(file), line);
+    *tag = entry->tag;
+  }
+  tracker_remove(tracker, index);
+  return true;
+}
+
+/** @brief Leaked allocations sharing a call site and tag. */
+typedef struct leak_site {
+  const tracked_allocation *first;
+  u64 count;
+  u64 bytes;
+} leak_site;
+
+static i32 compare_call_sites(const void *a, const void *b) {
+  const tracked_allocation *lhs = a;
+  const tracked_allocation *rhs = b;
+  i32 order = strcmp(call_site_file(lhs->file), call_site_file(rhs->file));
+  if (order != 0) {
+    return order;
+  }
+  if (lhs->line != rhs->line) {
+    return lhs->line < rhs->line ? -1 : 1;
+  }
+  return (i32)lhs->tag - (i32)rhs->tag;
+}
+
+static i32 compare_leak_bytes(const void *a, const void *b) {
+  const leak_site *lhs = a;
+  const leak_site *rhs = b;
+  if (lhs->bytes != rhs->bytes) {
+    return lhs->bytes > rhs->bytes ? -1 : 1;
+  }
+  return 0;
+}
+#endif
+
+/** @brief Raises peak to value if it's higher, racing safely with others. */
+static void stat_raise_peak(u64 *peak, u64 value) {
+  u64 current = STAT_LOAD(*peak);
+  while (value > current &&
+         !__atomic_compare_exchange_n(peak, &current, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+#if OMEMORY_TRACKING == 1
+/**
+ * @brief The call site entry for file, line and tag, added if new; 0 once
+ * the table is full.
+ */
+static frame_call_site *find_call_site(memory_tag tag, const char *file,
+                                       u32 line) {
+  // File names are string literals, so their addresses identify them.
+  u64 key = (u64)file ^ ((u64)line << 40) ^ ((u64)tag << 58);
+  u32 mask = CALL_SITE_SLOTS - 1;
+  for (u32 slot = mix_bits(key) & mask;; slot = (slot + 1) & mask) {
+    u16 entry = state_ptr->call_site_slots[slot];
+    if (entry == 0) {
+      if (state_ptr->call_site_count == MEMORY_FRAME_MAX_CALL_SITES) {
+        return 0;
+      }
+      frame_call_site *site =
+          &state_ptr->call_sites[state_ptr->call_site_count++];
+      platform_zero_memory(site, sizeof(frame_call_site));
+      site->file = file;
+      site->line = line;
+      site->tag = tag;
+      state_ptr->call_site_slots[slot] = (u16)state_ptr->call_site_count;
+      return site;
+    }
+    frame_call_site *site = &state_ptr->call_sites[entry - 1];
+    if (site->file == file && site->line == line && site->tag == tag) {
+      return site;
+    }
+  }
+}
+
+/** @brief Counts an allocation against its call site. Call under the lock. */
+static void record_call_site(u64 size, memory_tag tag, const char *file,
+                             u32 line) {
+  frame_call_site *site = find_call_site(tag, file, line);
+  if (!site) {
+    state_ptr->unlisted_site_count++;
     return;
   }
 
-  state_ptr = state;
-  state_ptr->alloc_count = 0;
-  platform_zero_memory(&state_ptr->stats, sizeof(state_ptr->stats));
+  if (site->frames == 0 || site->last_frame != state_ptr->frame_index) {
+    site->frames++;
+    site->last_frame = state_ptr->frame_index;
+    site->frame_count = 0;
+    site->frame_bytes = 0;
+  }
+  site->frame_count++;
+  site->frame_bytes += size;
+  site->total_count++;
+  site->total_bytes += size;
+}
+
+/** @brief Most frames first, then most allocations. */
+static i32 compare_call_site_frames(const void *a, const void *b) {
+  const frame_call_site *lhs = a;
+  const frame_call_site *rhs = b;
+  if (lhs->frames != rhs->frames) {
+    return lhs->frames > rhs->frames ? -1 : 1;
+  }
+  if (lhs->total_count != rhs->total_count) {
+    return lhs->total_count > rhs->total_count ? -1 : 1;
+  }
+  return 0;
 }
+#endif
 
-void shutdown_memory() { state_ptr = 0; }
+static void record_frame_allocation(u64 size, memory_tag tag) {
+  memory_frame_record *frame = &state_ptr->current_frame;
+  STAT_ADD(frame->alloc_count, 1);
+  STAT_ADD(frame->alloc_bytes, size);
+  STAT_ADD(frame->tagged_counts[tag], 1);
+  STAT_ADD(frame->tagged_bytes[tag], size);
+}
 
-void *oallocate(u64 size, memory_tag tag) {
+/** @brief Logs what a frame that went over budget allocated. */
+static void log_over_budget_frame(const memory_frame_record *record) {
+  OWARN("Frame %llu made %llu allocations (%lluB); the budget is %llu "
+        "allocations, %lluB.",
+        state_ptr->frame_index, record->alloc_count, record->alloc_bytes,
+        state_ptr->frame_budget_allocations, state_ptr->frame_budget_bytes);
+  for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+    if (record->tagged_counts[i]) {
+      OWARN("  %s: %llu allocations, %lluB", memory_tag_strings[i],
+            record->tagged_counts[i], record->tagged_bytes[i]);
+    }
+  }
+#if OMEMORY_TRACKING == 1
+  platform_mutex_lock(&state_ptr->allocator_mutex);
+  for (u32 i = 0; i < state_ptr->call_site_count; ++i) {
+    const frame_call_site *site = &state_ptr->call_sites[i];
+    if (site->last_frame == state_ptr->frame_index) {
+      OWARN("  %s:%u [%s] %llu allocations, %lluB", call_site_file(site->file),
+            site->line, memory_tag_strings[site->tag], site->frame_count,
+            site->frame_bytes);
+    }
+  }
+  platform_mutex_unlock(&state_ptr->allocator_mutex);
+#endif
+}
+
+b8 initialize_memory(u64 total_allocation_size) {
+  if (state_ptr) {
+    OERROR("initialize_memory called more than once.");
+    return false;
+  }
+
+  u64 allocator_requirement = 0;
+  if (!dynamic_allocator_create(total_allocation_size, &allocator_requirement,
+                                0, 0)) {
+    OFATAL("Unable to get memory requirement for the memory system arena.");
+    return false;
+  }
+
+  // The state and the arena it manages are reserved in one block.
+  u64 state_size = sizeof(memory_system_state);
+  void *block = platform_allocate(state_size + allocator_requirement, true);
+  if (!block) {
+    OFATAL("Memory system failed to reserve %lluB; cannot continue.",
+           state_size + allocator_requirement);
+    return false;
+  }
+
+  state_ptr = block;
+  platform_zero_memory(state_ptr, state_size);
+  state_ptr->total_allocation_size = total_allocation_size;
+  state_ptr->allocator_memory_requirement = allocator_requirement;
+  state_ptr->allocator_block = (u8 *)block + state_size;
+
+  if (!dynamic_allocator_create(total_allocation_size, &allocator_requirement,
+                                state_ptr->allocator_block,
+                                &state_ptr->allocator)) {
+    OFATAL("Memory system failed to create its allocator; cannot continue.");
+    platform_free(block, true);
+    state_ptr = 0;
+    return false;
+  }
+  if (!platform_mutex_create(&state_ptr->allocator_mutex)) {
+    OFATAL("Memory system failed to create its mutex; cannot continue.");
+    dynamic_allocator_destroy(&state_ptr->allocator);
+    platform_free(block, true);
+    state_ptr = 0;
+    return false;
+  }
+
+  ODEBUG("Memory system reserved %lluB.", total_allocation_size);
+  return true;
+}
+
+void shutdown_memory() {
+  if (state_ptr) {
+#if OMEMORY_TRACKING == 1
+    if (state_ptr->tracking_enabled) {
+      memory_tracking_report_leaks();
+      tracker_destroy(&state_ptr->tracker);
+    }
+#endif
+    dynamic_allocator_destroy(&state_ptr->allocator);
+    platform_mutex_destroy(&state_ptr->allocator_mutex);
+    platform_free(state_ptr, true);
+  }
+  state_ptr = 0;
+}
+
+b8 memory_tracking_enable() {
+#if OMEMORY_TRACKING == 1
+  if (!state_ptr) {
+    OERROR("memory_tracking_enable - memory system not initialized.");
+    return false;
+  }
+  if (state_ptr->tracking_enabled) {
+    return true;
+  }
+  // Frees of untracked blocks would look like double frees.
+  if (STAT_LOAD(state_ptr->alloc_count) != 0) {
+    OERROR("memory_tracking_enable must be called before the first "
+           "allocation.");
+    return false;
+  }
+  if (!tracker_rehash(&state_ptr->tracker, TRACKING_INITIAL_CAPACITY)) {
+    OERROR("memory_tracking_enable - failed to allocate the tracking table.");
+    return false;
+  }
+  state_ptr->tracking_enabled = true;
+  ODEBUG("Memory allocation tracking enabled.");
+  return true;
+#else
+  OWARN("memory_tracking_enable - tracking is not compiled in. Build with "
+        "OMEMORY_TRACKING=1.");
+  return false;
+#endif
+}
+
+u64 memory_tracking_live_count() {
+#if OMEMORY_TRACKING == 1
+  if (state_ptr && state_ptr->tracking_enabled) {
+    platform_mutex_lock(&state_ptr->allocator_mutex);
+    u64 count = state_ptr->tracker.count;
+    platform_mutex_unlock(&state_ptr->allocator_mutex);
+    return count;
+  }
+#endif
+  return 0;
+}
+
+u64 memory_tracking_report_leaks() {
+#if OMEMORY_TRACKING == 1
+  if (!state_ptr || !state_ptr->tracking_enabled) {
+    return 0;
+  }
+  allocation_tracker *tracker = &state_ptr->tracker;
+  u64 live = memory_tracking_live_count();
+  if (live == 0) {
+    return 0;
+  }
+
+  // Gather live entries, sort them by call site, then fold each run of equal
+  // sites into one row. Everything here is platform memory so the report
+  // doesn't disturb the arena it describes.
+  tracked_allocation *entries =
+      platform_allocate(live * sizeof(tracked_allocation), false);
+  leak_site *sites = platform_allocate(live * sizeof(leak_site), false);
+  if (!entries || !sites) {
+    OERROR("Memory tracking: %llu allocations still live; not enough memory "
+           "to list them.",
+           live);
+    if (entries) {
+      platform_free(entries, false);
+    }
+    if (sites) {
+      platform_free(sites, false);
+    }
+    return live;
+  }
+
+  // Other threads may allocate meanwhile; report what was live up front.
+  u64 gathered = 0;
+  u64 total_bytes = 0;
+  platform_mutex_lock(&state_ptr->allocator_mutex);
+  for (u64 i = 0; i < tracker->capacity && gathered < live; ++i) {
+    void *block = tracker->entries[i].block;
+    if (block != TRACKING_EMPTY && block != TRACKING_TOMBSTONE) {
+      entries[gathered++] = tracker->entries[i];
+      total_bytes += tracker->entries[i].size;
+    }
+  }
+  platform_mutex_unlock(&state_ptr->allocator_mutex);
+  live = gathered;
+  qsort(entries, gathered, sizeof(tracked_allocation), compare_call_sites);
+
+  u64 site_count = 0;
+  for (u64 i = 0; i < gathered; ++i) {
+    if (site_count == 0 ||
+        compare_call_sites(sites[site_count - 1].first, &entries[i]) != 0) {
+      sites[site_count++] = (leak_site){&entries[i], 0, 0};
+    }
+    sites[site_count - 1].count++;
+    sites[site_count - 1].bytes += entries[i].size;
+  }
+  qsort(sites, site_count, sizeof(leak_site), compare_leak_bytes);
+
+  OWARN("Memory leaks: %llu allocations, %lluB, from %llu call sites:", live,
+        total_bytes, site_count);
+  for (u64 i = 0; i < site_count; ++i) {
+    const tracked_allocation *first = sites[i].first;
+    OWARN("  %s:%u [%s] %llu allocations, %lluB", call_site_file(first->file),
+          first->line, memory_tag_strings[first->tag], sites[i].count,
+          sites[i].bytes);
+#if OMEMORY_TRACKING_BACKTRACE_DEPTH > 0
+    for (u32 frame = 0; frame < OMEMORY_TRACKING_BACKTRACE_DEPTH; ++frame) {
+      if (!first->backtrace[frame]) {
+        break;
+      }
+      OWARN("    #%u %p", frame, first->backtrace[frame]);
+    }
+#endif
+  }
+
+  platform_free(sites, false);
+  platform_free(entries, false);
+  return live;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Allocates and records a block without initializing its contents.
+ */
+static void *allocate(u64 size, u16 alignment, memory_tag tag,
+                      const char *file, u32 line) {
   if (tag == MEMORY_TAG_UNKNOWN) {
     OWARN(
         "oallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
   }
+  if (alignment == 0 || (alignment & (alignment - 1))) {
+    OERROR("oallocate_aligned - alignment %hu is not a power of two.",
+           alignment);
+    return 0;
+  }
 
+  void *block;
   if (state_ptr) {
-    state_ptr->stats.total_allocated += size;
-    state_ptr->stats.tagged_allocations[tag] += size;
-    state_ptr->alloc_count++;
+    platform_mutex_lock(&state_ptr->allocator_mutex);
+    block = dynamic_allocator_allocate_aligned(&state_ptr->allocator, size,
+                                               alignment);
+#if OMEMORY_TRACKING == 1
+    if (block && state_ptr->tracking_enabled) {
+      track_allocation(block, size, tag, file, line);
+      record_call_site(size, tag, file, line);
+    }
+#endif
+    platform_mutex_unlock(&state_ptr->allocator_mutex);
+    if (!block) {
+      OFATAL("oallocate - memory arena exhausted allocating %lluB as %s at "
+             "%s:%u.",
+             size, memory_tag_strings[tag], call_site_file(file), line);
+      return 0;
+    }
+    record_frame_allocation(size, tag);
+    struct memory_stats *stats = &state_ptr->stats;
+    u64 total = STAT_ADD(stats->total_allocated, size);
+    u64 tagged = STAT_ADD(stats->tagged_allocations[tag], size);
+    stat_raise_peak(&stats->peak_allocated, total);
+    stat_raise_peak(&stats->tagged_peaks[tag], tagged);
+    STAT_ADD(stats->tagged_counts[tag], 1);
+    STAT_ADD(state_ptr->alloc_count, 1);
+  } else if (alignment <= OMEMORY_DEFAULT_ALIGNMENT) {
+    // Before the memory system is up, fall back to the platform.
+    block = platform_allocate(size, false);
+  } else {
+    block = platform_allocate_aligned(size, alignment);
   }
+  return block;
+}
 
-  // TODO: Memory alignment
-  void *block = platform_allocate(size, false);
-  platform_zero_memory(block, size); // zero out the malloc
+void *omemory_allocate_at(u64 size, u16 alignment, b8 zero, memory_tag tag,
+                          const char *file, u32 line) {
+  void *block = allocate(size, alignment, tag, file, line);
+  if (block && zero) {
+    platform_zero_memory(block, size);
+  }
   return block;
 }
 
+void *oallocate(u64 size, memory_tag tag) {
+  return omemory_allocate_at(size, 1, true, tag, 0, 0);
+}
+
+void *oallocate_aligned(u64 size, u16 alignment, memory_tag tag) {
+  return omemory_allocate_at(size, alignment, true, tag, 0, 0);
+}
+
+void *oallocate_uninit(u64 size, memory_tag tag) {
+  return omemory_allocate_at(size, 1, false, tag, 0, 0);
+}
+
 void ofree(void *block, u64 size, memory_tag tag) {
+  omemory_free_at(block, size, 1, tag, 0, 0);
+}
+
+void ofree_aligned(void *block, u64 size, u16 alignment, memory_tag tag) {
+  omemory_free_at(block, size, alignment, tag, 0, 0);
+}
+
+void omemory_free_at(void *block, u64 size, u16 alignment, memory_tag tag,
+                     const char *file, u32 line) {
   if (tag == MEMORY_TAG_UNKNOWN) {
     OWARN(
         "oallocated called using MEMORY_TAG_UNKNOWN. Re-class this allocation");
   }
 
-  state_ptr->stats.total_allocated -= size;
-  state_ptr->stats.tagged_allocations[tag] -= size;
-
-  // TODO: Memory alignment
-  platform_free(block, false);
+  // Blocks from before initialization were never counted.
+  if (state_ptr && dynamic_allocator_owns(&state_ptr->allocator, block)) {
+    platform_mutex_lock(&state_ptr->allocator_mutex);
+#if OMEMORY_TRACKING == 1
+    if (state_ptr->tracking_enabled &&
+        !untrack_allocation(block, &size, &tag, file, line)) {
+      platform_mutex_unlock(&state_ptr->allocator_mutex);
+      return;
+    }
+#endif
+    // Arena blocks start at their aligned address; no adjustment needed.
+    dynamic_allocator_free(&state_ptr->allocator, block);
+    platform_mutex_unlock(&state_ptr->allocator_mutex);
+    STAT_SUB(state_ptr->stats.total_allocated, size);
+    STAT_SUB(state_ptr->stats.tagged_allocations[tag], size);
+  } else if (alignment <= OMEMORY_DEFAULT_ALIGNMENT) {
+    platform_free(block, false);
+  } else {
+    platform_free_aligned(block);
+  }
 }
 
 void *ozero_memory(void *block, u64 size) {
@@ -76,49 +744,254 @@ void *ocopy_memory(void *dest, const void *source, u64 size) {
   return platform_copy_memory(dest, source, size);
 }
 
+void *omove_memory(void *dest, const void *source, u64 size) {
+  return platform_move_memory(dest, source, size);
+}
+
 void *oset_memory(void *dest, i32 value, u64 size) {
   return platform_set_memory(dest, value, size);
 }
 
-char *get_memory_usage_str() {
-
+/**
+ * @brief Scales bytes to the largest unit it reaches, for display.
+ */
+static f32 scale_size(u64 bytes, const char **out_unit) {
   const u64 gib = 1024 * 1024 * 1024;
   const u64 mib = 1024 * 1024;
   const u64 kib = 1024;
+  if (bytes >= gib) {
+    *out_unit = "GiB";
+    return bytes / (f32)gib;
+  } else if (bytes >= mib) {
+    *out_unit = "MiB";
+    return bytes / (f32)mib;
+  } else if (bytes >= kib) {
+    *out_unit = "KiB";
+    return bytes / (f32)kib;
+  }
+  *out_unit = "B";
+  return (f32)bytes;
+}
 
+char *get_memory_usage_str() {
+  if (!state_ptr) {
+    return string_duplicate("Memory system not initialized.\n");
+  }
+
+  const u64 buffer_size = 8000;
   char buffer[8000] = "System memory use (tagged):\n";
   u64 offset = string_length(buffer);
 
+  // Only atomic loads; safe to call every frame while other threads allocate.
+  struct memory_stats *stats = &state_ptr->stats;
   for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
-    char unit[4] = "xib"; // X bytes, holder string
-    float amount = 1.0f;
-    // detection code
-    if (state_ptr->stats.tagged_allocations[i] >= gib) {
-      unit[0] = 'G';
-      amount = state_ptr->stats.tagged_allocations[i] / (float)gib;
-    } else if (state_ptr->stats.tagged_allocations[i] >= mib) {
-      unit[0] = 'M';
-      amount = state_ptr->stats.tagged_allocations[i] / (float)mib;
-    } else if (state_ptr->stats.tagged_allocations[i] >= kib) {
-      unit[0] = 'K';
-      amount = state_ptr->stats.tagged_allocations[i] / (float)kib;
-    } else {
-      unit[0] = 'B';
-      unit[1] = 0;
-      amount = (float)state_ptr->stats.tagged_allocations[i];
-    }
-
-    i32 length = snprintf(buffer + offset, 8000, "  %s: %.2f%s\n",
-                          memory_tag_strings[i], amount, unit);
+    const char *unit;
+    const char *peak_unit;
+    f32 amount = scale_size(STAT_LOAD(stats->tagged_allocations[i]), &unit);
+    f32 peak = scale_size(STAT_LOAD(stats->tagged_peaks[i]), &peak_unit);
+    i32 length = snprintf(buffer + offset, buffer_size - offset,
+                          "  %s: %.2f%s (peak %.2f%s, %llu allocs)\n",
+                          memory_tag_strings[i], amount, unit, peak, peak_unit,
+                          STAT_LOAD(stats->tagged_counts[i]));
     offset += length; // length of composed string, move the pointer up
   }
+
+  const char *unit;
+  f32 peak = scale_size(STAT_LOAD(stats->peak_allocated), &unit);
+  offset += snprintf(buffer + offset, buffer_size - offset,
+                     "Peak tagged use: %.2f%s\n", peak, unit);
+
+  const f32 mib = 1024 * 1024;
+  dynamic_allocator_stats arena;
+  platform_mutex_lock(&state_ptr->allocator_mutex);
+  dynamic_allocator_get_stats(&state_ptr->allocator, &arena);
+  platform_mutex_unlock(&state_ptr->allocator_mutex);
+  snprintf(buffer + offset, buffer_size - offset,
+           "Arena: %.2fMiB / %.2fMiB used, largest free block %.2fMiB, "
+           "fragmentation %.1f%%\n",
+           (arena.total_size - arena.free_space) / mib, arena.total_size / mib,
+           arena.largest_free_block / mib, arena.fragmentation * 100.0f);
   char *out_string = string_duplicate(buffer);
   return out_string;
 }
 
 u64 get_memory_alloc_count() {
   if (state_ptr) {
-    return state_ptr->alloc_count;
+    return STAT_LOAD(state_ptr->alloc_count);
+  }
+  return 0;
+}
+
+u64 get_memory_peak_usage() {
+  if (state_ptr) {
+    return STAT_LOAD(state_ptr->stats.peak_allocated);
+  }
+  return 0;
+}
+
+u64 get_memory_tag_usage(memory_tag tag) {
+  if (state_ptr) {
+    return STAT_LOAD(state_ptr->stats.tagged_allocations[tag]);
+  }
+  return 0;
+}
+
+u64 get_memory_tag_alloc_count(memory_tag tag) {
+  if (state_ptr) {
+    return STAT_LOAD(state_ptr->stats.tagged_counts[tag]);
   }
   return 0;
-}
\ No newline at end of file
+}
+
+void memory_frame_end() {
+  if (!state_ptr) {
+    return;
+  }
+
+  memory_frame_record *current = &state_ptr->current_frame;
+  memory_frame_record *record =
+      &state_ptr->frame_history[state_ptr->frame_history_head];
+  record->alloc_count = STAT_TAKE(current->alloc_count);
+  record->alloc_bytes = STAT_TAKE(current->alloc_bytes);
+  for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+    record->tagged_counts[i] = STAT_TAKE(current->tagged_counts[i]);
+    record->tagged_bytes[i] = STAT_TAKE(current->tagged_bytes[i]);
+  }
+  record->over_budget =
+      state_ptr->frame_budget_enabled &&
+      (record->alloc_count > state_ptr->frame_budget_allocations ||
+       record->alloc_bytes > state_ptr->frame_budget_bytes);
+
+  if (record->over_budget) {
+    // Log the first frame over budget, then once per history window while
+    // it stays over.
+    if (state_ptr->over_budget_streak % MEMORY_FRAME_HISTORY == 0) {
+      log_over_budget_frame(record);
+    }
+    state_ptr->over_budget_streak++;
+    OASSERT_MSG(!state_ptr->frame_budget_assert,
+                "Per-frame allocation budget exceeded.");
+  } else {
+    state_ptr->over_budget_streak = 0;
+  }
+
+  state_ptr->frame_history_head =
+      (state_ptr->frame_history_head + 1) % MEMORY_FRAME_HISTORY;
+  if (state_ptr->frame_history_count < MEMORY_FRAME_HISTORY) {
+    state_ptr->frame_history_count++;
+  }
+  state_ptr->frame_index++;
+}
+
+void memory_get_frame_stats(memory_frame_stats *out_stats) {
+  ozero_memory(out_stats, sizeof(memory_frame_stats));
+  if (!state_ptr || state_ptr->frame_history_count == 0) {
+    return;
+  }
+
+  u32 count = state_ptr->frame_history_count;
+  u64 total_count = 0;
+  u64 total_bytes = 0;
+  for (u32 i = 0; i < count; ++i) {
+    const memory_frame_record *record = &state_ptr->frame_history[i];
+    total_count += record->alloc_count;
+    total_bytes += record->alloc_bytes;
+    if (record->alloc_count) {
+      out_stats->allocating_frames++;
+    }
+    if (record->over_budget) {
+      out_stats->over_budget_frames++;
+    }
+    if (record->alloc_count > out_stats->max_alloc_count) {
+      out_stats->max_alloc_count = record->alloc_count;
+    }
+    if (record->alloc_bytes > out_stats->max_alloc_bytes) {
+      out_stats->max_alloc_bytes = record->alloc_bytes;
+    }
+    for (u32 tag = 0; tag < MEMORY_TAG_MAX_TAGS; ++tag) {
+      out_stats->tagged_counts[tag] += record->tagged_counts[tag];
+      out_stats->tagged_bytes[tag] += record->tagged_bytes[tag];
+    }
+  }
+
+  u32 last = (state_ptr->frame_history_head + MEMORY_FRAME_HISTORY - 1) %
+             MEMORY_FRAME_HISTORY;
+  out_stats->sample_count = count;
+  out_stats->last_alloc_count = state_ptr->frame_history[last].alloc_count;
+  out_stats->last_alloc_bytes = state_ptr->frame_history[last].alloc_bytes;
+  out_stats->avg_alloc_count = (f64)total_count / count;
+  out_stats->avg_alloc_bytes = (f64)total_bytes / count;
+}
+
+void memory_set_frame_budget(u64 max_allocations, u64 max_bytes,
+                             b8 assert_on_exceed) {
+  if (!state_ptr) {
+    return;
+  }
+  state_ptr->frame_budget_enabled = true;
+  state_ptr->frame_budget_allocations = max_allocations;
+  state_ptr->frame_budget_bytes = max_bytes;
+  state_ptr->frame_budget_assert = assert_on_exceed;
+  state_ptr->over_budget_streak = 0;
+}
+
+void memory_clear_frame_budget() {
+  if (state_ptr) {
+    state_ptr->frame_budget_enabled = false;
+    state_ptr->frame_budget_assert = false;
+  }
+}
+
+void memory_log_frame_report() {
+  if (!state_ptr) {
+    return;
+  }
+
+  memory_frame_stats stats;
+  memory_get_frame_stats(&stats);
+  OINFO("Allocations per frame over the last %u frames: avg %.1f (max %llu), "
+        "avg %.0fB (max %lluB). %u frames allocated, %u over budget.",
+        stats.sample_count, stats.avg_alloc_count, stats.max_alloc_count,
+        stats.avg_alloc_bytes, stats.max_alloc_bytes, stats.allocating_frames,
+        stats.over_budget_frames);
+  for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+    if (stats.tagged_counts[i]) {
+      OINFO("  %s: %llu allocations, %lluB", memory_tag_strings[i],
+            stats.tagged_counts[i], stats.tagged_bytes[i]);
+    }
+  }
+
+#if OMEMORY_TRACKING == 1
+  // Take the sites and start the next report window in one step.
+  frame_call_site sites[MEMORY_FRAME_MAX_CALL_SITES];
+  platform_mutex_lock(&state_ptr->allocator_mutex);
+  u32 site_count = state_ptr->call_site_count;
+  u64 unlisted_count = state_ptr->unlisted_site_count;
+  u64 frames = state_ptr->frame_index - state_ptr->report_start_frame;
+  ocopy_memory(sites, state_ptr->call_sites,
+               site_count * sizeof(frame_call_site));
+  state_ptr->call_site_count = 0;
+  state_ptr->unlisted_site_count = 0;
+  platform_zero_memory(state_ptr->call_site_slots,
+                       sizeof(state_ptr->call_site_slots));
+  state_ptr->report_start_frame = state_ptr->frame_index;
+  platform_mutex_unlock(&state_ptr->allocator_mutex);
+
+  if (site_count) {
+    qsort(sites, site_count, sizeof(frame_call_site),
+          compare_call_site_frames);
+
+    OINFO("Allocating call sites over the last %llu frames:", frames);
+    for (u32 i = 0; i < site_count; ++i) {
+      OINFO("  %s:%u [%s] in %u frames, %llu allocations, %lluB",
+            call_site_file(sites[i].file), sites[i].line,
+            memory_tag_strings[sites[i].tag], sites[i].frames,
+            sites[i].total_count, sites[i].total_bytes);
+    }
+    if (unlisted_count) {
+      OINFO("  %llu more allocations from sites past the first %u.",
+            unlisted_count, MEMORY_FRAME_MAX_CALL_SITES);
+    }
+  }
+#endif
+}
@@ -26,19 +26,200 @@ typedef enum memory_tag {
   MEMORY_TAG_MAX_TAGS
 } memory_tag;
 
-OAPI void initialize_memory();
+// Allocation tracking support; compiled in for debug builds by default.
+// Tracking still has to be switched on with memory_tracking_enable.
+#ifndef OMEMORY_TRACKING
+#ifdef _DEBUG
+#define OMEMORY_TRACKING 1
+#else
+#define OMEMORY_TRACKING 0
+#endif
+#endif
+
+// Number of return addresses recorded per tracked allocation; 0 disables
+// backtraces.
+#ifndef OMEMORY_TRACKING_BACKTRACE_DEPTH
+#define OMEMORY_TRACKING_BACKTRACE_DEPTH 0
+#endif
+
+// Number of frames kept for rolling per-frame allocation statistics
+#define MEMORY_FRAME_HISTORY 120
+// Max distinct call sites recorded between frame reports
+#define MEMORY_FRAME_MAX_CALL_SITES 128
+
+/**
+ * @brief Arena allocations made per frame, over the last MEMORY_FRAME_HISTORY
+ * frames closed with memory_frame_end.
+ */
+typedef struct memory_frame_stats {
+  u32 sample_count;
+  /** @brief Frames in the window that allocated at all. */
+  u32 allocating_frames;
+  /** @brief Frames in the window that exceeded the budget. */
+  u32 over_budget_frames;
+  /** @brief Allocations made during the most recently closed frame. */
+  u64 last_alloc_count;
+  u64 last_alloc_bytes;
+  f64 avg_alloc_count;
+  u64 max_alloc_count;
+  f64 avg_alloc_bytes;
+  u64 max_alloc_bytes;
+  /** @brief Allocations per tag summed over the window. */
+  u64 tagged_counts[MEMORY_TAG_MAX_TAGS];
+  u64 tagged_bytes[MEMORY_TAG_MAX_TAGS];
+} memory_frame_stats;
+
+/**
+ * @brief Alignment every oallocate block is guaranteed to have. Larger
+ * alignments must use oallocate_aligned.
+ */
+#define OMEMORY_DEFAULT_ALIGNMENT 16
+
+/**
+ * @brief Initializes the memory system, reserving a single arena that every
+ * later oallocate is served from. The arena is the engine's memory budget;
+ * allocations fail once it's exhausted rather than growing it.
+ *
+ * Blocks allocated before initialization come from the platform allocator,
+ * and can still be passed to ofree afterwards. Allocating and freeing are
+ * safe from any thread; arena calls are serialized by a mutex.
+ *
+ * @param total_allocation_size The size of the arena in bytes.
+ * @return b8 True on success; otherwise false.
+ */
+OAPI b8 initialize_memory(u64 total_allocation_size);
+
+/** @brief Releases the arena. Every block allocated from it becomes invalid. */
 OAPI void shutdown_memory();
 
+/** @brief Allocates a zeroed block of size bytes. */
 OAPI void *oallocate(u64 size, memory_tag tag);
 
+/**
+ * @brief Allocates a block of size bytes without zeroing it. For buffers that
+ * are about to be completely overwritten, where clearing them first is just
+ * wasted memory bandwidth. Freed with ofree.
+ */
+OAPI void *oallocate_uninit(u64 size, memory_tag tag);
+
 OAPI void ofree(void *block, u64 size, memory_tag tag);
 
+/**
+ * @brief Allocates a zeroed block starting at a multiple of alignment.
+ * @param alignment A power of two.
+ * @returns The block, or 0 on failure.
+ */
+OAPI void *oallocate_aligned(u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief Frees a block from oallocate_aligned. alignment must match the value
+ * the block was allocated with.
+ */
+OAPI void ofree_aligned(void *block, u64 size, u16 alignment, memory_tag tag);
+
+/**
+ * @brief Allocates through the memory system, recording file and line as the
+ * call site when tracking is on. Normally reached through the oallocate
+ * macros rather than called directly.
+ */
+OAPI void *omemory_allocate_at(u64 size, u16 alignment, b8 zero,
+                               memory_tag tag, const char *file, u32 line);
+
+/**
+ * @brief Frees through the memory system, recording file and line as the
+ * call site when tracking is on. Normally reached through the ofree macros.
+ */
+OAPI void omemory_free_at(void *block, u64 size, u16 alignment,
+                          memory_tag tag, const char *file, u32 line);
+
+/**
+ * @brief Starts recording every live allocation with its size, tag and call
+ * site. Frees are then checked for double frees and size mismatches, and
+ * leaks are reported at shutdown. Must be called before the first
+ * allocation from the arena.
+ * @returns False if tracking isn't compiled in or allocations have already
+ * been made.
+ */
+OAPI b8 memory_tracking_enable();
+
+/** @brief Number of allocations currently live, or 0 if not tracking. */
+OAPI u64 memory_tracking_live_count();
+
+/**
+ * @brief Logs every live allocation, grouped by call site, largest first.
+ * @returns The number of live allocations.
+ */
+OAPI u64 memory_tracking_report_leaks();
+
 OAPI void *ozero_memory(void *block, u64 size);
 
 OAPI void *ocopy_memory(void *dest, const void *source, u64 size);
 
+/** @brief Copies size bytes where dest and source may overlap. */
+OAPI void *omove_memory(void *dest, const void *source, u64 size);
+
 OAPI void *oset_memory(void *dest, i32 value, u64 size);
 
+/**
+ * @brief Formats current, peak and per-tag usage plus arena fragmentation.
+ * The caller owns the returned string.
+ */
 OAPI char *get_memory_usage_str();
 
-OAPI u64 get_memory_alloc_count();
\ No newline at end of file
+/** @brief Total number of allocations made from the arena. */
+OAPI u64 get_memory_alloc_count();
+
+/** @brief The most tagged memory in use at once since initialization. */
+OAPI u64 get_memory_peak_usage();
+
+/** @brief Bytes currently allocated under tag. */
+OAPI u64 get_memory_tag_usage(memory_tag tag);
+
+/** @brief Total number of allocations made under tag. */
+OAPI u64 get_memory_tag_alloc_count(memory_tag tag);
+
+/**
+ * @brief Closes the current frame's allocation counts into the rolling
+ * history and checks them against the budget, if one is set. Called once per
+ * frame by the application.
+ */
+OAPI void memory_frame_end();
+
+OAPI void memory_get_frame_stats(memory_frame_stats *out_stats);
+
+/**
+ * @brief Sets the most arena allocations a single frame may make. Frames
+ * over budget are logged with the tags that allocated, and the call sites
+ * too while tracking is enabled.
+ * @param max_allocations Allocations allowed per frame; 0 for a steady state
+ * that never allocates.
+ * @param max_bytes Bytes allowed per frame.
+ * @param assert_on_exceed If true, an over-budget frame also fails an
+ * assertion.
+ */
+OAPI void memory_set_frame_budget(u64 max_allocations, u64 max_bytes,
+                                  b8 assert_on_exceed);
+
+OAPI void memory_clear_frame_budget();
+
+/**
+ * @brief Logs the rolling per-frame statistics by tag. While tracking is
+ * enabled, also logs every call site that allocated since the last report,
+ * ordered by how many frames it allocated in; sites allocating every frame
+ * are the steady-state offenders. Clears the call sites afterwards.
+ */
+OAPI void memory_log_frame_report();
+
+#if OMEMORY_TRACKING == 1
+// Route the public allocation functions through the call-site variants.
+#define oallocate(size, tag)                                                   \
+  omemory_allocate_at(size, 1, true, tag, __FILE__, __LINE__)
+#define oallocate_uninit(size, tag)                                            \
+  omemory_allocate_at(size, 1, false, tag, __FILE__, __LINE__)
+#define oallocate_aligned(size, alignment, tag)                                \
+  omemory_allocate_at(size, alignment, true, tag, __FILE__, __LINE__)
+#define ofree(block, size, tag)                                                \
+  omemory_free_at(block, size, 1, tag, __FILE__, __LINE__)
+#define ofree_aligned(block, size, alignment, tag)                             \
+  omemory_free_at(block, size, alignment, tag, __FILE__, __LINE__)
+#endif
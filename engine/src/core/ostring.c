@@ -1,5 +1,7 @@
 #include "core/ostring.h"
+#include "core/application.h"
 #include "core/omemory.h"
+#include "memory/stack_allocator.h"
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -31,12 +33,39 @@ i32 string_format(char *dest, const char *format, ...) {
 
 i32 string_format_v(char *dest, const char *format, void *va_listp) {
   if (dest) {
-    // Big, but can fit on the stack.
-    char buffer[32000];
-    i32 written = vsnprintf(buffer, 32000, format, va_listp);
-    buffer[written] = 0;
-    ocopy_memory(dest, buffer, written + 1);
+    // Formatted into scratch first, as dest may also be one of the arguments.
+    const u64 buffer_size = 32000;
+    stack_allocator *scratch = application_get_frame_allocator();
+    // Off the main thread there's no frame memory, and near the end of a busy
+    // frame it may not have room; fall back to the arena either way.
+    if (scratch && scratch->total_size - scratch->allocated < buffer_size) {
+      scratch = 0;
+    }
+    stack_allocator_marker marker = 0;
+    char *buffer;
+    if (scratch) {
+      marker = stack_allocator_get_marker(scratch);
+      buffer = stack_allocator_allocate(scratch, buffer_size);
+    } else {
+      buffer = oallocate_uninit(buffer_size, MEMORY_TAG_STRING);
+    }
+    if (!buffer) {
+      return -1;
+    }
 
+    i32 written = vsnprintf(buffer, buffer_size, format, va_listp);
+    if (written >= (i32)buffer_size) {
+      written = buffer_size - 1;
+    }
+    if (written >= 0) {
+      ocopy_memory(dest, buffer, written + 1);
+    }
+
+    if (scratch) {
+      stack_allocator_free_to_marker(scratch, marker);
+    } else {
+      ofree(buffer, buffer_size, MEMORY_TAG_STRING);
+    }
     return written;
   }
   return -1;
@@ -0,0 +1,313 @@
+#include "profiler.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+#include "core/ostring.h"
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include <stdlib.h>
+
+// Trace thread ids, shown as separate tracks
+#define PROFILER_TRACK_CPU 0
+#define PROFILER_TRACK_GPU 1
+
+typedef struct profiler_open_zone {
+  const char *name;
+  f64 start_time;
+} profiler_open_zone;
+
+typedef struct profiler_event {
+  const char *name;
+  f64 start_time;
+  f64 duration;
+  u32 track;
+} profiler_event;
+
+/**
+ * @brief A ring of the most recent frame times.
+ */
+typedef struct profiler_history {
+  f64 samples[PROFILER_FRAME_HISTORY];
+  u32 head;
+  u32 count;
+} profiler_history;
+
+typedef struct profiler_state {
+  profiler_open_zone zone_stack[PROFILER_MAX_ZONE_DEPTH];
+  u32 zone_depth;
+  // Zones opened past PROFILER_MAX_ZONE_DEPTH, ignored but balanced
+  u32 overflow_depth;
+
+  f64 frame_start_time;
+  profiler_history cpu_frames;
+  profiler_history gpu_frames;
+
+  b8 capturing;
+  f64 capture_start_time;
+  u32 capture_count;
+  u32 capture_dropped;
+  profiler_event capture_events[PROFILER_MAX_CAPTURE_EVENTS];
+} profiler_state;
+
+static profiler_state *state_ptr;
+
+static void history_push(profiler_history *history, f64 sample);
+static void history_stats(const profiler_history *history,
+                          profiler_stats *out_stats);
+static void capture_event(const char *name, f64 start_time, f64 duration,
+                          u32 track);
+
+b8 initialize_profiler(u64 *memory_requirement, void *state) {
+  *memory_requirement = sizeof(profiler_state);
+  if (state == 0) {
+    return true;
+  }
+
+  state_ptr = state;
+  ozero_memory(state_ptr, sizeof(profiler_state));
+  return true;
+}
+
+void shutdown_profiler(void *state) {
+  if (state_ptr && state_ptr->capturing) {
+    OWARN("Profiler shut down with a trace capture in progress; discarding.");
+  }
+  state_ptr = 0;
+}
+
+void profiler_frame_begin() {
+  if (!state_ptr) {
+    return;
+  }
+  state_ptr->frame_start_time = platform_get_absolute_time();
+  profiler_zone_begin("Frame");
+}
+
+void profiler_frame_end() {
+  if (!state_ptr) {
+    return;
+  }
+  profiler_zone_end();
+  f64 elapsed = platform_get_absolute_time() - state_ptr->frame_start_time;
+  history_push(&state_ptr->cpu_frames, elapsed * 1000.0);
+}
+
+void profiler_zone_begin(const char *name) {
+  if (!state_ptr) {
+    return;
+  }
+  if (state_ptr->zone_depth >= PROFILER_MAX_ZONE_DEPTH) {
+    state_ptr->overflow_depth++;
+    return;
+  }
+  profiler_open_zone *zone = &state_ptr->zone_stack[state_ptr->zone_depth++];
+  zone->name = name;
+  zone->start_time = platform_get_absolute_time();
+}
+
+void profiler_zone_end() {
+  if (!state_ptr) {
+    return;
+  }
+  if (state_ptr->overflow_depth) {
+    state_ptr->overflow_depth--;
+    return;
+  }
+  if (state_ptr->zone_depth == 0) {
+    OWARN("profiler_zone_end called without a matching zone begin.");
+    return;
+  }
+  profiler_open_zone *zone = &state_ptr->zone_stack[--state_ptr->zone_depth];
+  // Zones opened before the capture began would start at a negative time.
+  if (state_ptr->capturing &&
+      zone->start_time >= state_ptr->capture_start_time) {
+    f64 duration = platform_get_absolute_time() - zone->start_time;
+    capture_event(zone->name, zone->start_time, duration, PROFILER_TRACK_CPU);
+  }
+}
+
+void profiler_report_gpu_frame(f64 submit_time, f64 gpu_ms) {
+  if (!state_ptr) {
+    return;
+  }
+  history_push(&state_ptr->gpu_frames, gpu_ms);
+  if (state_ptr->capturing && submit_time >= state_ptr->capture_start_time) {
+    capture_event("GPU Frame", submit_time, gpu_ms / 1000.0,
+                  PROFILER_TRACK_GPU);
+  }
+}
+
+void profiler_get_cpu_frame_stats(profiler_stats *out_stats) {
+  ozero_memory(out_stats, sizeof(profiler_stats));
+  if (state_ptr) {
+    history_stats(&state_ptr->cpu_frames, out_stats);
+  }
+}
+
+void profiler_get_gpu_frame_stats(profiler_stats *out_stats) {
+  ozero_memory(out_stats, sizeof(profiler_stats));
+  if (state_ptr) {
+    history_stats(&state_ptr->gpu_frames, out_stats);
+  }
+}
+
+void profiler_capture_begin() {
+  if (!state_ptr) {
+    return;
+  }
+  state_ptr->capturing = true;
+  state_ptr->capture_start_time = platform_get_absolute_time();
+  state_ptr->capture_count = 0;
+  state_ptr->capture_dropped = 0;
+}
+
+b8 profiler_is_capturing() { return state_ptr && state_ptr->capturing; }
+
+/**
+ * @brief Appends text to a chunk buffer, writing the chunk out when it fills
+ * up so the file isn't written one event at a time.
+ */
+typedef struct trace_writer {
+  file_handle *file;
+  char chunk[16384];
+  u64 used;
+  b8 failed;
+} trace_writer;
+
+static void trace_writer_flush(trace_writer *writer) {
+  if (writer->used && !writer->failed) {
+    u64 written = 0;
+    if (!filesystem_write(writer->file, writer->used, writer->chunk,
+                          &written)) {
+      writer->failed = true;
+    }
+  }
+  writer->used = 0;
+}
+
+static void trace_writer_append(trace_writer *writer, const char *text) {
+  u64 length = string_length(text);
+  if (writer->used + length > sizeof(writer->chunk)) {
+    trace_writer_flush(writer);
+  }
+  ocopy_memory(writer->chunk + writer->used, text, length);
+  writer->used += length;
+}
+
+b8 profiler_capture_end(const char *path) {
+  if (!state_ptr || !state_ptr->capturing) {
+    OWARN("profiler_capture_end called with no capture in progress.");
+    return false;
+  }
+  state_ptr->capturing = false;
+
+  file_handle file;
+  if (!filesystem_open(path, FILE_MODE_WRITE, false, &file)) {
+    OERROR("Unable to open %s to write profiler trace.", path);
+    return false;
+  }
+
+  trace_writer *writer = oallocate(sizeof(trace_writer), MEMORY_TAG_STRING);
+  writer->file = &file;
+
+  // Name the tracks, then one complete ("X") event per zone.
+  trace_writer_append(
+      writer,
+      "{\"traceEvents\":[\n"
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,"
+      "\"args\":{\"name\":\"CPU\"}},\n"
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,"
+      "\"args\":{\"name\":\"GPU\"}}");
+
+  char line[512];
+  for (u32 i = 0; i < state_ptr->capture_count; ++i) {
+    profiler_event *event = &state_ptr->capture_events[i];
+    // Trace timestamps are in microseconds.
+    f64 ts = (event->start_time - state_ptr->capture_start_time) * 1000000.0;
+    f64 dur = event->duration * 1000000.0;
+    string_format(line,
+                  ",\n{\"name\":\"%.200s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+                  "\"ts\":%.3f,\"dur\":%.3f}",
+                  event->name, event->track, ts, dur);
+    trace_writer_append(writer, line);
+  }
+  trace_writer_append(writer, "\n]}\n");
+  trace_writer_flush(writer);
+
+  b8 success = !writer->failed;
+  ofree(writer, sizeof(trace_writer), MEMORY_TAG_STRING);
+  filesystem_close(&file);
+
+  if (!success) {
+    OERROR("Failed writing profiler trace to %s.", path);
+    return false;
+  }
+  if (state_ptr->capture_dropped) {
+    OWARN("Profiler trace was full; %u zones were dropped.",
+          state_ptr->capture_dropped);
+  }
+  OINFO("Wrote %u profiler zones to %s.", state_ptr->capture_count, path);
+  return true;
+}
+
+static void capture_event(const char *name, f64 start_time, f64 duration,
+                          u32 track) {
+  if (state_ptr->capture_count >= PROFILER_MAX_CAPTURE_EVENTS) {
+    state_ptr->capture_dropped++;
+    return;
+  }
+  u32 index = state_ptr->capture_count++;
+  profiler_event *event = &state_ptr->capture_events[index];
+  event->name = name;
+  event->start_time = start_time;
+  event->duration = duration;
+  event->track = track;
+}
+
+static void history_push(profiler_history *history, f64 sample) {
+  history->samples[history->head] = sample;
+  history->head = (history->head + 1) % PROFILER_FRAME_HISTORY;
+  if (history->count < PROFILER_FRAME_HISTORY) {
+    history->count++;
+  }
+}
+
+static i32 compare_f64(const void *a, const void *b) {
+  f64 lhs = *(const f64 *)a;
+  f64 rhs = *(const f64 *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * @brief Nearest-rank percentile of an ascending sorted array.
+ */
+static f64 percentile(const f64 *sorted, u32 count, u32 percent) {
+  u32 rank = (percent * count + 99) / 100;
+  return sorted[rank ? rank - 1 : 0];
+}
+
+static void history_stats(const profiler_history *history,
+                          profiler_stats *out_stats) {
+  u32 count = history->count;
+  out_stats->sample_count = count;
+  if (count == 0) {
+    return;
+  }
+
+  // Sorting a copy is fine; stats are only requested occasionally.
+  f64 sorted[PROFILER_FRAME_HISTORY];
+  ocopy_memory(sorted, history->samples, sizeof(f64) * count);
+  qsort(sorted, count, sizeof(f64), compare_f64);
+
+  f64 total = 0;
+  for (u32 i = 0; i < count; ++i) {
+    total += sorted[i];
+  }
+  out_stats->min = sorted[0];
+  out_stats->max = sorted[count - 1];
+  out_stats->avg = total / count;
+  out_stats->p50 = percentile(sorted, count, 50);
+  out_stats->p95 = percentile(sorted, count, 95);
+  out_stats->p99 = percentile(sorted, count, 99);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "defines.h"
+
+// Profiling zones compile out when this is 0.
+#ifndef OPROFILE_ENABLED
+#define OPROFILE_ENABLED 1
+#endif
+
+// Number of frames kept for rolling frame statistics
+#define PROFILER_FRAME_HISTORY 240
+// Max nesting of open zones
+#define PROFILER_MAX_ZONE_DEPTH 32
+// Max number of zones recorded during a single trace capture
+#define PROFILER_MAX_CAPTURE_EVENTS 65536
+
+/**
+ * @brief Rolling statistics over the last PROFILER_FRAME_HISTORY frames. All
+ * times are in milliseconds.
+ */
+typedef struct profiler_stats {
+  u32 sample_count;
+  f64 min;
+  f64 avg;
+  f64 max;
+  f64 p50;
+  f64 p95;
+  f64 p99;
+} profiler_stats;
+
+/**
+ * @brief Initializes the profiler. Call twice; once with state = 0 to get
+ * required memory size, then a second time passing allocated memory to state.
+ *
+ * @param memory_requirement A pointer to hold the required memory size of
+ * internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated
+ * block of memory.
+ * @return b8 True on success; otherwise false.
+ */
+OAPI b8 initialize_profiler(u64 *memory_requirement, void *state);
+OAPI void shutdown_profiler(void *state);
+
+/**
+ * @brief Marks the start of a frame. Opens a "Frame" zone that every other
+ * zone recorded this frame nests under.
+ */
+OAPI void profiler_frame_begin();
+
+/** @brief Closes the frame zone and records the CPU frame time. */
+OAPI void profiler_frame_end();
+
+/**
+ * @brief Opens a zone, nested under the currently open zone if any. The
+ * profiler is not thread-safe; zones should only be opened on the main
+ * thread.
+ * @param name The zone's name. Only the pointer is stored, so this should be
+ * a string literal.
+ */
+OAPI void profiler_zone_begin(const char *name);
+
+/** @brief Closes the most recently opened zone. */
+OAPI void profiler_zone_end();
+
+/**
+ * @brief Records the GPU time of a frame.
+ * @param submit_time Absolute time the frame's work was submitted. Used to
+ * place the GPU work on the CPU timeline in traces.
+ * @param gpu_ms GPU execution time of the frame in milliseconds.
+ */
+OAPI void profiler_report_gpu_frame(f64 submit_time, f64 gpu_ms);
+
+OAPI void profiler_get_cpu_frame_stats(profiler_stats *out_stats);
+OAPI void profiler_get_gpu_frame_stats(profiler_stats *out_stats);
+
+/**
+ * @brief Starts recording zones for a trace. Any capture already in progress
+ * is restarted. Zones already open when it begins are left out.
+ */
+OAPI void profiler_capture_begin();
+
+/**
+ * @brief Stops recording and writes the captured zones to path in the Chrome
+ * trace event format, viewable in chrome://tracing or Perfetto.
+ * @returns False if no capture was in progress or the file couldn't be
+ * written.
+ */
+OAPI b8 profiler_capture_end(const char *path);
+
+OAPI b8 profiler_is_capturing();
+
+#if OPROFILE_ENABLED == 1
+// Opens a profiling zone. Must be paired with OPROFILE_ZONE_END.
+#define OPROFILE_ZONE_BEGIN(name) profiler_zone_begin(name)
+// Closes the most recently opened profiling zone.
+#define OPROFILE_ZONE_END() profiler_zone_end()
+#else
+// Does nothing when OPROFILE_ENABLED != 1
+#define OPROFILE_ZONE_BEGIN(name)
+// Does nothing when OPROFILE_ENABLED != 1
+#define OPROFILE_ZONE_END()
+#endif
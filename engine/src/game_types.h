@@ -2,6 +2,8 @@
 
 #include "core/application.h"
 
+struct render_packet;
+
 typedef struct game {
 
   // Application config
@@ -13,8 +15,9 @@ typedef struct game {
   // Function pointer to game's update/loop
   b8 (*update)(struct game *game_inst, f32 delta_time);
 
-  // Function pointer to game's render pass
-  b8 (*render)(struct game *game_inst, f32 delta_time);
+  // Function pointer to game's render pass. Fills the packet's draw list
+  b8 (*render)(struct game *game_inst, f32 delta_time,
+               struct render_packet *packet);
 
   // Function pointer to handle resize, if applicable
   void (*on_resize)(struct game *game_inst, u32 width, u32 height);
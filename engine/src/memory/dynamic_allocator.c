@@ -0,0 +1,410 @@
+#include "dynamic_allocator.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+// Sizes below SMALL_BLOCK_SIZE share first level 0, split linearly.
+#define FL_SHIFT 9
+#define SMALL_BLOCK_SIZE (1ull << FL_SHIFT)
+// Each first level class is split into 1 << SL_LOG2 second level classes.
+#define SL_LOG2 5
+#define SL_COUNT (1u << SL_LOG2)
+// Blocks must be smaller than 1 << FL_MAX bytes.
+#define FL_MAX 40
+#define FL_COUNT (FL_MAX - FL_SHIFT + 1)
+
+#define BLOCK_FREE_BIT 1ull
+
+/**
+ * @brief Header in front of every block. prev_phys and size are always
+ * present; the free list links overlap the payload, so are only valid while
+ * the block is free.
+ */
+typedef struct block_header {
+  // The block physically before this one, or 0 for the first block.
+  struct block_header *prev_phys;
+  // Payload size in bytes; the low bit is set while the block is free.
+  u64 size;
+  struct block_header *next_free;
+  struct block_header *prev_free;
+} block_header;
+
+#define BLOCK_OVERHEAD (sizeof(block_header *) + sizeof(u64))
+#define BLOCK_MIN_SIZE (sizeof(block_header) - BLOCK_OVERHEAD)
+
+typedef struct dynamic_allocator_state {
+  u64 total_size;
+  u64 free_space;
+  u32 free_block_count;
+  u32 fl_bitmap;
+  u32 sl_bitmap[FL_COUNT];
+  block_header *blocks[FL_COUNT][SL_COUNT];
+  u8 *arena_start;
+  u8 *arena_end;
+} dynamic_allocator_state;
+
+// Index of the highest set bit. value must not be 0.
+OINLINE u32 bit_scan_reverse(u64 value) {
+  return 63 - __builtin_clzll(value);
+}
+
+// Index of the lowest set bit. value must not be 0.
+OINLINE u32 bit_scan_forward(u32 value) {
+  return __builtin_ctz(value);
+}
+
+OINLINE u64 align_up(u64 value, u64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+OINLINE u64 block_size(const block_header *block) {
+  return block->size & ~BLOCK_FREE_BIT;
+}
+
+OINLINE b8 block_is_free(const block_header *block) {
+  return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+OINLINE void *block_to_ptr(block_header *block) {
+  return (u8 *)block + BLOCK_OVERHEAD;
+}
+
+OINLINE block_header *block_from_ptr(const void *ptr) {
+  return (block_header *)((u8 *)ptr - BLOCK_OVERHEAD);
+}
+
+OINLINE block_header *block_next(block_header *block) {
+  return (block_header *)((u8 *)block_to_ptr(block) + block_size(block));
+}
+
+/** @brief The bin a free block of size belongs in. */
+static void mapping_insert(u64 size, u32 *fl, u32 *sl) {
+  if (size < SMALL_BLOCK_SIZE) {
+    *fl = 0;
+    *sl = (u32)(size / (SMALL_BLOCK_SIZE / SL_COUNT));
+  } else {
+    u32 high_bit = bit_scan_reverse(size);
+    *sl = (u32)(size >> (high_bit - SL_LOG2)) ^ SL_COUNT;
+    *fl = high_bit - (FL_SHIFT - 1);
+  }
+}
+
+/**
+ * @brief The first bin whose blocks are all at least size bytes. Rounding up
+ * to the next class means any block found fits without walking the list.
+ */
+static void mapping_search(u64 size, u32 *fl, u32 *sl) {
+  if (size >= SMALL_BLOCK_SIZE) {
+    size += (1ull << (bit_scan_reverse(size) - SL_LOG2)) - 1;
+  }
+  mapping_insert(size, fl, sl);
+}
+
+static block_header *find_suitable_block(dynamic_allocator_state *state,
+                                         u32 *fl, u32 *sl) {
+  if (*fl >= FL_COUNT) {
+    return 0;
+  }
+  u32 sl_map = state->sl_bitmap[*fl] & (~0u << *sl);
+  if (!sl_map) {
+    // Nothing left in this class; move to the next non-empty one.
+    u32 fl_map = *fl + 1 < 32 ? state->fl_bitmap & (~0u << (*fl + 1)) : 0;
+    if (!fl_map) {
+      return 0;
+    }
+    *fl = bit_scan_forward(fl_map);
+    sl_map = state->sl_bitmap[*fl];
+  }
+  *sl = bit_scan_forward(sl_map);
+  return state->blocks[*fl][*sl];
+}
+
+static void insert_free_block(dynamic_allocator_state *state,
+                              block_header *block) {
+  u32 fl, sl;
+  u64 size = block_size(block);
+  mapping_insert(size, &fl, &sl);
+
+  block->size = size | BLOCK_FREE_BIT;
+  block->prev_free = 0;
+  block->next_free = state->blocks[fl][sl];
+  if (block->next_free) {
+    block->next_free->prev_free = block;
+  }
+  state->blocks[fl][sl] = block;
+  state->fl_bitmap |= 1u << fl;
+  state->sl_bitmap[fl] |= 1u << sl;
+  state->free_space += size;
+  state->free_block_count++;
+}
+
+static void remove_free_block(dynamic_allocator_state *state,
+                              block_header *block) {
+  u32 fl, sl;
+  u64 size = block_size(block);
+  mapping_insert(size, &fl, &sl);
+
+  if (block->prev_free) {
+    block->prev_free->next_free = block->next_free;
+  } else {
+    state->blocks[fl][sl] = block->next_free;
+    if (!block->next_free) {
+      state->sl_bitmap[fl] &= ~(1u << sl);
+      if (!state->sl_bitmap[fl]) {
+        state->fl_bitmap &= ~(1u << fl);
+      }
+    }
+  }
+  if (block->next_free) {
+    block->next_free->prev_free = block->prev_free;
+  }
+  block->size = size;
+  state->free_space -= size;
+  state->free_block_count--;
+}
+
+b8 dynamic_allocator_create(u64 total_size, u64 *memory_requirement,
+                            void *memory, dynamic_allocator *out_allocator) {
+  // Room for the first block and the end sentinel's headers.
+  u64 min_size = BLOCK_OVERHEAD * 2 + BLOCK_MIN_SIZE;
+  if (total_size < min_size) {
+    OERROR("dynamic_allocator_create - total_size must be at least %llu.",
+           min_size);
+    return false;
+  }
+  if (!memory_requirement) {
+    OERROR("dynamic_allocator_create requires memory_requirement to be "
+           "non-null.");
+    return false;
+  }
+
+  // Extra room to align the start of the arena.
+  *memory_requirement = sizeof(dynamic_allocator_state) + total_size +
+                        DYNAMIC_ALLOCATOR_ALIGNMENT;
+  if (!memory) {
+    return true;
+  }
+
+  out_allocator->memory = memory;
+  dynamic_allocator_state *state = memory;
+  ozero_memory(state, sizeof(dynamic_allocator_state));
+
+  u8 *arena = (u8 *)memory + sizeof(dynamic_allocator_state);
+  state->arena_start =
+      (u8 *)align_up((u64)arena, DYNAMIC_ALLOCATOR_ALIGNMENT);
+  state->arena_end =
+      state->arena_start + (total_size & ~(DYNAMIC_ALLOCATOR_ALIGNMENT - 1));
+
+  // One free block covering the arena, followed by a zero-sized used
+  // sentinel so the last real block always has a next neighbour.
+  block_header *first = (block_header *)state->arena_start;
+  first->prev_phys = 0;
+  first->size =
+      (u64)(state->arena_end - state->arena_start) - BLOCK_OVERHEAD * 2;
+  state->total_size = first->size;
+
+  block_header *sentinel = block_next(first);
+  sentinel->prev_phys = first;
+  sentinel->size = 0;
+
+  insert_free_block(state, first);
+  return true;
+}
+
+b8 dynamic_allocator_destroy(dynamic_allocator *allocator) {
+  if (allocator) {
+    allocator->memory = 0;
+    return true;
+  }
+  OWARN("dynamic_allocator_destroy requires a pointer to an allocator.");
+  return false;
+}
+
+/**
+ * @brief Finds a free block of at least size bytes, or 0 if there isn't one.
+ */
+static block_header *locate_free_block(dynamic_allocator_state *state,
+                                       u64 size) {
+  if (size > state->total_size) {
+    return 0;
+  }
+  u32 fl, sl;
+  mapping_search(size, &fl, &sl);
+  block_header *block = find_suitable_block(state, &fl, &sl);
+  if (!block) {
+    // Nearly out of memory: a block in size's own class may still fit, it
+    // just isn't guaranteed to. Only this slow path walks a list.
+    mapping_insert(size, &fl, &sl);
+    for (block = state->blocks[fl][sl]; block; block = block->next_free) {
+      if (block_size(block) >= size) {
+        break;
+      }
+    }
+  }
+  return block;
+}
+
+void *dynamic_allocator_allocate(dynamic_allocator *allocator, u64 size) {
+  return dynamic_allocator_allocate_aligned(allocator, size,
+                                            DYNAMIC_ALLOCATOR_ALIGNMENT);
+}
+
+void *dynamic_allocator_allocate_aligned(dynamic_allocator *allocator,
+                                         u64 size, u64 alignment) {
+  if (!allocator || !allocator->memory) {
+    OERROR("dynamic_allocator_allocate - provided allocator not "
+           "initialized.");
+    return 0;
+  }
+  if (alignment == 0 || (alignment & (alignment - 1))) {
+    OERROR("dynamic_allocator_allocate - alignment %llu is not a power of "
+           "two.",
+           alignment);
+    return 0;
+  }
+  dynamic_allocator_state *state = allocator->memory;
+
+  u64 adjusted = align_up(size, DYNAMIC_ALLOCATOR_ALIGNMENT);
+  if (adjusted < BLOCK_MIN_SIZE) {
+    adjusted = BLOCK_MIN_SIZE;
+  }
+
+  // Blocks are always DYNAMIC_ALLOCATOR_ALIGNMENT aligned. Stricter
+  // alignments need room to move the start of the block forward, with the
+  // skipped gap big enough to be returned as a free block of its own.
+  u64 gap_room = 0;
+  if (alignment > DYNAMIC_ALLOCATOR_ALIGNMENT) {
+    gap_room = alignment + BLOCK_OVERHEAD + BLOCK_MIN_SIZE;
+  }
+
+  block_header *block = locate_free_block(state, adjusted + gap_room);
+  if (!block) {
+    dynamic_allocator_stats stats;
+    dynamic_allocator_get_stats(allocator, &stats);
+    OERROR("dynamic_allocator_allocate - no block large enough for %lluB "
+           "(alignment %llu). Free: %lluB, largest free block: %lluB.",
+           size, alignment, stats.free_space, stats.largest_free_block);
+    return 0;
+  }
+  remove_free_block(state, block);
+
+  if (gap_room) {
+    u8 *payload = block_to_ptr(block);
+    u8 *aligned = (u8 *)align_up((u64)payload, alignment);
+    u64 gap = (u64)(aligned - payload);
+    if (gap && gap < BLOCK_OVERHEAD + BLOCK_MIN_SIZE) {
+      aligned = (u8 *)align_up((u64)payload + BLOCK_OVERHEAD + BLOCK_MIN_SIZE,
+                               alignment);
+      gap = (u64)(aligned - payload);
+    }
+    if (gap) {
+      // The block now starts at the aligned address, so frees need no
+      // knowledge of the alignment.
+      block_header *aligned_block = block_from_ptr(aligned);
+      aligned_block->prev_phys = block;
+      aligned_block->size = block_size(block) - gap;
+      block_next(aligned_block)->prev_phys = aligned_block;
+      block->size = gap - BLOCK_OVERHEAD;
+      insert_free_block(state, block);
+      block = aligned_block;
+    }
+  }
+
+  // Give back whatever is left over if it can hold a block of its own.
+  u64 remaining = block_size(block) - adjusted;
+  if (remaining >= BLOCK_OVERHEAD + BLOCK_MIN_SIZE) {
+    block->size = adjusted;
+    block_header *rest = block_next(block);
+    rest->prev_phys = block;
+    rest->size = remaining - BLOCK_OVERHEAD;
+    block_next(rest)->prev_phys = rest;
+    insert_free_block(state, rest);
+  }
+
+  return block_to_ptr(block);
+}
+
+b8 dynamic_allocator_free(dynamic_allocator *allocator, void *block) {
+  if (!allocator || !allocator->memory || !block) {
+    OERROR("dynamic_allocator_free requires a valid allocator and block.");
+    return false;
+  }
+  if (!dynamic_allocator_owns(allocator, block)) {
+    OERROR("dynamic_allocator_free - block %p is not owned by this "
+           "allocator.",
+           block);
+    return false;
+  }
+  dynamic_allocator_state *state = allocator->memory;
+
+  block_header *header = block_from_ptr(block);
+  if (block_is_free(header)) {
+    OERROR("dynamic_allocator_free - block %p was already freed.", block);
+    return false;
+  }
+  // Marked before merging so a header absorbed into its free neighbour still
+  // reads as freed.
+  header->size |= BLOCK_FREE_BIT;
+
+  block_header *prev = header->prev_phys;
+  if (prev && block_is_free(prev)) {
+    remove_free_block(state, prev);
+    prev->size += BLOCK_OVERHEAD + block_size(header);
+    header = prev;
+    block_next(header)->prev_phys = header;
+  }
+
+  block_header *next = block_next(header);
+  if (block_is_free(next)) {
+    remove_free_block(state, next);
+    header->size += BLOCK_OVERHEAD + block_size(next);
+    block_next(header)->prev_phys = header;
+  }
+
+  insert_free_block(state, header);
+  return true;
+}
+
+b8 dynamic_allocator_owns(dynamic_allocator *allocator, const void *block) {
+  if (!allocator || !allocator->memory) {
+    return false;
+  }
+  dynamic_allocator_state *state = allocator->memory;
+  return (const u8 *)block >= state->arena_start + BLOCK_OVERHEAD &&
+         (const u8 *)block < state->arena_end;
+}
+
+u64 dynamic_allocator_free_space(dynamic_allocator *allocator) {
+  dynamic_allocator_state *state = allocator->memory;
+  return state->free_space;
+}
+
+void dynamic_allocator_get_stats(dynamic_allocator *allocator,
+                                 dynamic_allocator_stats *out_stats) {
+  ozero_memory(out_stats, sizeof(dynamic_allocator_stats));
+  if (!allocator || !allocator->memory) {
+    return;
+  }
+  dynamic_allocator_state *state = allocator->memory;
+  out_stats->total_size = state->total_size;
+  out_stats->free_space = state->free_space;
+  out_stats->free_block_count = state->free_block_count;
+
+  // The largest block is in the highest non-empty bin; only that bin's list
+  // needs walking.
+  if (state->fl_bitmap) {
+    u32 fl = bit_scan_reverse(state->fl_bitmap);
+    u32 sl = bit_scan_reverse(state->sl_bitmap[fl]);
+    for (block_header *block = state->blocks[fl][sl]; block;
+         block = block->next_free) {
+      if (block_size(block) > out_stats->largest_free_block) {
+        out_stats->largest_free_block = block_size(block);
+      }
+    }
+  }
+
+  if (state->free_space) {
+    out_stats->fragmentation =
+        1.0f - ((f32)out_stats->largest_free_block / (f32)state->free_space);
+  }
+}
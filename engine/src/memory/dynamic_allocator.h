@@ -0,0 +1,87 @@
+#pragma once
+
+#include "defines.h"
+
+/** @brief Alignment, in bytes, of every block handed out. */
+#define DYNAMIC_ALLOCATOR_ALIGNMENT 16
+
+/**
+ * @brief A general-purpose allocator over a single fixed block of memory,
+ * using two-level segregated fit (TLSF). Free blocks are binned by size into
+ * power-of-two classes, each split linearly into sub-classes, with a bitmap
+ * per level. Allocating and freeing are O(1): finding a fitting bin is a pair
+ * of bit scans, and freed blocks are merged with free neighbours immediately.
+ *
+ * Every block carries a 16 byte header, and sizes are rounded up to
+ * DYNAMIC_ALLOCATOR_ALIGNMENT.
+ *
+ * Not thread-safe: callers sharing one allocator across threads must
+ * serialize every call but dynamic_allocator_owns. The memory system does so
+ * for the engine arena.
+ */
+typedef struct dynamic_allocator {
+  void *memory;
+} dynamic_allocator;
+
+typedef struct dynamic_allocator_stats {
+  /** @brief Usable size of the arena in bytes. */
+  u64 total_size;
+  /** @brief Bytes available across every free block. */
+  u64 free_space;
+  /** @brief The largest allocation that can currently succeed. */
+  u64 largest_free_block;
+  u32 free_block_count;
+  /**
+   * @brief 0 when all free space is in one block, approaching 1 as free space
+   * is scattered across many small blocks.
+   */
+  f32 fragmentation;
+} dynamic_allocator_stats;
+
+/**
+ * @brief Creates a new dynamic allocator. Call twice; once with memory = 0 to
+ * get the required memory size, then a second time passing allocated memory.
+ *
+ * @param total_size The size of the arena to be managed.
+ * @param memory_requirement A pointer to hold the required memory size,
+ * including internal state.
+ * @param memory 0 if just requesting memory requirement, otherwise allocated
+ * block of memory.
+ * @param out_allocator The allocator to be initialized.
+ * @return b8 True on success; otherwise false.
+ */
+OAPI b8 dynamic_allocator_create(u64 total_size, u64 *memory_requirement,
+                                 void *memory,
+                                 dynamic_allocator *out_allocator);
+OAPI b8 dynamic_allocator_destroy(dynamic_allocator *allocator);
+
+/**
+ * @brief Allocates a block of at least size bytes. The memory is not zeroed.
+ * @returns The block, or 0 if no free block is large enough.
+ */
+OAPI void *dynamic_allocator_allocate(dynamic_allocator *allocator, u64 size);
+
+/**
+ * @brief Allocates a block of at least size bytes starting at a multiple of
+ * alignment. The block is freed with dynamic_allocator_free like any other.
+ * @param alignment A power of two.
+ * @returns The block, or 0 if no free block is large enough.
+ */
+OAPI void *dynamic_allocator_allocate_aligned(dynamic_allocator *allocator,
+                                              u64 size, u64 alignment);
+
+/**
+ * @brief Returns a block to the allocator, merging it with any free physical
+ * neighbours.
+ * @returns False if the block isn't from this allocator or is already free.
+ */
+OAPI b8 dynamic_allocator_free(dynamic_allocator *allocator, void *block);
+
+/** @brief Whether block lies within this allocator's arena. */
+OAPI b8 dynamic_allocator_owns(dynamic_allocator *allocator,
+                               const void *block);
+
+OAPI u64 dynamic_allocator_free_space(dynamic_allocator *allocator);
+
+OAPI void dynamic_allocator_get_stats(dynamic_allocator *allocator,
+                                      dynamic_allocator_stats *out_stats);
@@ -0,0 +1,36 @@
+#include "frame_allocator.h"
+
+#include "core/omemory.h"
+
+void frame_allocator_create(u64 frame_size, void *memory,
+                            frame_allocator *out_allocator) {
+  if (!out_allocator) {
+    return;
+  }
+  ozero_memory(out_allocator, sizeof(frame_allocator));
+  if (memory) {
+    stack_allocator_create(frame_size, memory, &out_allocator->frames[0]);
+    stack_allocator_create(frame_size, (u8 *)memory + frame_size,
+                           &out_allocator->frames[1]);
+  } else {
+    stack_allocator_create(frame_size, 0, &out_allocator->frames[0]);
+    stack_allocator_create(frame_size, 0, &out_allocator->frames[1]);
+  }
+}
+
+void frame_allocator_destroy(frame_allocator *allocator) {
+  if (allocator) {
+    stack_allocator_destroy(&allocator->frames[0]);
+    stack_allocator_destroy(&allocator->frames[1]);
+    allocator->current = 0;
+  }
+}
+
+stack_allocator *frame_allocator_current(frame_allocator *allocator) {
+  return &allocator->frames[allocator->current];
+}
+
+void frame_allocator_swap(frame_allocator *allocator) {
+  allocator->current ^= 1;
+  stack_allocator_free_all(&allocator->frames[allocator->current]);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "memory/stack_allocator.h"
+
+/**
+ * @brief Per-frame scratch memory, double-buffered. Each frame allocates from
+ * its own stack, and frame_allocator_swap at the end of a frame switches to
+ * the other stack and resets it. Allocations therefore stay valid through the
+ * following frame, so data produced one frame can be consumed the next.
+ *
+ * Not thread-safe; frame memory belongs to the main thread.
+ */
+typedef struct frame_allocator {
+  stack_allocator frames[2];
+  u32 current;
+} frame_allocator;
+
+/**
+ * @brief Creates a frame allocator with frame_size bytes per frame.
+ * @param memory A block of 2 * frame_size bytes, or 0 to allocate one.
+ */
+OAPI void frame_allocator_create(u64 frame_size, void *memory,
+                                 frame_allocator *out_allocator);
+OAPI void frame_allocator_destroy(frame_allocator *allocator);
+
+/** @brief The stack allocations for the current frame come from. */
+OAPI stack_allocator *frame_allocator_current(frame_allocator *allocator);
+
+/**
+ * @brief Ends the frame: switches to the other stack and frees everything in
+ * it, which was allocated two frames ago. Memory is not cleared.
+ */
+OAPI void frame_allocator_swap(frame_allocator *allocator);
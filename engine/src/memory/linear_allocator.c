@@ -2,6 +2,29 @@
 
 #include "core/logger.h"
 #include "core/omemory.h"
+#include "platform/platform.h"
+
+OINLINE u64 commit_granularity(const linear_allocator *allocator) {
+  return allocator->huge_pages ? PLATFORM_HUGE_PAGE_SIZE
+                               : LINEAR_ALLOCATOR_COMMIT_SIZE;
+}
+
+/** @brief Commits enough of the reservation to cover the first size bytes. */
+static b8 commit_to(linear_allocator *allocator, u64 size) {
+  u64 granularity = commit_granularity(allocator);
+  u64 target = (size + granularity - 1) & ~(granularity - 1);
+  if (target > allocator->total_size) {
+    target = allocator->total_size;
+  }
+  if (!platform_commit_memory((u8 *)allocator->memory + allocator->committed,
+                              target - allocator->committed, true)) {
+    OERROR("linear_allocator - failed to commit %lluB of reserved memory.",
+           target - allocator->committed);
+    return false;
+  }
+  allocator->committed = target;
+  return true;
+}
 
 void linear_allocator_create(u64 total_size, void *memory,
                              linear_allocator *out_allocator) {
@@ -9,6 +32,9 @@ void linear_allocator_create(u64 total_size, void *memory,
     out_allocator->total_size = total_size;
     out_allocator->allocated = 0;
     out_allocator->owns_memory = memory == 0;
+    out_allocator->reserved = false;
+    out_allocator->huge_pages = false;
+    out_allocator->committed = 0;
     if (memory) {
       out_allocator->memory = memory;
     } else {
@@ -17,31 +43,80 @@ void linear_allocator_create(u64 total_size, void *memory,
     }
   }
 }
+b8 linear_allocator_create_reserved(u64 total_size, b8 huge_pages,
+                                    linear_allocator *out_allocator) {
+  if (!out_allocator || total_size == 0) {
+    OERROR("linear_allocator_create_reserved requires an allocator and a "
+           "non-zero size.");
+    return false;
+  }
+  ozero_memory(out_allocator, sizeof(linear_allocator));
+  out_allocator->huge_pages = huge_pages;
+  u64 granularity = commit_granularity(out_allocator);
+  total_size = (total_size + granularity - 1) & ~(granularity - 1);
+
+  void *memory = platform_reserve_memory(total_size, huge_pages);
+  if (!memory) {
+    OERROR("linear_allocator_create_reserved - failed to reserve %lluB.",
+           total_size);
+    return false;
+  }
+  out_allocator->total_size = total_size;
+  out_allocator->memory = memory;
+  out_allocator->owns_memory = true;
+  out_allocator->reserved = true;
+  return true;
+}
+
 void linear_allocator_destroy(linear_allocator *allocator) {
   if (allocator) {
     allocator->allocated = 0;
-    if (allocator->owns_memory && allocator->memory) {
+    if (allocator->reserved && allocator->memory) {
+      platform_release_memory(allocator->memory, allocator->total_size);
+    } else if (allocator->owns_memory && allocator->memory) {
       ofree(allocator->memory, allocator->total_size,
             MEMORY_TAG_LINEAR_ALLOCATOR);
     }
     allocator->memory = 0;
     allocator->total_size = 0;
     allocator->owns_memory = false;
+    allocator->reserved = false;
+    allocator->committed = 0;
   }
 }
 
 void *linear_allocator_allocate(linear_allocator *allocator, u64 size) {
+  return linear_allocator_allocate_aligned(allocator, size, 1);
+}
+
+void *linear_allocator_allocate_aligned(linear_allocator *allocator, u64 size,
+                                        u16 alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1))) {
+    OERROR("linear_allocator_allocate - alignment %hu is not a power of two.",
+           alignment);
+    return 0;
+  }
   if (allocator && allocator->memory) {
-    if (allocator->allocated + size > allocator->total_size) {
+    // Align the address rather than the offset, the memory itself may not be
+    // aligned.
+    u64 head = (u64)allocator->memory + allocator->allocated;
+    u64 padding = ((head + alignment - 1) & ~(u64)(alignment - 1)) - head;
+    if (allocator->allocated + padding + size > allocator->total_size) {
       u64 remaining = allocator->total_size - allocator->allocated;
       OERROR("linear_allocator_allocate - Tried to allocate %lluB, only %lluB "
              "remaining.",
-             size, remaining);
+             size + padding, remaining);
+      return 0;
+    }
+
+    u64 end = allocator->allocated + padding + size;
+    if (allocator->reserved && end > allocator->committed &&
+        !commit_to(allocator, end)) {
       return 0;
     }
 
-    void *block = ((u8 *)allocator->memory) + allocator->allocated;
-    allocator->allocated += size;
+    void *block = ((u8 *)allocator->memory) + allocator->allocated + padding;
+    allocator->allocated = end;
     return block;
   }
 
@@ -52,6 +127,15 @@ void *linear_allocator_allocate(linear_allocator *allocator, u64 size) {
 void linear_allocator_free_all(linear_allocator *allocator) {
   if (allocator && allocator->memory) {
     allocator->allocated = 0;
-    ozero_memory(allocator->memory, allocator->total_size);
+    // Uncommitted pages of a reservation already read as zero.
+    u64 size =
+        allocator->reserved ? allocator->committed : allocator->total_size;
+    ozero_memory(allocator->memory, size);
+  }
+}
+
+void linear_allocator_reset(linear_allocator *allocator) {
+  if (allocator) {
+    allocator->allocated = 0;
   }
 }
\ No newline at end of file
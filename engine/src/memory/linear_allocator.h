@@ -2,16 +2,54 @@
 
 #include "defines.h"
 
+// Granularity reserved allocators commit memory in, unless using huge pages.
+#define LINEAR_ALLOCATOR_COMMIT_SIZE (64 * 1024)
+
 typedef struct linear_allocator {
   u64 total_size;
   u64 allocated;
   void *memory;
   b8 owns_memory;
+  /** @brief Whether memory is a reservation committed as the head advances. */
+  b8 reserved;
+  b8 huge_pages;
+  /** @brief Bytes of a reservation backed by memory so far. */
+  u64 committed;
 } linear_allocator;
 
 OAPI void linear_allocator_create(u64 total_size, void *memory,
                                   linear_allocator *out_allocator);
+
+/**
+ * @brief Creates an allocator over reserved address space instead of an
+ * oallocate block. Pages are committed and prefaulted in chunks as the head
+ * reaches them, so nothing is paged in or zeroed up front. The memory comes
+ * straight from the platform and isn't counted under any memory tag.
+ * @param total_size The most the allocator can hand out; rounded up to the
+ * commit granularity.
+ * @param huge_pages Whether to ask for huge pages, committing in
+ * PLATFORM_HUGE_PAGE_SIZE chunks.
+ * @returns False if the address space couldn't be reserved.
+ */
+OAPI b8 linear_allocator_create_reserved(u64 total_size, b8 huge_pages,
+                                         linear_allocator *out_allocator);
 OAPI void linear_allocator_destroy(linear_allocator *allocator);
 
 OAPI void *linear_allocator_allocate(linear_allocator *allocator, u64 size);
-OAPI void linear_allocator_free_all(linear_allocator *allocator);
\ No newline at end of file
+
+/**
+ * @brief Allocates size bytes starting at a multiple of alignment. Any padding
+ * needed to reach the alignment counts towards allocated.
+ * @param alignment A power of two.
+ */
+OAPI void *linear_allocator_allocate_aligned(linear_allocator *allocator,
+                                             u64 size, u16 alignment);
+/** @brief Frees every allocation and zeroes the backing memory. */
+OAPI void linear_allocator_free_all(linear_allocator *allocator);
+
+/**
+ * @brief Frees every allocation without touching the backing memory, so new
+ * allocations hold whatever was there before. Constant time regardless of
+ * size.
+ */
+OAPI void linear_allocator_reset(linear_allocator *allocator);
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "pool_allocator.h"
+
+#include "core/logger.h"
+
+/**
+ * @brief Header at the start of every chunk, padded so the slots after it
+ * keep the chunk's alignment.
+ */
+typedef struct pool_chunk {
+  struct pool_chunk *next;
+  u64 padding;
+} pool_chunk;
+
+OINLINE u64 chunk_size(pool_allocator *allocator) {
+  return sizeof(pool_chunk) + allocator->slot_size * allocator->slots_per_chunk;
+}
+
+OINLINE u8 *chunk_slots(pool_chunk *chunk) {
+  return (u8 *)chunk + sizeof(pool_chunk);
+}
+
+/** @brief Poisons a free slot, leaving its free list link intact. */
+static void poison_slot(pool_allocator *allocator, u8 *slot) {
+  oset_memory(slot + sizeof(void *), POOL_ALLOCATOR_POISON_BYTE,
+              allocator->slot_size - sizeof(void *));
+}
+
+/** @brief Whether a free slot's poison is untouched. */
+static b8 slot_poison_intact(pool_allocator *allocator, const u8 *slot) {
+  for (u64 i = sizeof(void *); i < allocator->slot_size; ++i) {
+    if (slot[i] != POOL_ALLOCATOR_POISON_BYTE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @brief Whether slot is on the free list. Walks the whole list. */
+static b8 slot_is_free(pool_allocator *allocator, const void *slot) {
+  for (void *free_slot = allocator->free_list; free_slot;
+       free_slot = *(void **)free_slot) {
+    if (free_slot == slot) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Allocates a chunk and pushes all of its slots onto the free list. */
+static b8 add_chunk(pool_allocator *allocator) {
+  pool_chunk *chunk = oallocate_uninit(chunk_size(allocator), allocator->tag);
+  if (!chunk) {
+    return false;
+  }
+  chunk->next = allocator->chunks;
+  allocator->chunks = chunk;
+  allocator->chunk_count++;
+
+  // Push in reverse so slots are handed out in address order.
+  u8 *slots = chunk_slots(chunk);
+  for (u32 i = allocator->slots_per_chunk; i > 0; --i) {
+    u8 *slot = slots + (i - 1) * allocator->slot_size;
+    *(void **)slot = allocator->free_list;
+    allocator->free_list = slot;
+    if (allocator->poison_freed) {
+      poison_slot(allocator, slot);
+    }
+  }
+  return true;
+}
+
+b8 pool_allocator_create(u64 element_size, u32 slots_per_chunk, b8 can_grow,
+                         memory_tag tag, b8 poison_freed,
+                         pool_allocator *out_allocator) {
+  if (!out_allocator || element_size == 0 || slots_per_chunk == 0) {
+    OERROR("pool_allocator_create requires an allocator and a non-zero "
+           "element size and slot count.");
+    return false;
+  }
+  ozero_memory(out_allocator, sizeof(pool_allocator));
+
+  // Every slot must be able to hold the free list link.
+  u64 pointer_size = sizeof(void *);
+  out_allocator->slot_size =
+      (element_size + pointer_size - 1) & ~(pointer_size - 1);
+  out_allocator->slots_per_chunk = slots_per_chunk;
+  out_allocator->tag = tag;
+  out_allocator->can_grow = can_grow;
+  out_allocator->poison_freed = poison_freed;
+
+  if (!add_chunk(out_allocator)) {
+    OERROR("pool_allocator_create - failed to allocate the first chunk.");
+    return false;
+  }
+  return true;
+}
+
+void pool_allocator_destroy(pool_allocator *allocator) {
+  if (!allocator) {
+    return;
+  }
+  u64 size = chunk_size(allocator);
+  pool_chunk *chunk = allocator->chunks;
+  while (chunk) {
+    pool_chunk *next = chunk->next;
+    ofree(chunk, size, allocator->tag);
+    chunk = next;
+  }
+  ozero_memory(allocator, sizeof(pool_allocator));
+}
+
+void *pool_allocator_allocate(pool_allocator *allocator) {
+  if (!allocator->free_list) {
+    if (!allocator->can_grow) {
+      OERROR("pool_allocator_allocate - pool of %u slots is full.",
+             allocator->slots_per_chunk * allocator->chunk_count);
+      return 0;
+    }
+    if (!add_chunk(allocator)) {
+      OERROR("pool_allocator_allocate - failed to grow the pool.");
+      return 0;
+    }
+  }
+
+  u8 *slot = allocator->free_list;
+  if (allocator->poison_freed && !slot_poison_intact(allocator, slot)) {
+    OERROR("pool_allocator_allocate - slot %p was written to after being "
+           "freed.",
+           slot);
+  }
+  allocator->free_list = *(void **)slot;
+  allocator->allocated_count++;
+  ozero_memory(slot, allocator->slot_size);
+  return slot;
+}
+
+b8 pool_allocator_free(pool_allocator *allocator, void *block) {
+  if (!block) {
+    return false;
+  }
+  if (allocator->poison_freed) {
+    if (!pool_allocator_owns(allocator, block)) {
+      OERROR("pool_allocator_free - block %p is not a slot of this pool.",
+             block);
+      return false;
+    }
+    // Intact poison means the slot is probably free already; the free list
+    // walk confirms it, so a live slot that happens to hold the poison byte
+    // isn't rejected. Pointer-sized slots have no room for poison.
+    b8 may_be_free = allocator->slot_size == sizeof(void *) ||
+                     slot_poison_intact(allocator, block);
+    if (may_be_free && slot_is_free(allocator, block)) {
+      OERROR("pool_allocator_free - slot %p was freed twice.", block);
+      return false;
+    }
+    poison_slot(allocator, block);
+  }
+  *(void **)block = allocator->free_list;
+  allocator->free_list = block;
+  allocator->allocated_count--;
+  return true;
+}
+
+b8 pool_allocator_owns(pool_allocator *allocator, const void *block) {
+  u64 slots_size = allocator->slot_size * allocator->slots_per_chunk;
+  for (pool_chunk *chunk = allocator->chunks; chunk; chunk = chunk->next) {
+    const u8 *slots = chunk_slots(chunk);
+    if ((const u8 *)block >= slots && (const u8 *)block < slots + slots_size) {
+      // Must point at the start of a slot, not into one.
+      return ((const u8 *)block - slots) % allocator->slot_size == 0;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "core/omemory.h"
+#include "defines.h"
+
+/** @brief Byte written over freed slots while poisoning. */
+#define POOL_ALLOCATOR_POISON_BYTE 0xDD
+
+/**
+ * @brief Hands out fixed-size slots from chunks of memory. Free slots form an
+ * intrusive singly linked list through the slots themselves, so allocating
+ * and freeing are a pointer pop or push.
+ *
+ * Poisoning is an opt-in debugging mode chosen at creation. Freed slots are
+ * filled with POOL_ALLOCATOR_POISON_BYTE and checked when handed out again,
+ * catching writes through dangling pointers. Frees are also validated against
+ * the pool's chunks, and a slot that is already free is rejected rather than
+ * handed out twice. Those checks walk the chunk and free lists, so frees are
+ * no longer O(1) while poisoning. It can be turned off after creation, but
+ * not on, as existing free slots wouldn't be poisoned.
+ */
+typedef struct pool_allocator {
+  /** @brief Size of each slot; element_size rounded up to pointer size. */
+  u64 slot_size;
+  u32 slots_per_chunk;
+  u32 chunk_count;
+  /** @brief Number of slots currently handed out. */
+  u32 allocated_count;
+  memory_tag tag;
+  b8 can_grow;
+  b8 poison_freed;
+  /** @brief Head of the free slot list. */
+  void *free_list;
+  /** @brief Most recently added chunk; each chunk links to the previous. */
+  void *chunks;
+} pool_allocator;
+
+/**
+ * @brief Creates a pool and allocates its first chunk.
+ * @param element_size The size of each element in bytes.
+ * @param slots_per_chunk How many elements each chunk holds.
+ * @param can_grow If true, a new chunk is added when the pool is full;
+ * otherwise allocation fails.
+ * @param tag The tag chunks are allocated under.
+ * @param poison_freed If true, freed slots are poisoned and frees validated.
+ * @param out_allocator The pool to be initialized.
+ * @returns True on success.
+ */
+OAPI b8 pool_allocator_create(u64 element_size, u32 slots_per_chunk,
+                              b8 can_grow, memory_tag tag, b8 poison_freed,
+                              pool_allocator *out_allocator);
+
+/** @brief Frees every chunk. Outstanding slots become invalid. */
+OAPI void pool_allocator_destroy(pool_allocator *allocator);
+
+/**
+ * @brief Takes a zeroed slot from the pool.
+ * @returns The slot, or 0 if the pool is full and can't grow.
+ */
+OAPI void *pool_allocator_allocate(pool_allocator *allocator);
+
+/**
+ * @brief Returns a slot to the pool.
+ * @returns False if poisoning is on and block isn't a slot of this pool or
+ * is already free.
+ */
+OAPI b8 pool_allocator_free(pool_allocator *allocator, void *block);
+
+/** @brief Whether block is a slot of this pool. Walks the chunk list. */
+OAPI b8 pool_allocator_owns(pool_allocator *allocator, const void *block);
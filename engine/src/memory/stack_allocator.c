@@ -0,0 +1,84 @@
+#include "stack_allocator.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+void stack_allocator_create(u64 total_size, void *memory,
+                            stack_allocator *out_allocator) {
+  if (out_allocator) {
+    out_allocator->total_size = total_size;
+    out_allocator->allocated = 0;
+    out_allocator->owns_memory = memory == 0;
+    if (memory) {
+      out_allocator->memory = memory;
+    } else {
+      out_allocator->memory =
+          oallocate_uninit(total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+  }
+}
+
+void stack_allocator_destroy(stack_allocator *allocator) {
+  if (allocator) {
+    if (allocator->owns_memory && allocator->memory) {
+      ofree(allocator->memory, allocator->total_size,
+            MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+    allocator->memory = 0;
+    allocator->total_size = 0;
+    allocator->allocated = 0;
+    allocator->owns_memory = false;
+  }
+}
+
+void *stack_allocator_allocate(stack_allocator *allocator, u64 size) {
+  return stack_allocator_allocate_aligned(allocator, size, 1);
+}
+
+void *stack_allocator_allocate_aligned(stack_allocator *allocator, u64 size,
+                                       u16 alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1))) {
+    OERROR("stack_allocator_allocate - alignment %hu is not a power of two.",
+           alignment);
+    return 0;
+  }
+  if (allocator && allocator->memory) {
+    u64 head = (u64)allocator->memory + allocator->allocated;
+    u64 padding = ((head + alignment - 1) & ~(u64)(alignment - 1)) - head;
+    if (allocator->allocated + padding + size > allocator->total_size) {
+      u64 remaining = allocator->total_size - allocator->allocated;
+      OERROR("stack_allocator_allocate - Tried to allocate %lluB, only %lluB "
+             "remaining.",
+             size + padding, remaining);
+      return 0;
+    }
+
+    void *block = ((u8 *)allocator->memory) + allocator->allocated + padding;
+    allocator->allocated += padding + size;
+    return block;
+  }
+
+  OERROR("stack_allocator_allocate - provided allocator not initialized.");
+  return 0;
+}
+
+stack_allocator_marker stack_allocator_get_marker(stack_allocator *allocator) {
+  return allocator->allocated;
+}
+
+void stack_allocator_free_to_marker(stack_allocator *allocator,
+                                    stack_allocator_marker marker) {
+  if (marker > allocator->allocated) {
+    OERROR("stack_allocator_free_to_marker - marker %llu is above the top of "
+           "the stack (%llu); it was taken before an earlier rollback.",
+           marker, allocator->allocated);
+    return;
+  }
+  allocator->allocated = marker;
+}
+
+void stack_allocator_free_all(stack_allocator *allocator) {
+  if (allocator) {
+    allocator->allocated = 0;
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief A linear allocator that can also be rolled back to an earlier point.
+ * Take a marker before making scoped temporary allocations, then free back to
+ * it once they are no longer needed; everything allocated after the marker is
+ * released at once. Freeing never clears memory.
+ */
+typedef struct stack_allocator {
+  u64 total_size;
+  u64 allocated;
+  void *memory;
+  b8 owns_memory;
+} stack_allocator;
+
+/** @brief A point in a stack allocator to free back to. */
+typedef u64 stack_allocator_marker;
+
+/**
+ * @brief Creates a stack allocator over memory, or allocates total_size bytes
+ * for it if memory is 0.
+ */
+OAPI void stack_allocator_create(u64 total_size, void *memory,
+                                 stack_allocator *out_allocator);
+OAPI void stack_allocator_destroy(stack_allocator *allocator);
+
+/** @brief Allocates size bytes from the top of the stack. Not zeroed. */
+OAPI void *stack_allocator_allocate(stack_allocator *allocator, u64 size);
+
+/**
+ * @brief Allocates size bytes starting at a multiple of alignment. Not zeroed.
+ * @param alignment A power of two.
+ */
+OAPI void *stack_allocator_allocate_aligned(stack_allocator *allocator,
+                                            u64 size, u16 alignment);
+
+/** @brief Gets the current top of the stack. */
+OAPI stack_allocator_marker
+stack_allocator_get_marker(stack_allocator *allocator);
+
+/**
+ * @brief Frees everything allocated since marker was taken. Markers taken
+ * after it become invalid.
+ */
+OAPI void stack_allocator_free_to_marker(stack_allocator *allocator,
+                                         stack_allocator_marker marker);
+
+/** @brief Frees every allocation. */
+OAPI void stack_allocator_free_all(stack_allocator *allocator);
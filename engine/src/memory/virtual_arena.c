@@ -0,0 +1,65 @@
+#include "virtual_arena.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+#include "platform/platform.h"
+
+OINLINE u64 round_to_page(u64 size) {
+  u64 page_size = platform_get_page_size();
+  return (size + page_size - 1) & ~(page_size - 1);
+}
+
+b8 virtual_arena_create(u64 reserve_size, virtual_arena *out_arena) {
+  if (!out_arena || reserve_size == 0) {
+    OERROR("virtual_arena_create requires an arena and a non-zero size.");
+    return false;
+  }
+  ozero_memory(out_arena, sizeof(virtual_arena));
+  reserve_size = round_to_page(reserve_size);
+  void *memory = platform_reserve_memory(reserve_size, false);
+  if (!memory) {
+    OERROR("virtual_arena_create - failed to reserve %lluB.", reserve_size);
+    return false;
+  }
+  out_arena->memory = memory;
+  out_arena->reserved_size = reserve_size;
+  return true;
+}
+
+void virtual_arena_destroy(virtual_arena *arena) {
+  if (arena && arena->memory) {
+    platform_release_memory(arena->memory, arena->reserved_size);
+    ozero_memory(arena, sizeof(virtual_arena));
+  }
+}
+
+b8 virtual_arena_commit(virtual_arena *arena, u64 size) {
+  if (size <= arena->committed_size) {
+    return true;
+  }
+  if (size > arena->reserved_size) {
+    OERROR("virtual_arena_commit - %lluB exceeds the %lluB reservation.", size,
+           arena->reserved_size);
+    return false;
+  }
+
+  u64 target = round_to_page(size);
+  if (!platform_commit_memory((u8 *)arena->memory + arena->committed_size,
+                              target - arena->committed_size, false)) {
+    OERROR("virtual_arena_commit - failed to commit %lluB.",
+           target - arena->committed_size);
+    return false;
+  }
+  arena->committed_size = target;
+  return true;
+}
+
+void virtual_arena_decommit(virtual_arena *arena, u64 size) {
+  u64 keep = round_to_page(size);
+  if (keep >= arena->committed_size) {
+    return;
+  }
+  platform_decommit_memory((u8 *)arena->memory + keep,
+                           arena->committed_size - keep);
+  arena->committed_size = keep;
+}
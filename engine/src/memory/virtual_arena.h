@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief A contiguous range of reserved address space, backed by memory only
+ * as far as it has been committed. Growing commits more pages in place, so
+ * the base address never changes and pointers into the arena stay valid, and
+ * nothing is copied. Committed pages read as zero until written.
+ *
+ * The memory comes straight from the platform and isn't counted under any
+ * memory tag.
+ */
+typedef struct virtual_arena {
+  void *memory;
+  /** @brief Size of the reservation; the most the arena can grow to. */
+  u64 reserved_size;
+  /** @brief Bytes from the start of the arena backed by memory. */
+  u64 committed_size;
+} virtual_arena;
+
+/**
+ * @brief Reserves address space for an arena without committing any of it.
+ * @param reserve_size The most the arena can hold; rounded up to the page
+ * size.
+ * @returns False if the address space couldn't be reserved.
+ */
+OAPI b8 virtual_arena_create(u64 reserve_size, virtual_arena *out_arena);
+
+/** @brief Releases the whole reservation. */
+OAPI void virtual_arena_destroy(virtual_arena *arena);
+
+/**
+ * @brief Ensures the first size bytes of the arena are committed, rounding up
+ * to the page size.
+ * @returns False if size exceeds the reservation or the commit failed.
+ */
+OAPI b8 virtual_arena_commit(virtual_arena *arena, u64 size);
+
+/**
+ * @brief Returns pages wholly past the first size bytes to the OS. They read
+ * as zero if committed again.
+ */
+OAPI void virtual_arena_decommit(virtual_arena *arena, u64 size);
@@ -102,7 +102,7 @@ OAPI b8 filesystem_read_all_bytes(file_handle *handle, u8 **out_bytes,
     u64 size = ftell((FILE *)handle->handle);
     rewind((FILE *)handle->handle);
 
-    *out_bytes = oallocate(sizeof(u8) * size, MEMORY_TAG_STRING);
+    *out_bytes = oallocate_uninit(sizeof(u8) * size, MEMORY_TAG_STRING);
     *out_bytes_read = fread(*out_bytes, 1, size, (FILE *)handle->handle);
     if (*out_bytes_read != size) {
       return false;
@@ -13,10 +13,41 @@ void platform_shutdown(platform_state *plat_state);
 
 b8 platform_pump_messages(platform_state *plat_state);
 
+// Alignment of blocks from platform_allocate with aligned = true; a cache
+// line.
+#define PLATFORM_ALLOCATION_ALIGNMENT 64
+
+// If aligned, the block starts at a multiple of PLATFORM_ALLOCATION_ALIGNMENT
+// and must be freed with aligned = true.
 void *platform_allocate(u64 size, b8 aligned);
 void platform_free(void *block, b8 aligned);
+// Allocates a block starting at a multiple of alignment, which must be a power
+// of two. Free with platform_free_aligned.
+void *platform_allocate_aligned(u64 size, u64 alignment);
+void platform_free_aligned(void *block);
+// Virtual memory. Reserving claims address space only; committing backs part
+// of a reservation with memory that reads as zero until written. Addresses and
+// sizes passed to commit and decommit must be multiples of the page size.
+#define PLATFORM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+u64 platform_get_page_size();
+// If huge_pages, the reservation is aligned to PLATFORM_HUGE_PAGE_SIZE and
+// hinted to be backed by huge pages where the OS supports it, cutting TLB
+// misses on large arenas. size is rounded up to the page size.
+void *platform_reserve_memory(u64 size, b8 huge_pages);
+// If prefault, every page is faulted in now rather than on first touch.
+b8 platform_commit_memory(void *address, u64 size, b8 prefault);
+// Returns committed pages to the OS; the range stays reserved.
+void platform_decommit_memory(void *address, u64 size);
+// Releases a whole reservation. size must match the one reserved.
+void platform_release_memory(void *address, u64 size);
+
+// Fills frames with up to max return addresses of the calling thread, innermost
+// first. Returns how many were captured; 0 where unsupported.
+u32 platform_capture_backtrace(void **frames, u32 max);
 void *platform_zero_memory(void *block, u64 size);
 void *platform_copy_memory(void *dest, const void *source, u64 size);
+// Like platform_copy_memory, but dest and source may overlap.
+void *platform_move_memory(void *dest, const void *source, u64 size);
 void *platform_set_memory(void *dest, i32 value, u64 size);
 
 void platform_console_write(const char *message, u8 colour);
@@ -24,6 +55,30 @@ void platform_console_write_error(const char *message, u8 colour);
 
 f64 platform_get_absolute_time();
 
+// Entry point of a thread started with platform_thread_create.
+typedef void (*platform_thread_start)(void *arg);
+
+typedef struct platform_thread {
+  void *internal_data;
+} platform_thread;
+
+// Starts a thread running start(arg). Must be joined with
+// platform_thread_join.
+b8 platform_thread_create(platform_thread_start start, void *arg,
+                          platform_thread *out_thread);
+// Waits for the thread to finish and releases it.
+void platform_thread_join(platform_thread *thread);
+
+typedef struct platform_mutex {
+  void *internal_data;
+} platform_mutex;
+
+// Creates a non-recursive mutex.
+b8 platform_mutex_create(platform_mutex *out_mutex);
+void platform_mutex_destroy(platform_mutex *mutex);
+void platform_mutex_lock(platform_mutex *mutex);
+void platform_mutex_unlock(platform_mutex *mutex);
+
 // Sleep on the thread for the provided ms. This blocks the main thread.
 // Should only be used for giving time back to the OS for unused update power.
 // Therefore it is not exported.
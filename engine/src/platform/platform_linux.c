@@ -13,13 +13,15 @@
 #include <X11/Xlib-xcb.h> // sudo apt-get install libxkbcommon-x11-dev
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
+#include <execinfo.h> // backtrace
+#include <pthread.h>
+#include <sys/mman.h> // mmap
 #include <sys/time.h>
+#include <unistd.h> // sysconf, usleep
 #include <xcb/xcb.h>
 
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h> // nanosleep
-#else
-#include <unistd.h> // usleep
 #endif
 
 #include <stdio.h>
@@ -248,14 +250,106 @@ b8 platform_pump_messages(platform_state *plat_state) {
   return !quit_flagged;
 }
 
-void *platform_allocate(u64 size, b8 aligned) { return malloc(size); }
-void platform_free(void *block, b8 aligned) { free(block); }
+void *platform_allocate(u64 size, b8 aligned) {
+  if (aligned) {
+    return platform_allocate_aligned(size, PLATFORM_ALLOCATION_ALIGNMENT);
+  }
+  return malloc(size);
+}
+void platform_free(void *block, b8 aligned) {
+  if (aligned) {
+    platform_free_aligned(block);
+  } else {
+    free(block);
+  }
+}
+void *platform_allocate_aligned(u64 size, u64 alignment) {
+  // posix_memalign requires at least pointer alignment.
+  if (alignment < sizeof(void *)) {
+    alignment = sizeof(void *);
+  }
+  void *block = 0;
+  if (posix_memalign(&block, alignment, size) != 0) {
+    return 0;
+  }
+  return block;
+}
+void platform_free_aligned(void *block) { free(block); }
+u64 platform_get_page_size() {
+  static u64 page_size = 0;
+  if (!page_size) {
+    page_size = (u64)sysconf(_SC_PAGESIZE);
+  }
+  return page_size;
+}
+void *platform_reserve_memory(u64 size, b8 huge_pages) {
+  u64 page_size = platform_get_page_size();
+  size = (size + page_size - 1) & ~(page_size - 1);
+  // Over-reserve so a huge page aligned range of size fits inside.
+  u64 padding = huge_pages ? PLATFORM_HUGE_PAGE_SIZE : 0;
+  u8 *base = mmap(0, size + padding, PROT_NONE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    return 0;
+  }
+  if (!huge_pages) {
+    return base;
+  }
+
+  // Transparent huge pages only back aligned 2 MiB ranges; trim the ends.
+  u64 mask = PLATFORM_HUGE_PAGE_SIZE - 1;
+  u8 *aligned = (u8 *)(((u64)base + mask) & ~mask);
+  u64 head = aligned - base;
+  if (head) {
+    munmap(base, head);
+  }
+  if (padding - head) {
+    munmap(aligned + size, padding - head);
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+  return aligned;
+}
+b8 platform_commit_memory(void *address, u64 size, b8 prefault) {
+  if (mprotect(address, size, PROT_READ | PROT_WRITE) != 0) {
+    return false;
+  }
+  if (prefault) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(address, size, MADV_POPULATE_WRITE) == 0) {
+      return true;
+    }
+#endif
+    // Older kernels: touch a byte per page.
+    u64 page_size = platform_get_page_size();
+    for (u64 offset = 0; offset < size; offset += page_size) {
+      ((volatile u8 *)address)[offset] = 0;
+    }
+  }
+  return true;
+}
+void platform_decommit_memory(void *address, u64 size) {
+  madvise(address, size, MADV_DONTNEED);
+  mprotect(address, size, PROT_NONE);
+}
+void platform_release_memory(void *address, u64 size) {
+  u64 page_size = platform_get_page_size();
+  munmap(address, (size + page_size - 1) & ~(page_size - 1));
+}
+u32 platform_capture_backtrace(void **frames, u32 max) {
+  i32 count = backtrace(frames, (i32)max);
+  return count > 0 ? (u32)count : 0;
+}
 void *platform_zero_memory(void *block, u64 size) {
   return memset(block, 0, size);
 }
 void *platform_copy_memory(void *dest, const void *source, u64 size) {
   return memcpy(dest, source, size);
 }
+void *platform_move_memory(void *dest, const void *source, u64 size) {
+  return memmove(dest, source, size);
+}
 void *platform_set_memory(void *dest, i32 value, u64 size) {
   return memset(dest, value, size);
 }
@@ -279,6 +373,72 @@ f64 platform_get_absolute_time() {
   return now.tv_sec + now.tv_nsec * 0.000000001;
 }
 
+typedef struct linux_thread {
+  pthread_t handle;
+  platform_thread_start start;
+  void *arg;
+} linux_thread;
+
+static void *linux_thread_main(void *arg) {
+  linux_thread *thread = arg;
+  thread->start(thread->arg);
+  return 0;
+}
+
+b8 platform_thread_create(platform_thread_start start, void *arg,
+                          platform_thread *out_thread) {
+  linux_thread *thread = malloc(sizeof(linux_thread));
+  if (!thread) {
+    return false;
+  }
+  thread->start = start;
+  thread->arg = arg;
+  if (pthread_create(&thread->handle, 0, linux_thread_main, thread) != 0) {
+    free(thread);
+    return false;
+  }
+  out_thread->internal_data = thread;
+  return true;
+}
+
+void platform_thread_join(platform_thread *thread) {
+  linux_thread *state = thread->internal_data;
+  if (state) {
+    pthread_join(state->handle, 0);
+    free(state);
+    thread->internal_data = 0;
+  }
+}
+
+b8 platform_mutex_create(platform_mutex *out_mutex) {
+  pthread_mutex_t *mutex = malloc(sizeof(pthread_mutex_t));
+  if (!mutex) {
+    return false;
+  }
+  if (pthread_mutex_init(mutex, 0) != 0) {
+    free(mutex);
+    return false;
+  }
+  out_mutex->internal_data = mutex;
+  return true;
+}
+
+void platform_mutex_destroy(platform_mutex *mutex) {
+  if (mutex->internal_data) {
+    pthread_mutex_destroy(mutex->internal_data);
+    free(mutex->internal_data);
+    mutex->internal_data = 0;
+  }
+}
+
+void platform_mutex_lock(platform_mutex *mutex) {
+  pthread_mutex_lock(mutex->internal_data);
+}
+
+void platform_mutex_unlock(platform_mutex *mutex) {
+  pthread_mutex_unlock(mutex->internal_data);
+}
+
 void platform_sleep(u64 ms) {
 #if _POSIX_C_SOURCE >= 199309L
   struct timespec ts;
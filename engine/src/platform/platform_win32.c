@@ -8,6 +8,7 @@
 #include "core/input.h"
 #include "core/logger.h"
 
+#include <malloc.h> // _aligned_malloc
 #include <stdlib.h>
 #include <windows.h>
 #include <windowsx.h>
@@ -137,9 +138,60 @@ b8 platform_pump_messages(platform_state *plat_state) {
 }
 
 // malloc
-void *platform_allocate(u64 size, b8 aligned) { return (malloc(size)); }
+void *platform_allocate(u64 size, b8 aligned) {
+  if (aligned) {
+    return platform_allocate_aligned(size, PLATFORM_ALLOCATION_ALIGNMENT);
+  }
+  return (malloc(size));
+}
 // free
-void platform_free(void *block, b8 aligned) { return (free(block)); }
+void platform_free(void *block, b8 aligned) {
+  if (aligned) {
+    platform_free_aligned(block);
+  } else {
+    free(block);
+  }
+}
+// Aligned blocks must go back through _aligned_free, not free.
+void *platform_allocate_aligned(u64 size, u64 alignment) {
+  return _aligned_malloc(size, alignment);
+}
+void platform_free_aligned(void *block) { _aligned_free(block); }
+u64 platform_get_page_size() {
+  static u64 page_size = 0;
+  if (!page_size) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    page_size = info.dwPageSize;
+  }
+  return page_size;
+}
+// Large pages on Windows need SeLockMemoryPrivilege and must be committed up
+// front, so huge_pages is ignored here.
+void *platform_reserve_memory(u64 size, b8 huge_pages) {
+  return VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+b8 platform_commit_memory(void *address, u64 size, b8 prefault) {
+  if (!VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE)) {
+    return false;
+  }
+  if (prefault) {
+    u64 page_size = platform_get_page_size();
+    for (u64 offset = 0; offset < size; offset += page_size) {
+      ((volatile u8 *)address)[offset] = 0;
+    }
+  }
+  return true;
+}
+void platform_decommit_memory(void *address, u64 size) {
+  VirtualFree(address, size, MEM_DECOMMIT);
+}
+void platform_release_memory(void *address, u64 size) {
+  VirtualFree(address, 0, MEM_RELEASE);
+}
+u32 platform_capture_backtrace(void **frames, u32 max) {
+  return CaptureStackBackTrace(0, max, frames, 0);
+}
 // other operations we'll want to have
 void *platform_zero_memory(void *block, u64 size) {
   return memset(block, 0, size);
@@ -147,6 +199,9 @@ void *platform_zero_memory(void *block, u64 size) {
 void *platform_copy_memory(void *dest, const void *source, u64 size) {
   return memcpy(dest, source, size);
 }
+void *platform_move_memory(void *dest, const void *source, u64 size) {
+  return memmove(dest, source, size);
+}
 void *platform_set_memory(void *dest, i32 value, u64 size) {
   return memset(dest, value, size);
 }
@@ -182,6 +237,71 @@ f64 platform_get_absolute_time() {
   return (f64)now_time.QuadPart * clock_frequency;
 }
 
+typedef struct win32_thread {
+  HANDLE handle;
+  platform_thread_start start;
+  void *arg;
+} win32_thread;
+
+static DWORD WINAPI win32_thread_main(LPVOID arg) {
+  win32_thread *thread = arg;
+  thread->start(thread->arg);
+  return 0;
+}
+
+b8 platform_thread_create(platform_thread_start start, void *arg,
+                          platform_thread *out_thread) {
+  win32_thread *thread = malloc(sizeof(win32_thread));
+  if (!thread) {
+    return false;
+  }
+  thread->start = start;
+  thread->arg = arg;
+  thread->handle = CreateThread(0, 0, win32_thread_main, thread, 0, 0);
+  if (!thread->handle) {
+    free(thread);
+    return false;
+  }
+  out_thread->internal_data = thread;
+  return true;
+}
+
+void platform_thread_join(platform_thread *thread) {
+  win32_thread *state = thread->internal_data;
+  if (state) {
+    WaitForSingleObject(state->handle, INFINITE);
+    CloseHandle(state->handle);
+    free(state);
+    thread->internal_data = 0;
+  }
+}
+
+b8 platform_mutex_create(platform_mutex *out_mutex) {
+  CRITICAL_SECTION *section = malloc(sizeof(CRITICAL_SECTION));
+  if (!section) {
+    return false;
+  }
+  InitializeCriticalSection(section);
+  out_mutex->internal_data = section;
+  return true;
+}
+
+void platform_mutex_destroy(platform_mutex *mutex) {
+  if (mutex->internal_data) {
+    DeleteCriticalSection(mutex->internal_data);
+    free(mutex->internal_data);
+    mutex->internal_data = 0;
+  }
+}
+
+void platform_mutex_lock(platform_mutex *mutex) {
+  EnterCriticalSection(mutex->internal_data);
+}
+
+void platform_mutex_unlock(platform_mutex *mutex) {
+  LeaveCriticalSection(mutex->internal_data);
+}
+
 // Blocks main thread, only used for giving time back to the OS.
 // Not exported
 void platform_sleep(u64 ms) { Sleep(ms); }
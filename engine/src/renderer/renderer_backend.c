@@ -13,7 +13,13 @@ b8 renderer_backend_create(renderer_backend_type type,
     out_renderer_backend->begin_frame = vulkan_renderer_backend_begin_frame;
     out_renderer_backend->update_global_state =
         vulkan_renderer_backend_update_global_state;
-    out_renderer_backend->draw_object = vulkan_renderer_draw_object;
+    out_renderer_backend->create_geometry = vulkan_renderer_create_geometry;
+    out_renderer_backend->destroy_geometry = vulkan_renderer_destroy_geometry;
+    out_renderer_backend->draw_instanced = vulkan_renderer_draw_instanced;
+    out_renderer_backend->create_texture = vulkan_renderer_create_texture;
+    out_renderer_backend->destroy_texture = vulkan_renderer_destroy_texture;
+    out_renderer_backend->get_gpu_frame_time =
+        vulkan_renderer_get_gpu_frame_time;
     out_renderer_backend->end_frame = vulkan_renderer_backend_end_frame;
     out_renderer_backend->resized = vulkan_renderer_backend_on_resized;
 
@@ -27,6 +33,12 @@ void renderer_backend_destroy(renderer_backend *renderer_backend) {
   renderer_backend->shutdown = 0;
   renderer_backend->begin_frame = 0;
   renderer_backend->update_global_state = 0;
+  renderer_backend->create_geometry = 0;
+  renderer_backend->destroy_geometry = 0;
+  renderer_backend->draw_instanced = 0;
+  renderer_backend->create_texture = 0;
+  renderer_backend->destroy_texture = 0;
+  renderer_backend->get_gpu_frame_time = 0;
   renderer_backend->end_frame = 0;
   renderer_backend->resized = 0;
 }
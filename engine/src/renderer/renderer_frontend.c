@@ -2,32 +2,53 @@
 
 #include "renderer_backend.h"
 
-#include "containers/darray.h"
+#include "containers/handle_table.h"
+#include "core/application.h"
 #include "core/logger.h"
 #include "core/omemory.h"
+#include "core/profiler.h"
 #include "math/omath.h"
+#include "memory/stack_allocator.h"
+#include "resources/resource_types.h"
+
+#include <stdlib.h>
 
 // Backend render context
 static renderer_backend *backend = 0;
 
 /**
- * @brief Current scene data. Later this will be a proper scene graph that can
- * handle multiple transformation dependency chains. For now, we just want to
- * hold everything in the scene to draw
+ * @brief Current scene data, render_objects by handle. Later this will be a
+ * proper scene graph that can handle multiple transformation dependency
+ * chains. For now, we just want to hold everything in the scene to draw
  */
-static render_object *scene_data = 0;
+static handle_table objects;
+
+/** @brief Loaded meshes, render_meshes by handle. */
+static handle_table meshes;
+
+/** @brief Created textures, textures by handle. */
+static handle_table textures;
 
 /**
- * @brief Mesh data stored as array of pointers since meshes can vary in range.
+ * @brief Built-in test quad. Uploaded to the backend once on initialization
+ * and drawn as a regular scene object.
  */
-static vertex_3d **mesh_data = 0;
+static u32 default_mesh_id = INVALID_ID;
+
+/** @brief GPU time of the most recently completed frame, in milliseconds. */
+static f64 last_gpu_frame_time = 0;
+
+static void destroy_mesh(render_mesh *mesh);
+static i32 compare_draw_items(const void *a, const void *b);
+static b8 draw_batched(render_packet *packet);
 
 b8 renderer_initialize(const char *application_name,
                        struct platform_state *plat_state) {
   backend = oallocate(sizeof(renderer_backend), MEMORY_TAG_RENDERER);
   // initialize scene data
-  scene_data = darray_create(render_object *);
-  mesh_data = darray_create(vertex_3d *);
+  handle_table_create(sizeof(render_object), 64, &objects);
+  handle_table_create(sizeof(render_mesh), 32, &meshes);
+  handle_table_create(sizeof(texture), 32, &textures);
 
   // TODO: Make configurable
   renderer_backend_create(RENDERER_BACKEND_TYPE_VULKAN, plat_state, backend);
@@ -38,10 +59,65 @@ b8 renderer_initialize(const char *application_name,
     return false;
   }
 
+  // TODO: REMOVE TEMP CODE
+  // Built in frame scratch memory; renderer_load_mesh takes a copy.
+  stack_allocator *scratch = application_get_frame_allocator();
+  stack_allocator_marker scratch_marker = stack_allocator_get_marker(scratch);
+  const f32 f = 0.5f;
+  const u32 vert_count = 4;
+  vertex_3d *verts =
+      stack_allocator_allocate(scratch, sizeof(vertex_3d) * vert_count);
+  ozero_memory(verts, sizeof(vertex_3d) * vert_count);
+
+  verts[0].position.x = -0.5 * f;
+  verts[0].position.y = -0.5 * f;
+  verts[0].tex_coord.u = 0.0;
+  verts[0].tex_coord.v = 0.0;
+
+  verts[1].position.x = 0.5 * f;
+  verts[1].position.y = 0.5 * f;
+  verts[1].tex_coord.u = 1.0;
+  verts[1].tex_coord.v = 1.0;
+
+  verts[2].position.x = -0.5 * f;
+  verts[2].position.y = 0.5 * f;
+  verts[2].tex_coord.u = 0.0;
+  verts[2].tex_coord.v = 1.0;
+
+  verts[3].position.x = 0.5 * f;
+  verts[3].position.y = -0.5 * f;
+  verts[3].tex_coord.u = 1.0;
+  verts[3].tex_coord.v = 0.0;
+
+  const u32 index_count = 6;
+  u32 indices[6] = {0, 1, 2, 0, 3, 1};
+  default_mesh_id = renderer_load_mesh(verts, vert_count, indices,
+                                       index_count);
+  stack_allocator_free_to_marker(scratch, scratch_marker);
+  if (default_mesh_id == INVALID_ID) {
+    OERROR("Failed to upload the default geometry.");
+    return false;
+  }
+  renderer_register_object(default_mesh_id, INVALID_ID, mat4_identity());
+
   return true;
 }
 
 void renderer_shutdown() {
+  // Release everything still loaded, including the default quad.
+  render_mesh *mesh_data = meshes.elements;
+  for (u32 i = 0; i < meshes.count; ++i) {
+    destroy_mesh(&mesh_data[i]);
+  }
+  texture *texture_data = textures.elements;
+  for (u32 i = 0; i < textures.count; ++i) {
+    backend->destroy_texture(backend, &texture_data[i]);
+  }
+  default_mesh_id = INVALID_ID;
+  handle_table_destroy(&objects);
+  handle_table_destroy(&meshes);
+  handle_table_destroy(&textures);
+
   backend->shutdown(backend);
   ofree(backend, sizeof(renderer_backend), MEMORY_TAG_RENDERER);
 }
@@ -72,12 +148,17 @@ void renderer_on_resized(u16 width, u16 height) {
 /**
  * @brief Renders the frame using the given render packet.
  * Presently, this performs some small amount of view transformation
- * @param packet The render packet of data. Right now this only contains delta
- * time
+ * @param packet The render packet of data. Its draw list is drawn along with
+ * every registered object.
  */
 b8 renderer_draw_frame(render_packet *packet) {
+  // Includes waiting on the GPU for a free frame slot
+  OPROFILE_ZONE_BEGIN("Begin Frame");
+  b8 frame_began = renderer_begin_frame(packet->delta_time);
+  OPROFILE_ZONE_END();
+
   // If the begin frame was successful, continue mid frame ops
-  if (renderer_begin_frame(packet->delta_time)) {
+  if (frame_began) {
 
     mat4 projection =
         mat4_perspective(deg_to_rad(45.0f), 1280 / 720.0f, 0.1f, 1000.0f);
@@ -87,46 +168,23 @@ b8 renderer_draw_frame(render_packet *packet) {
     view = mat4_inverse(view);
     backend->update_global_state(projection, view, vec3_zero(), vec4_one(), 0);
 
-    const f32 f = 0.5f;
-
-    // TODO: REMOVE TEMP CODE
-    const u32 vert_count = 4;
-    vertex_3d verts[vert_count];
-    ozero_memory(verts, sizeof(vertex_3d) * vert_count);
-
-    verts[0].position.x = -0.5 * f;
-    verts[0].position.y = -0.5 * f;
-    verts[0].tex_coord.u = 0.0;
-    verts[0].tex_coord.v = 0.0;
-
-    verts[1].position.x = 0.5 * f;
-    verts[1].position.y = 0.5 * f;
-    verts[1].tex_coord.u = 1.0;
-    verts[1].tex_coord.v = 1.0;
-
-    verts[2].position.x = -0.5 * f;
-    verts[2].position.y = 0.5 * f;
-    verts[2].tex_coord.u = 0.0;
-    verts[2].tex_coord.v = 1.0;
-
-    verts[3].position.x = 0.5 * f;
-    verts[3].position.y = -0.5 * f;
-    verts[3].tex_coord.u = 1.0;
-    verts[3].tex_coord.v = 0.0;
-
-    const u32 index_count = 6;
-    u32 indices[6] = {0, 1, 2, 0, 3, 1};
-    vertex_data vd;
-    vd.index_count = index_count;
-    vd.indices = indices;
-    vd.vertices = verts;
-    vd.vertex_count = vert_count;
-    backend->draw_object(backend, &vd);
-    // for item in scene{
-    //  renderer_draw_object(item)
-    //}
+    // One instanced draw per unique geometry/texture pair
+    OPROFILE_ZONE_BEGIN("Draw Batches");
+    if (!draw_batched(packet)) {
+      OERROR("Failed to draw scene batches.");
+    }
+    OPROFILE_ZONE_END();
 
+    OPROFILE_ZONE_BEGIN("End Frame");
     b8 result = renderer_end_frame(packet->delta_time);
+    OPROFILE_ZONE_END();
+
+    f64 submit_time = 0;
+    f64 gpu_frame_time = 0;
+    if (backend->get_gpu_frame_time(backend, &submit_time, &gpu_frame_time)) {
+      last_gpu_frame_time = gpu_frame_time;
+      profiler_report_gpu_frame(submit_time, gpu_frame_time);
+    }
 
     // If end frame had issue, likely unrecoverable. shutdown
     if (!result) {
@@ -139,46 +197,316 @@ b8 renderer_draw_frame(render_packet *packet) {
   return true;
 }
 
+/**
+ * @brief Gets the GPU execution time of the most recently completed frame, in
+ * milliseconds. Trails the current frame by the number of frames in flight.
+ * Returns 0 if GPU timing isn't supported.
+ */
+f64 renderer_get_gpu_frame_time() { return last_gpu_frame_time; }
+
 /**
  * @brief Creates a new object to be rendered
- * @param gemoetry_data_id - geometry data id to reference when drawing
- * @param texture_data_id - texture data id to reference when drawing
+ * @param mesh_id - mesh handle to reference when drawing
+ * @param texture_id - texture handle, or INVALID_ID. Only used to batch draws
+ * for now; everything is drawn with the default texture
+ * @param model - world transform of the object
+ * @returns The object's handle, or INVALID_ID on failure.
  */
-u32 renderer_register_object(u32 geometry_data_id, u32 texture_data_id) {
-  // Declaring static to increment between calls for multiple objects.
-  // This may be bad code. If it is we'll address it later, but it should work
-  // for now
-  static u32 object_id = 0;
+u32 renderer_register_object(u32 mesh_id, u32 texture_id, mat4 model) {
+  if (!handle_table_is_valid(&meshes, mesh_id)) {
+    OERROR("renderer_register_object called with invalid mesh handle: %u",
+           mesh_id);
+    return INVALID_ID;
+  }
 
   render_object nro; // new render object
-  // TODO: Check for valid mesh geo data at given ID index
-  nro.geometry_data_id = geometry_data_id;
-  nro.texture_data_id = texture_data_id;
-  nro.id = object_id;
+  nro.mesh_id = mesh_id;
+  nro.texture_id = texture_id;
+  nro.model = model;
 
   // REGISTER THE OBJECT NOW
-  darray_push(scene_data, nro);
-  // TODO TEMP AS HELL
-  ODEBUG("Vertex 0 X value: %f", mesh_data[0][0].position.x);
-  ODEBUG("Vertex 0 Y value: %f", mesh_data[0][0].position.y);
-  ODEBUG("Vertex 1 X value: %f", mesh_data[0][1].position.x);
-  ODEBUG("Vertex 1 Y value: %f", mesh_data[0][1].position.y);
-  ODEBUG("Vertex 2 X value: %f", mesh_data[0][2].position.x);
-  ODEBUG("Vertex 2 Y value: %f", mesh_data[0][2].position.y);
-  ODEBUG("Vertex 3 X value: %f", mesh_data[0][3].position.x);
-  ODEBUG("Vertex 3 Y value: %f", mesh_data[0][3].position.y);
-  return object_id++; // Post incrememnt to return 'current' value, then
-                      // incrememnt static var for next call
+  u32 handle = handle_table_insert(&objects, &nro);
+  if (handle != INVALID_ID) {
+    render_object *object = handle_table_get(&objects, handle);
+    object->id = handle;
+  }
+  return handle;
+}
+
+/**
+ * @brief Removes an object from the scene. Its handle becomes invalid.
+ */
+b8 renderer_unregister_object(u32 object_id) {
+  if (!handle_table_remove(&objects, object_id, 0)) {
+    OWARN("renderer_unregister_object called with invalid handle: %u",
+          object_id);
+    return false;
+  }
+  return true;
+}
+
+b8 renderer_set_object_transform(u32 object_id, mat4 model) {
+  render_object *object = handle_table_get(&objects, object_id);
+  if (!object) {
+    OWARN("renderer_set_object_transform called with invalid handle: %u",
+          object_id);
+    return false;
+  }
+  object->model = model;
+  return true;
+}
+
+/**
+ * @brief Copies a given mesh into renderer-owned storage and uploads it to the
+ * backend once, returning the handle to be referenced when registering an
+ * object. The caller's vertex/index data is not referenced after this returns.
+ * @returns The mesh handle, or INVALID_ID if the upload failed.
+ */
+u32 renderer_load_mesh(vertex_3d *vertices, u32 vertex_count, u32 *indices,
+                       u32 index_count) {
+  if (!vertices || vertex_count == 0) {
+    OERROR("renderer_load_mesh requires vertex data.");
+    return INVALID_ID;
+  }
+  if (!indices) {
+    index_count = 0;
+  }
+
+  render_mesh mesh;
+  mesh.vertex_count = vertex_count;
+  mesh.index_count = index_count;
+  u64 vertex_size = sizeof(vertex_3d) * vertex_count;
+  u64 index_size = sizeof(u32) * index_count;
+  mesh.vertices =
+      oallocate_uninit(vertex_size + index_size, MEMORY_TAG_RENDERER);
+  mesh.indices = index_count ? (u32 *)((u8 *)mesh.vertices + vertex_size) : 0;
+  ocopy_memory(mesh.vertices, vertices, vertex_size);
+  if (index_count) {
+    ocopy_memory(mesh.indices, indices, index_size);
+  }
+
+  vertex_data vd;
+  vd.vertices = mesh.vertices;
+  vd.vertex_count = mesh.vertex_count;
+  vd.indices = mesh.indices;
+  vd.index_count = mesh.index_count;
+  mesh.geometry_id = INVALID_ID;
+  if (!backend->create_geometry(backend, &vd, &mesh.geometry_id)) {
+    OERROR("renderer_load_mesh - failed to upload mesh to the backend.");
+    ofree(mesh.vertices, vertex_size + index_size, MEMORY_TAG_RENDERER);
+    return INVALID_ID;
+  }
+
+  u32 handle = handle_table_insert(&meshes, &mesh);
+  if (handle == INVALID_ID) {
+    destroy_mesh(&mesh);
+  }
+  return handle;
+}
+
+/**
+ * @brief Releases a mesh's geometry and data. Objects still referencing it
+ * are skipped when drawing.
+ */
+b8 renderer_unload_mesh(u32 mesh_id) {
+  render_mesh mesh;
+  if (!handle_table_remove(&meshes, mesh_id, &mesh)) {
+    OWARN("renderer_unload_mesh called with invalid handle: %u", mesh_id);
+    return false;
+  }
+  destroy_mesh(&mesh);
+  return true;
 }
 
 /**
- * @brief loads a given mesh into the renderer, returns back an ID to be
- * referenced in registering an object Since ID's are generated via sequential
- * integer counts, we can get away with an array to store them. Our current
- * darray supports pop_at indexes, so this should suffice for a while.
+ * @brief Creates a texture from the given pixel data, which is not referenced
+ * after this returns.
+ * @returns The texture handle, or INVALID_ID on failure.
  */
-u32 renderer_load_mesh(vertex_3d *new_mesh_data, u32 vertex_count) {
-  static u32 mesh_id = 0;
-  darray_push(mesh_data, new_mesh_data);
-  return mesh_id++;
-}
\ No newline at end of file
+u32 renderer_create_texture(u32 width, u32 height, u8 channel_count,
+                            const u8 *pixels) {
+  texture t;
+  ozero_memory(&t, sizeof(texture));
+  t.width = width;
+  t.height = height;
+  t.channel_count = channel_count;
+  if (!backend->create_texture(backend, pixels, &t)) {
+    OERROR("renderer_create_texture - backend failed to create texture.");
+    return INVALID_ID;
+  }
+
+  u32 handle = handle_table_insert(&textures, &t);
+  if (handle == INVALID_ID) {
+    backend->destroy_texture(backend, &t);
+    return INVALID_ID;
+  }
+  texture *created = handle_table_get(&textures, handle);
+  created->id = handle;
+  created->generation = HANDLE_GENERATION(handle);
+  return handle;
+}
+
+b8 renderer_destroy_texture(u32 texture_id) {
+  texture t;
+  if (!handle_table_remove(&textures, texture_id, &t)) {
+    OWARN("renderer_destroy_texture called with invalid handle: %u",
+          texture_id);
+    return false;
+  }
+  backend->destroy_texture(backend, &t);
+  return true;
+}
+
+/**
+ * @brief Appends count draw items to the packet's draw list, allocated from
+ * the packet's frame allocator. The list stays contiguous; if something else
+ * has been allocated since the last append it is moved to the allocator head.
+ * @returns A pointer to the first of the new items, to be filled in by the
+ * caller, or 0 if the frame allocator is out of space.
+ */
+render_draw_item *render_packet_add_draws(render_packet *packet, u32 count) {
+  if (!packet || !packet->frame_allocator || count == 0) {
+    return 0;
+  }
+
+  stack_allocator *allocator = packet->frame_allocator;
+  u8 *allocator_head = (u8 *)allocator->memory + allocator->allocated;
+  u8 *list_end = (u8 *)(packet->draw_items + packet->draw_item_count);
+  if (packet->draw_items && list_end == allocator_head) {
+    // Nothing allocated since, just extend in place.
+    if (!stack_allocator_allocate(allocator,
+                                  sizeof(render_draw_item) * count)) {
+      return 0;
+    }
+  } else {
+    u32 new_count = packet->draw_item_count + count;
+    render_draw_item *items = stack_allocator_allocate(
+        allocator, sizeof(render_draw_item) * new_count);
+    if (!items) {
+      return 0;
+    }
+    if (packet->draw_item_count) {
+      ocopy_memory(items, packet->draw_items,
+                   sizeof(render_draw_item) * packet->draw_item_count);
+    }
+    packet->draw_items = items;
+  }
+
+  render_draw_item *first = packet->draw_items + packet->draw_item_count;
+  packet->draw_item_count += count;
+  return first;
+}
+
+b8 render_packet_push_draw(render_packet *packet, u32 mesh_id, u32 texture_id,
+                           mat4 model) {
+  render_draw_item *item = render_packet_add_draws(packet, 1);
+  if (!item) {
+    OWARN("render_packet_push_draw - frame allocator is full, draw dropped.");
+    return false;
+  }
+  item->mesh_id = mesh_id;
+  item->texture_id = texture_id;
+  item->model = model;
+  return true;
+}
+
+static void destroy_mesh(render_mesh *mesh) {
+  backend->destroy_geometry(backend, mesh->geometry_id);
+  u64 size = sizeof(vertex_3d) * mesh->vertex_count +
+             sizeof(u32) * mesh->index_count;
+  ofree(mesh->vertices, size, MEMORY_TAG_RENDERER);
+  ozero_memory(mesh, sizeof(render_mesh));
+}
+
+/**
+ * @brief Orders draw items by mesh, then texture, so that items which can be
+ * drawn together are adjacent.
+ */
+static i32 compare_draw_items(const void *a, const void *b) {
+  const render_draw_item *item_a = a;
+  const render_draw_item *item_b = b;
+  if (item_a->mesh_id != item_b->mesh_id) {
+    return item_a->mesh_id < item_b->mesh_id ? -1 : 1;
+  }
+  if (item_a->texture_id != item_b->texture_id) {
+    return item_a->texture_id < item_b->texture_id ? -1 : 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Adds the registered objects to the packet's draw list, drops items
+ * whose mesh is no longer loaded, sorts it, and submits one batch per run of
+ * matching mesh and texture. All working memory comes from the packet's frame
+ * allocator.
+ */
+static b8 draw_batched(render_packet *packet) {
+  u32 object_count = objects.count;
+  if (object_count) {
+    render_draw_item *items = render_packet_add_draws(packet, object_count);
+    if (!items) {
+      OERROR("Frame allocator is out of space for scene objects.");
+      return false;
+    }
+    render_object *object_data = objects.elements;
+    for (u32 i = 0; i < object_count; ++i) {
+      items[i].mesh_id = object_data[i].mesh_id;
+      items[i].texture_id = object_data[i].texture_id;
+      items[i].model = object_data[i].model;
+    }
+  }
+
+  // Validate handles up front, compacting the list in place.
+  u32 item_count = 0;
+  for (u32 i = 0; i < packet->draw_item_count; ++i) {
+    render_draw_item *item = &packet->draw_items[i];
+    if (!handle_table_is_valid(&meshes, item->mesh_id)) {
+      continue;
+    }
+    if (!handle_table_is_valid(&textures, item->texture_id)) {
+      item->texture_id = INVALID_ID;
+    }
+    packet->draw_items[item_count++] = *item;
+  }
+  packet->draw_item_count = item_count;
+  if (item_count == 0) {
+    return true;
+  }
+  qsort(packet->draw_items, item_count, sizeof(render_draw_item),
+        compare_draw_items);
+
+  // Worst case every item is its own batch.
+  // Copied straight into the mapped instance buffer; keep them SIMD aligned.
+  mat4 *transforms = stack_allocator_allocate_aligned(
+      packet->frame_allocator, sizeof(mat4) * item_count, 16);
+  geometry_render_batch *batches = stack_allocator_allocate(
+      packet->frame_allocator, sizeof(geometry_render_batch) * item_count);
+  if (!transforms || !batches) {
+    OERROR("Frame allocator is out of space for batching.");
+    return false;
+  }
+
+  u32 batch_count = 0;
+  u32 batch_mesh_id = INVALID_ID;
+  for (u32 i = 0; i < item_count; ++i) {
+    render_draw_item *item = &packet->draw_items[i];
+    transforms[i] = item->model;
+
+    geometry_render_batch *last = batch_count ? &batches[batch_count - 1] : 0;
+    if (last && batch_mesh_id == item->mesh_id &&
+        last->texture_id == item->texture_id) {
+      last->instance_count++;
+    } else {
+      render_mesh *mesh = handle_table_get(&meshes, item->mesh_id);
+      geometry_render_batch *batch = &batches[batch_count++];
+      batch->geometry_id = mesh->geometry_id;
+      batch->texture_id = item->texture_id;
+      batch->first_instance = i;
+      batch->instance_count = 1;
+      batch_mesh_id = item->mesh_id;
+    }
+  }
+
+  return backend->draw_instanced(backend, transforms, item_count, batches,
+                                 batch_count);
+}
@@ -6,8 +6,24 @@
 struct static_mesh_data;
 struct platform_state;
 
-OAPI u32 renderer_register_object(u32 geometry_data_id, u32 texture_data_id);
-OAPI u32 renderer_load_mesh(vertex_3d* mesh_data, u32 vertex_count);
+OAPI u32 renderer_register_object(u32 mesh_id, u32 texture_id, mat4 model);
+OAPI b8 renderer_unregister_object(u32 object_id);
+OAPI b8 renderer_set_object_transform(u32 object_id, mat4 model);
+
+OAPI u32 renderer_load_mesh(vertex_3d *vertices, u32 vertex_count,
+                            u32 *indices, u32 index_count);
+OAPI b8 renderer_unload_mesh(u32 mesh_id);
+
+OAPI u32 renderer_create_texture(u32 width, u32 height, u8 channel_count,
+                                 const u8 *pixels);
+OAPI b8 renderer_destroy_texture(u32 texture_id);
+
+OAPI f64 renderer_get_gpu_frame_time();
+
+OAPI render_draw_item *render_packet_add_draws(render_packet *packet,
+                                               u32 count);
+OAPI b8 render_packet_push_draw(render_packet *packet, u32 mesh_id,
+                                u32 texture_id, mat4 model);
 
 b8 renderer_initialize(const char *application_name,
                        struct platform_state *plat_state);
@@ -3,6 +3,8 @@
 #include "defines.h"
 #include "math/math_types.h"
 
+struct texture;
+
 typedef enum renderer_backend_type {
 RENDERER_BACKEND_TYPE_VULKAN,
 RENDERER_BACKEND_TYPE_OPENGL,
@@ -18,6 +20,21 @@ typedef struct vertex_data {
   u32 index_count;
 } vertex_data;
 
+/**
+ * @brief A run of instances sharing the same geometry and texture, drawn with
+ * a single instanced draw call.
+ * @param texture_id - Batching key only for now; every batch is drawn with
+ * the default texture.
+ * @param first_instance - Index of the batch's first transform in the frame's
+ * instance transforms.
+ */
+typedef struct geometry_render_batch {
+  u32 geometry_id;
+  u32 texture_id;
+  u32 first_instance;
+  u32 instance_count;
+} geometry_render_batch;
+
 typedef struct renderer_backend {
   struct platform_state* plat_state;
   u64 frame_number;
@@ -30,29 +47,78 @@ typedef struct renderer_backend {
 
   b8(*begin_frame)(struct renderer_backend* backend, f32 delta_time);
   void (*update_global_state)(mat4 projection, mat4 view, vec3 view_position, vec4 ambient_colour, i32 mode);
-  void (*draw_object)(struct renderer_backend* backend, vertex_data* vert_data);
+  b8 (*create_geometry)(struct renderer_backend* backend, vertex_data* vert_data, u32* out_geometry_id);
+  void (*destroy_geometry)(struct renderer_backend* backend, u32 geometry_id);
+  b8 (*draw_instanced)(struct renderer_backend* backend, const mat4* instance_transforms, u32 instance_count, const struct geometry_render_batch* batches, u32 batch_count);
+  b8 (*create_texture)(struct renderer_backend* backend, const u8* pixels, struct texture* texture);
+  void (*destroy_texture)(struct renderer_backend* backend, struct texture* texture);
+  // Returns true and the GPU time of a completed frame if one finished since the last call
+  b8 (*get_gpu_frame_time)(struct renderer_backend* backend, f64* out_submit_time, f64* out_frame_ms);
   b8(*end_frame)(struct renderer_backend* backend, f32 delta_time);
 
 } renderer_backend;
 
 
+/**
+ * @brief A single thing to draw this frame.
+ * @param mesh_id - Mesh handle to draw, as returned by renderer_load_mesh.
+ * @param texture_id - Texture handle, or INVALID_ID. Currently only used as a
+ * batching key; the object shader always samples the default texture.
+ * @param model - World transform.
+ */
+typedef struct render_draw_item {
+  u32 mesh_id;
+  u32 texture_id;
+  mat4 model;
+} render_draw_item;
+
+/**
+ * @brief Everything the renderer needs to draw a frame. Built fresh each frame
+ * by the game's render callback; all memory referenced by it comes from
+ * frame_allocator, the current frame's stack, which is valid until the end of
+ * the next frame. Frame memory is not zeroed; anything allocated from it must
+ * be fully written.
+ * @param draw_items - Draw list, appended to with render_packet_add_draws.
+ */
 typedef struct render_packet {
   f32 delta_time;
+  struct stack_allocator* frame_allocator;
+  u32 draw_item_count;
+  render_draw_item* draw_items;
 } render_packet;
 
 /**
  * @brief Render Object describing a single entity to draw.
- * Everything is stored as an ID to allow for instanced draws of the same mesh/texture data. 
- * @param id - ID of the object, used for renderer internal tracking
- * @param geometry_data - Vertex data ID. 
- * @param texture_id - Texture data ID.
+ * Everything is stored as a handle to allow for instanced draws of the same mesh/texture data. 
+ * @param id - Handle of the object, used for renderer internal tracking
+ * @param mesh_id - Mesh handle. 
+ * @param texture_id - Texture handle, or INVALID_ID. Currently only used as a
+ * batching key; the object shader always samples the default texture.
+ * @param model - World transform of the object.
  */
 typedef struct render_object {
   u32 id;
-  u32 geometry_data_id;
-  u32 texture_data_id;
+  u32 mesh_id;
+  u32 texture_id;
+  mat4 model;
 } render_object;
 
+/**
+ * @brief A mesh loaded through the renderer. The renderer keeps its own copy
+ * of the vertex and index data, so the caller's buffers are not referenced
+ * after loading.
+ * @param geometry_id - Backend geometry the mesh was uploaded to.
+ * @param vertices - Renderer-owned copy of the vertices, followed in the same
+ * allocation by the indices.
+ */
+typedef struct render_mesh {
+  u32 geometry_id;
+  u32 vertex_count;
+  u32 index_count;
+  vertex_3d* vertices;
+  u32* indices;
+} render_mesh;
+
 /**
  * @brief Universal Buffer Object for information will be shared across shaders regardless of implementation language or graphics API.
  * @param view - view transformation
@@ -30,7 +30,7 @@ b8 vulkan_object_shader_create(vulkan_context *context,
   // Create the layout binding for the VP in the vert shader
   VkDescriptorSetLayoutBinding ubo_layout_binding;
   ubo_layout_binding.binding = 0;
-  ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   ubo_layout_binding.descriptorCount = 1;
   ubo_layout_binding.pImmutableSamplers = 0;
   ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
@@ -58,20 +58,21 @@ b8 vulkan_object_shader_create(vulkan_context *context,
       &out_shader->global_descriptor_set_layout));
 
   // // Vulkan says pool goes next
+  // A single global set is shared by every frame, since the per-frame UBO
+  // region is selected by dynamic offset.
   VkDescriptorPoolSize pool_sizes[2];
 
-  pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-  pool_sizes[0].descriptorCount =
-      context->swapchain.image_count; // could also just be 3
+  pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  pool_sizes[0].descriptorCount = 1;
 
   pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  pool_sizes[1].descriptorCount = context->swapchain.image_count;
+  pool_sizes[1].descriptorCount = 1;
 
   VkDescriptorPoolCreateInfo pool_info = {
       VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
   pool_info.poolSizeCount = 2;
   pool_info.pPoolSizes = pool_sizes;
-  pool_info.maxSets = context->swapchain.image_count;
+  pool_info.maxSets = 1;
 
   VK_CHECK(vkCreateDescriptorPool(context->device.logical_device, &pool_info,
                                   context->allocator,
@@ -92,15 +93,25 @@ b8 vulkan_object_shader_create(vulkan_context *context,
   scissor.extent.width = context->framebuffer_width;
   scissor.extent.height = context->framebuffer_height;
 
+  // Bindings. Per-vertex data comes from the object vertex buffer, and the
+  // model matrix per instance from the instance buffer.
+  const u32 binding_count = 2;
+  VkVertexInputBindingDescription binding_descriptions[2];
+  binding_descriptions[0].binding = 0;
+  binding_descriptions[0].stride = sizeof(vertex_3d);
+  binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  binding_descriptions[1].binding = 1;
+  binding_descriptions[1].stride = sizeof(mat4);
+  binding_descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
   // Attributes
   u32 offset = 0;
-  const i32 attribute_count = 2; // position, texture sample
+  const i32 attribute_count = 6; // position, texture sample, model (4 columns)
   VkVertexInputAttributeDescription attribute_descriptions[attribute_count];
   // Position
-  VkFormat formats[2] = {VK_FORMAT_R32G32B32_SFLOAT,
-                         VK_FORMAT_R32G32B32_SFLOAT};
+  VkFormat formats[2] = {VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT};
   u64 sizes[2] = {sizeof(vec3), sizeof(vec2)}; // position, tex
-  for (u32 i = 0; i < attribute_count; ++i) {
+  for (u32 i = 0; i < 2; ++i) {
     attribute_descriptions[i].binding =
         0; // binding index - should match binding desc
     attribute_descriptions[i].location = i; // attrib location
@@ -108,6 +119,13 @@ b8 vulkan_object_shader_create(vulkan_context *context,
     attribute_descriptions[i].offset = offset;
     offset += sizes[i];
   }
+  // Model matrix, a mat4 input takes one location per column
+  for (u32 i = 0; i < 4; ++i) {
+    attribute_descriptions[2 + i].binding = 1;
+    attribute_descriptions[2 + i].location = 2 + i;
+    attribute_descriptions[2 + i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute_descriptions[2 + i].offset = sizeof(vec4) * i;
+  }
 
   // Descriptor set layouts
   const i32 descriptor_set_layout_count = 1;
@@ -124,39 +142,48 @@ b8 vulkan_object_shader_create(vulkan_context *context,
   }
 
   if (!vulkan_graphics_pipeline_create(
-          context, &context->main_renderpass, attribute_count,
-          attribute_descriptions, descriptor_set_layout_count, layouts,
-          OBJECT_SHADER_STAGE_COUNT, stage_create_infos, viewport, scissor,
-          false, &out_shader->pipeline)) {
+          context, &context->main_renderpass, binding_count,
+          binding_descriptions, attribute_count, attribute_descriptions,
+          descriptor_set_layout_count, layouts, OBJECT_SHADER_STAGE_COUNT,
+          stage_create_infos, viewport, scissor, false,
+          &out_shader->pipeline)) {
     OERROR("Failed to load graphics pipeline for object shader.");
     return false;
   }
 
-  if (!vulkan_buffer_create(context, sizeof(global_uniform_object),
+  // One UBO region per frame in flight, so writing this frame's data never
+  // races a previous frame still reading its own.
+  u64 alignment =
+      context->device.properties.limits.minUniformBufferOffsetAlignment;
+  u64 stride = sizeof(global_uniform_object);
+  if (alignment > 1) {
+    stride = (stride + alignment - 1) & ~(alignment - 1);
+  }
+  out_shader->global_ubo_stride = stride;
+  u64 ubo_size = stride * context->swapchain.max_frames_in_flight;
+  if (!vulkan_buffer_create(context, ubo_size,
                             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                            true, &out_shader->global_uniform_buffer)) {
+                            true, false, &out_shader->global_uniform_buffer)) {
     OERROR("Failed to create global uniform buffers");
     return false;
   }
-
-  VkDescriptorSetLayout global_layouts[3] = {
-      out_shader->global_descriptor_set_layout,
-      out_shader->global_descriptor_set_layout,
-      out_shader->global_descriptor_set_layout};
+  // Host coherent, so it stays mapped and is written directly each frame.
+  out_shader->global_uniform_buffer_mapped = vulkan_buffer_lock_memory(
+      context, &out_shader->global_uniform_buffer, 0, ubo_size, 0);
 
   VkDescriptorSetAllocateInfo allocate_info = {
       VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
   allocate_info.descriptorPool = out_shader->global_descriptor_pool;
-  allocate_info.descriptorSetCount = 3;
-  allocate_info.pSetLayouts = global_layouts;
+  allocate_info.descriptorSetCount = 1;
+  allocate_info.pSetLayouts = &out_shader->global_descriptor_set_layout;
 
   VK_CHECK(vkAllocateDescriptorSets(context->device.logical_device,
                                     &allocate_info,
-                                    out_shader->global_descriptor_sets));
+                                    &out_shader->global_descriptor_set));
 
   return true;
 }
@@ -166,6 +193,8 @@ void vulkan_object_shader_destroy(vulkan_context *context,
 
   VkDevice logical_device = context->device.logical_device;
 
+  vulkan_buffer_unlock_memory(context, &shader->global_uniform_buffer);
+  shader->global_uniform_buffer_mapped = 0;
   vulkan_buffer_destroy(context, &shader->global_uniform_buffer);
 
   // Destroy pipeline.
@@ -194,58 +223,58 @@ void vulkan_object_shader_use(vulkan_context *context,
                        VK_PIPELINE_BIND_POINT_GRAPHICS, &shader->pipeline);
 }
 
-void vulkan_object_shader_update_global_state(vulkan_context *context,
-                                              vulkan_object_shader *shader) {
-  u32 image_index = context->image_index;
-  VkCommandBuffer command_buffer =
-      context->graphics_command_buffers[image_index].handle;
-  VkDescriptorSet global_descriptor =
-      shader->global_descriptor_sets[image_index];
-
-  // Configure the descriptors for the given index.
-  u32 range = sizeof(global_uniform_object);
-  u64 offset = 0;
-
-  // Load the actual data to the UBO
-  vulkan_buffer_load_data(context, &shader->global_uniform_buffer, offset,
-                          range, 0, &shader->global_ubo);
-
+void vulkan_object_shader_write_descriptors(vulkan_context *context,
+                                            vulkan_object_shader *shader) {
+  // The buffer info covers a single region; the frame's region is chosen by
+  // the dynamic offset at bind time.
   VkDescriptorBufferInfo buffer_info;
   buffer_info.buffer = shader->global_uniform_buffer.handle;
-  buffer_info.offset = offset;
-  buffer_info.range = range;
+  buffer_info.offset = 0;
+  buffer_info.range = sizeof(global_uniform_object);
+
+  VkDescriptorImageInfo image_info;
+  image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  image_info.imageView = shader->texture.image.view;
+  image_info.sampler = shader->texture.sampler;
 
-  // Update descriptor sets.
   VkWriteDescriptorSet descriptor_writes[2] = {
       {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET},
       {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}};
 
-  descriptor_writes[0].dstSet = shader->global_descriptor_sets[image_index];
+  descriptor_writes[0].dstSet = shader->global_descriptor_set;
   descriptor_writes[0].dstBinding = 0;
   descriptor_writes[0].dstArrayElement = 0;
-  descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  descriptor_writes[0].descriptorType =
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   descriptor_writes[0].descriptorCount = 1;
   descriptor_writes[0].pBufferInfo = &buffer_info;
 
-  VkDescriptorImageInfo image_info;
-  image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  image_info.imageView = shader->texture.image.view;
-  image_info.sampler = shader->texture.sampler;
-
-  descriptor_writes[1].dstSet = shader->global_descriptor_sets[image_index];
+  descriptor_writes[1].dstSet = shader->global_descriptor_set;
   descriptor_writes[1].dstBinding = 1;
   descriptor_writes[1].dstArrayElement = 0;
   descriptor_writes[1].descriptorType =
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  descriptor_writes[1].pImageInfo = &image_info;
   descriptor_writes[1].descriptorCount = 1;
-  descriptor_writes[1].pBufferInfo = &buffer_info;
+  descriptor_writes[1].pImageInfo = &image_info;
 
   vkUpdateDescriptorSets(context->device.logical_device, 2, descriptor_writes,
                          0, 0);
+}
+
+void vulkan_object_shader_update_global_state(vulkan_context *context,
+                                              vulkan_object_shader *shader) {
+  u32 image_index = context->image_index;
+  VkCommandBuffer command_buffer =
+      context->graphics_command_buffers[image_index].handle;
+
+  // This frame's fence has been waited on, so its region is free to write.
+  u64 offset = shader->global_ubo_stride * context->current_frame;
+  ocopy_memory(shader->global_uniform_buffer_mapped + offset,
+               &shader->global_ubo, sizeof(global_uniform_object));
 
-  // Bind the global descriptor set to be updated.
+  // Bind the global descriptor set at this frame's region.
+  u32 dynamic_offset = (u32)offset;
   vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                           shader->pipeline.pipeline_layout, 0, 1,
-                          &global_descriptor, 0, 0);
+                          &shader->global_descriptor_set, 1, &dynamic_offset);
 }
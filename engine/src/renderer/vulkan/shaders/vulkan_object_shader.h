@@ -12,5 +12,16 @@ void vulkan_object_shader_destroy(vulkan_context *context,
 void vulkan_object_shader_use(vulkan_context *context,
                               struct vulkan_object_shader *shader);
 
+/**
+ * Writes the global descriptor set. Called once, after the shader's texture
+ * has been created; afterwards the set is only bound.
+ */
+void vulkan_object_shader_write_descriptors(vulkan_context *context,
+                                            vulkan_object_shader *shader);
+
+/**
+ * Copies global_ubo into the current frame's UBO region and binds the global
+ * descriptor set at that region's dynamic offset.
+ */
 void vulkan_object_shader_update_global_state(vulkan_context *context,
                                               vulkan_object_shader *shader);
@@ -4,9 +4,12 @@
 #include "vulkan_device.h"
 #include "vulkan_fence.h"
 #include "vulkan_framebuffer.h"
+#include "vulkan_gpu_timer.h"
 #include "vulkan_image.h"
+#include "vulkan_pipeline_cache.h"
 #include "vulkan_platform.h"
 #include "vulkan_renderpass.h"
+#include "vulkan_staging.h"
 #include "vulkan_swapchain.h"
 #include "vulkan_texture.h"
 
@@ -26,6 +29,12 @@
 #include "math/omath.h"
 #include "shaders/vulkan_object_shader.h"
 
+// Size of each per-frame region of the staging ring
+#define VULKAN_STAGING_REGION_SIZE (8 * 1024 * 1024)
+
+// Where the pipeline cache is loaded from at startup and saved at shutdown
+#define VULKAN_PIPELINE_CACHE_PATH "assets/cache/pipeline.cache"
+
 // static context for Vulkan
 static vulkan_context context;
 static u32 cached_framebuffer_width = 0;
@@ -45,31 +54,12 @@ void regenerate_framebuffers(renderer_backend *backend,
 b8 recreate_swapchain(renderer_backend *backend);
 
 b8 create_buffers(vulkan_context *context);
+b8 allocate_geometry_range(vulkan_context *context, vulkan_buffer *buffer,
+                           u64 size, u64 *out_offset);
+void release_pending_range_frees(vulkan_context *context, u32 frame);
 
 u8 *create_sample_texture(u32 height, u32 width);
 
-void upload_data_range(vulkan_context *context, VkCommandPool pool,
-                       VkFence fence, VkQueue queue, vulkan_buffer *buffer,
-                       u64 offset, u64 size, void *data) {
-  // Create a host-visible staging buffer to upload to. Mark it as the source of
-  // the transfer.
-  VkBufferUsageFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-  vulkan_buffer staging;
-  vulkan_buffer_create(context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, flags,
-                       true, &staging);
-
-  // Load the data into the staging buffer.
-  vulkan_buffer_load_data(context, &staging, 0, size, 0, data);
-
-  // Perform the copy from staging to the device local buffer.
-  vulkan_buffer_copy_to(context, pool, fence, queue, staging.handle, 0,
-                        buffer->handle, offset, size);
-
-  // Clean up the staging buffer.
-  vulkan_buffer_destroy(context, &staging);
-}
-
 b8 vulkan_renderer_backend_initialize(renderer_backend *backend,
                                       const char *application_name,
                                       struct platform_state *plat_state) {
@@ -139,7 +129,7 @@ b8 vulkan_renderer_backend_initialize(renderer_backend *backend,
   u32 available_layer_count = 0;
   VK_CHECK(vkEnumerateInstanceLayerProperties(&available_layer_count, 0));
   VkLayerProperties *available_layers =
-      darray_reserve(VkLayerProperties, available_layer_count);
+      darray_create_with_capacity(VkLayerProperties, available_layer_count);
   VK_CHECK(vkEnumerateInstanceLayerProperties(&available_layer_count,
                                               available_layers));
 
@@ -223,20 +213,20 @@ b8 vulkan_renderer_backend_initialize(renderer_backend *backend,
       context.framebuffer_height, 0.0f, 0.0f, 0.2f, 1.0f, 1.0f, 0);
 
   // Swapchain framebuffers
-  context.swapchain.framebuffers =
-      darray_reserve(vulkan_framebuffer, context.swapchain.image_count);
+  context.swapchain.framebuffers = darray_create_with_capacity(
+      vulkan_framebuffer, context.swapchain.image_count);
   regenerate_framebuffers(backend, &context.swapchain,
                           &context.main_renderpass);
 
   create_command_buffers(backend);
 
   // Create sync objects.
-  context.image_available_semaphores =
-      darray_reserve(VkSemaphore, context.swapchain.max_frames_in_flight);
-  context.queue_complete_semaphores =
-      darray_reserve(VkSemaphore, context.swapchain.max_frames_in_flight);
-  context.in_flight_fences =
-      darray_reserve(vulkan_fence, context.swapchain.max_frames_in_flight);
+  context.image_available_semaphores = darray_create_with_capacity(
+      VkSemaphore, context.swapchain.max_frames_in_flight);
+  context.queue_complete_semaphores = darray_create_with_capacity(
+      VkSemaphore, context.swapchain.max_frames_in_flight);
+  context.in_flight_fences = darray_create_with_capacity(
+      vulkan_fence, context.swapchain.max_frames_in_flight);
 
   for (u8 i = 0; i < context.swapchain.max_frames_in_flight; ++i) {
     VkSemaphoreCreateInfo semaphore_create_info = {
@@ -258,55 +248,63 @@ b8 vulkan_renderer_backend_initialize(renderer_backend *backend,
   // These are stored in pointers because the initial state should be 0, and
   // will be 0 when not in use. Acutal fences are not owned by this list.
   context.images_in_flight =
-      darray_reserve(vulkan_fence, context.swapchain.image_count);
+      darray_create_with_capacity(vulkan_fence, context.swapchain.image_count);
   for (u32 i = 0; i < context.swapchain.image_count; ++i) {
     context.images_in_flight[i] = 0;
   }
 
+  // A cache failure only costs startup time, so it isn't fatal.
+  if (!vulkan_pipeline_cache_create(&context, VULKAN_PIPELINE_CACHE_PATH)) {
+    OWARN("Continuing without a pipeline cache.");
+  }
+
+  vulkan_gpu_timer_create(&context, context.swapchain.max_frames_in_flight,
+                          &context.gpu_timer);
+
   // Create builtin shaders
   if (!vulkan_object_shader_create(&context, &context.object_shader)) {
     OERROR("Error loading built-in basic_lighting shader.");
     return false;
   }
 
-  create_buffers(&context);
-
-  vulkan_buffer staging_buffer;
-  u8 *texture_data = create_sample_texture(512, 512);
-
-  vulkan_buffer_create(&context, sizeof(u8) * 512 * 512 * 4,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       true, &staging_buffer);
-
-  vulkan_buffer_load_data(&context, &staging_buffer, 0,
-                          sizeof(u8) * 512 * 512 * 4, 0, texture_data);
-
-  vulkan_image_create(
-      &context, VK_IMAGE_TYPE_2D, 512, 512, VK_FORMAT_R8G8B8A8_SRGB,
-      VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_COLOR_BIT,
-      &context.object_shader.texture.image);
-
-  vulkan_image_transition_layout(&context, VK_FORMAT_R8G8B8A8_SRGB,
-                                 VK_IMAGE_LAYOUT_UNDEFINED,
-                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                 &context.object_shader.texture.image);
+  if (!create_buffers(&context)) {
+    OERROR("Failed to create object buffers.");
+    return false;
+  }
 
-  vulkan_buffer_copy_to_image(&context, 512, 512, staging_buffer,
-                              &context.object_shader.texture.image);
+  // Mark all geometry slots as free
+  for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
+    context.geometries[i].id = INVALID_ID;
+  }
 
-  vulkan_image_transition_layout(&context, VK_FORMAT_R8G8B8A8_SRGB,
-                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                 &context.object_shader.texture.image);
+  if (context.swapchain.max_frames_in_flight >
+      VULKAN_MAX_PENDING_FREE_FRAMES) {
+    OERROR("Cannot defer geometry frees for %u frames in flight, max is %u.",
+           context.swapchain.max_frames_in_flight,
+           VULKAN_MAX_PENDING_FREE_FRAMES);
+    return false;
+  }
+  for (u32 i = 0; i < VULKAN_MAX_PENDING_FREE_FRAMES; ++i) {
+    context.pending_range_frees[i] = darray_create(vulkan_pending_range_free);
+  }
+  context.last_begun_frame = 0;
 
-  vulkan_buffer_destroy(&context, &staging_buffer);
+  if (!vulkan_staging_ring_create(&context, VULKAN_STAGING_REGION_SIZE,
+                                  context.swapchain.max_frames_in_flight,
+                                  &context.staging)) {
+    OERROR("Failed to create staging ring.");
+    return false;
+  }
 
-  vulkan_texture_create_sampler(&context,
-                                &context.object_shader.texture.sampler);
+  u8 *texture_data = create_sample_texture(512, 512);
+  b8 texture_created = vulkan_texture_create(&context, 512, 512, texture_data,
+                                             &context.object_shader.texture);
+  ofree(texture_data, sizeof(u8) * 512 * 512 * 4, MEMORY_TAG_RENDERER);
+  if (!texture_created) {
+    OERROR("Failed to create the default texture.");
+    return false;
+  }
+  vulkan_object_shader_write_descriptors(&context, &context.object_shader);
 
   OINFO("Vulkan renderer initialized successfully.");
   return true;
@@ -316,16 +314,34 @@ void vulkan_renderer_backend_shutdown(renderer_backend *backend) {
 
   vkDeviceWaitIdle(context.device.logical_device);
 
-  vkDestroySampler(context.device.logical_device,
-                   context.object_shader.texture.sampler, context.allocator);
-  vulkan_image_destroy(&context, &context.object_shader.texture.image);
+  // Nothing is in flight anymore, and the buffers are about to go anyway.
+  for (u32 i = 0; i < VULKAN_MAX_PENDING_FREE_FRAMES; ++i) {
+    if (context.pending_range_frees[i]) {
+      darray_destroy(context.pending_range_frees[i]);
+      context.pending_range_frees[i] = 0;
+    }
+  }
+
+  vulkan_staging_ring_destroy(&context, &context.staging);
+
+  vulkan_texture_destroy(&context, &context.object_shader.texture);
 
   vulkan_buffer_destroy(&context, &context.object_vertex_buffer);
   vulkan_buffer_destroy(&context, &context.object_index_buffer);
 
+  vulkan_buffer_unlock_memory(&context, &context.instance_buffer);
+  context.instance_buffer_mapped = 0;
+  vulkan_buffer_destroy(&context, &context.instance_buffer);
+
   // destroy shader modules
   vulkan_object_shader_destroy(&context, &context.object_shader);
 
+  // Save whatever the driver has cached for the next launch.
+  vulkan_pipeline_cache_save(&context, VULKAN_PIPELINE_CACHE_PATH);
+  vulkan_pipeline_cache_destroy(&context);
+
+  vulkan_gpu_timer_destroy(&context, &context.gpu_timer);
+
   // Sync objects
   for (u8 i = 0; i < context.swapchain.max_frames_in_flight; ++i) {
     if (context.image_available_semaphores[i]) {
@@ -448,6 +464,11 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend,
     return false;
   }
 
+  // This frame slot's previous GPU work is done, so its timings are ready.
+  vulkan_gpu_timer_collect(&context, &context.gpu_timer, context.current_frame);
+  // ...and nothing reads the geometry ranges destroyed up to that frame.
+  release_pending_range_frees(&context, context.current_frame);
+
   // Acquire next image from swapchain, send the semaphore that should be
   // signaled when it's complete Sempahore will later be waited on by the queue
   // to ensure availability
@@ -458,11 +479,16 @@ b8 vulkan_renderer_backend_begin_frame(renderer_backend *backend,
     return false;
   }
 
+  // Geometry destroyed from here on may be read by this frame.
+  context.last_begun_frame = context.current_frame;
+
   // Begin recording commands
   vulkan_command_buffer *command_buffer =
       &context.graphics_command_buffers[context.image_index];
   vulkan_command_buffer_reset(command_buffer);
   vulkan_command_buffer_begin(command_buffer, false, false, false);
+  vulkan_gpu_timer_begin(&context.gpu_timer, command_buffer,
+                         context.current_frame);
 
   // State
   VkViewport viewport;
@@ -510,41 +536,197 @@ void vulkan_renderer_backend_update_global_state(mat4 projection, mat4 view,
   vulkan_object_shader_update_global_state(&context, &context.object_shader);
 }
 
-void vulkan_renderer_draw_object(renderer_backend *backend,
-                                 vertex_data *vert_data) {
+b8 vulkan_renderer_create_geometry(renderer_backend *backend,
+                                   vertex_data *vert_data,
+                                   u32 *out_geometry_id) {
+  if (!vert_data || !vert_data->vertex_count || !vert_data->vertices) {
+    OERROR("vulkan_renderer_create_geometry requires vertex data, and none "
+           "was supplied. vertex_count=%u, vertices=%p",
+           vert_data ? vert_data->vertex_count : 0,
+           vert_data ? vert_data->vertices : 0);
+    return false;
+  }
 
-  vulkan_command_buffer *command_buffer =
-      &context.graphics_command_buffers[context.image_index];
+  // Find a free slot for the new geometry
+  vulkan_geometry_data *internal_data = 0;
+  for (u32 i = 0; i < VULKAN_MAX_GEOMETRY_COUNT; ++i) {
+    if (context.geometries[i].id == INVALID_ID) {
+      internal_data = &context.geometries[i];
+      internal_data->id = i;
+      break;
+    }
+  }
+  if (!internal_data) {
+    OFATAL("vulkan_renderer_create_geometry failed to find a free index for a "
+           "new geometry upload. Adjust VULKAN_MAX_GEOMETRY_COUNT to allow "
+           "for more.");
+    return false;
+  }
 
-  // These buffers have already been created, we're just going to upload into
-  // them again
-  upload_data_range(
-      &context, context.device.graphics_command_pool, 0,
-      context.device.graphics_queue, &context.object_vertex_buffer, 0,
-      sizeof(vertex_3d) * vert_data->vertex_count, vert_data->vertices);
-  upload_data_range(&context, context.device.graphics_command_pool, 0,
-                    context.device.graphics_queue, &context.object_index_buffer,
-                    0, sizeof(u32) * vert_data->index_count,
-                    vert_data->indices);
-
-  // TODO: temporary test code
-  vulkan_object_shader_use(&context, &context.object_shader);
+  // Vertex data. Uploaded once here, draws just reference the offset.
+  // NOTE: Every range in a buffer is a multiple of the element size, so
+  // offsets stay aligned to it.
+  u64 vertex_total_size = sizeof(vertex_3d) * vert_data->vertex_count;
+  internal_data->vertex_count = vert_data->vertex_count;
+  internal_data->vertex_size = sizeof(vertex_3d);
+  if (!allocate_geometry_range(&context, &context.object_vertex_buffer,
+                               vertex_total_size,
+                               &internal_data->vertex_buffer_offset)) {
+    OERROR("vulkan_renderer_create_geometry failed to allocate from the "
+           "vertex buffer.");
+    internal_data->id = INVALID_ID;
+    return false;
+  }
+  if (!vulkan_staging_upload_buffer(&context, &context.staging,
+                                    &context.object_vertex_buffer,
+                                    internal_data->vertex_buffer_offset,
+                                    vertex_total_size, vert_data->vertices)) {
+    OERROR("vulkan_renderer_create_geometry failed to upload vertex data.");
+    vulkan_buffer_free(&context.object_vertex_buffer, vertex_total_size,
+                       internal_data->vertex_buffer_offset);
+    internal_data->id = INVALID_ID;
+    return false;
+  }
+
+  // Index data, if applicable
+  internal_data->index_count = 0;
+  internal_data->index_size = sizeof(u32);
+  if (vert_data->index_count && vert_data->indices) {
+    u64 index_total_size = sizeof(u32) * vert_data->index_count;
+    if (!allocate_geometry_range(&context, &context.object_index_buffer,
+                                 index_total_size,
+                                 &internal_data->index_buffer_offset)) {
+      OERROR("vulkan_renderer_create_geometry failed to allocate from the "
+             "index buffer.");
+      vulkan_buffer_free(&context.object_vertex_buffer, vertex_total_size,
+                         internal_data->vertex_buffer_offset);
+      internal_data->id = INVALID_ID;
+      return false;
+    }
+    internal_data->index_count = vert_data->index_count;
+    if (!vulkan_staging_upload_buffer(&context, &context.staging,
+                                      &context.object_index_buffer,
+                                      internal_data->index_buffer_offset,
+                                      index_total_size, vert_data->indices)) {
+      OERROR("vulkan_renderer_create_geometry failed to upload index data.");
+      vulkan_buffer_free(&context.object_vertex_buffer, vertex_total_size,
+                         internal_data->vertex_buffer_offset);
+      vulkan_buffer_free(&context.object_index_buffer, index_total_size,
+                         internal_data->index_buffer_offset);
+      internal_data->id = INVALID_ID;
+      return false;
+    }
+  }
 
-  // Bind vertex buffer at offset.
-  VkDeviceSize offsets[1] = {0};
-  vkCmdBindVertexBuffers(command_buffer->handle, 0, 1,
-                         &context.object_vertex_buffer.handle,
-                         (VkDeviceSize *)offsets);
+  internal_data->generation++;
+  *out_geometry_id = internal_data->id;
+  return true;
+}
+
+void vulkan_renderer_destroy_geometry(renderer_backend *backend,
+                                      u32 geometry_id) {
+  if (geometry_id >= VULKAN_MAX_GEOMETRY_COUNT ||
+      context.geometries[geometry_id].id == INVALID_ID) {
+    OWARN("vulkan_renderer_destroy_geometry called with invalid id: %u",
+          geometry_id);
+    return;
+  }
 
-  // Bind index buffer at offset.
+  // Frames up to the last one begun may still read the ranges, so they are
+  // only returned for reuse once that frame's fence has been waited on.
+  vulkan_geometry_data *internal_data = &context.geometries[geometry_id];
+  vulkan_pending_range_free *pending =
+      context.pending_range_frees[context.last_begun_frame];
+  vulkan_pending_range_free vertex_range = {
+      &context.object_vertex_buffer,
+      internal_data->vertex_size * internal_data->vertex_count,
+      internal_data->vertex_buffer_offset};
+  darray_push(pending, vertex_range);
+  if (internal_data->index_count > 0) {
+    vulkan_pending_range_free index_range = {
+        &context.object_index_buffer,
+        internal_data->index_size * internal_data->index_count,
+        internal_data->index_buffer_offset};
+    darray_push(pending, index_range);
+  }
+  context.pending_range_frees[context.last_begun_frame] = pending;
+  u32 generation = internal_data->generation;
+  ozero_memory(internal_data, sizeof(vulkan_geometry_data));
+  internal_data->id = INVALID_ID;
+  internal_data->generation = generation;
+}
+
+b8 vulkan_renderer_draw_instanced(renderer_backend *backend,
+                                  const mat4 *instance_transforms,
+                                  u32 instance_count,
+                                  const geometry_render_batch *batches,
+                                  u32 batch_count) {
+  if (instance_count == 0 || batch_count == 0) {
+    return true;
+  }
+  if (instance_count > VULKAN_MAX_INSTANCE_COUNT) {
+    OWARN("vulkan_renderer_draw_instanced - %u instances submitted, only the "
+          "first %u will be drawn. Adjust VULKAN_MAX_INSTANCE_COUNT to allow "
+          "for more.",
+          instance_count, VULKAN_MAX_INSTANCE_COUNT);
+    instance_count = VULKAN_MAX_INSTANCE_COUNT;
+  }
+
+  vulkan_command_buffer *command_buffer =
+      &context.graphics_command_buffers[context.image_index];
+
+  // Write this frame's transforms to its region of the instance buffer. The
+  // in flight fence waited on in begin_frame guarantees the GPU is done with
+  // it.
+  u64 region_offset =
+      sizeof(mat4) * VULKAN_MAX_INSTANCE_COUNT * context.current_frame;
+  ocopy_memory(context.instance_buffer_mapped + region_offset,
+               instance_transforms, sizeof(mat4) * instance_count);
+
+  // Buffers are shared by all geometry, so they're bound once and each draw
+  // selects its range.
+  VkBuffer vertex_buffers[2] = {context.object_vertex_buffer.handle,
+                                context.instance_buffer.handle};
+  VkDeviceSize offsets[2] = {0, region_offset};
+  vkCmdBindVertexBuffers(command_buffer->handle, 0, 2, vertex_buffers,
+                         offsets);
   vkCmdBindIndexBuffer(command_buffer->handle,
                        context.object_index_buffer.handle, 0,
                        VK_INDEX_TYPE_UINT32);
 
-  // Issue the draw.
-  vkCmdDrawIndexed(command_buffer->handle, vert_data->index_count, 1, 0, 0, 0);
+  for (u32 i = 0; i < batch_count; ++i) {
+    const geometry_render_batch *batch = &batches[i];
+    if (batch->geometry_id >= VULKAN_MAX_GEOMETRY_COUNT ||
+        context.geometries[batch->geometry_id].id == INVALID_ID) {
+      OWARN("vulkan_renderer_draw_instanced called with invalid geometry id: "
+            "%u",
+            batch->geometry_id);
+      continue;
+    }
+    if (batch->first_instance >= instance_count) {
+      continue;
+    }
+    u32 batch_instances = batch->instance_count;
+    if (batch->first_instance + batch_instances > instance_count) {
+      batch_instances = instance_count - batch->first_instance;
+    }
+
+    vulkan_geometry_data *buffer_data = &context.geometries[batch->geometry_id];
+    u32 first_vertex =
+        buffer_data->vertex_buffer_offset / buffer_data->vertex_size;
+    if (buffer_data->index_count > 0) {
+      u32 first_index =
+          buffer_data->index_buffer_offset / buffer_data->index_size;
+      vkCmdDrawIndexed(command_buffer->handle, buffer_data->index_count,
+                       batch_instances, first_index, (i32)first_vertex,
+                       batch->first_instance);
+    } else {
+      vkCmdDraw(command_buffer->handle, buffer_data->vertex_count,
+                batch_instances, first_vertex, batch->first_instance);
+    }
+  }
 
-  // TODO: end temporary test code
+  return true;
 }
 
 b8 vulkan_renderer_backend_end_frame(renderer_backend *backend,
@@ -554,9 +736,17 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend *backend,
 
   // End renderpass
   vulkan_renderpass_end(command_buffer, &context.main_renderpass);
+  vulkan_gpu_timer_end(&context.gpu_timer, command_buffer,
+                       context.current_frame);
 
   vulkan_command_buffer_end(command_buffer);
 
+  // Submit this frame's uploads ahead of the draws that use them.
+  if (!vulkan_staging_ring_flush(&context, &context.staging)) {
+    OERROR("Failed to submit staged uploads.");
+    return false;
+  }
+
   // Make sure the previous frame is not using this image
   if (context.images_in_flight[context.image_index] != VK_NULL_HANDLE) {
     vulkan_fence_wait(&context, context.images_in_flight[context.image_index],
@@ -610,39 +800,54 @@ b8 vulkan_renderer_backend_end_frame(renderer_backend *backend,
 
   return true;
 }
-void vulkan_renderer_backend_create_texture() {
-
-  vulkan_buffer staging_buffer;
-  u8 *texture_data;
-  vulkan_buffer_create(&context, sizeof(u8) * 512 * 512 * 4,
-                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                       true, &staging_buffer);
-
-  vulkan_buffer_load_data(&context, &staging_buffer, 0,
-                          sizeof(u8) * 512 * 512 * 4, 0, texture_data);
-
-  vulkan_image texture_image;
-  vulkan_image_create(
-      &context, VK_IMAGE_TYPE_2D, 512, 512, VK_FORMAT_R8G8B8A8_SRGB,
-      VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, true, 0,
-      &texture_image);
-
-  vulkan_image_transition_layout(
-      &context, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &texture_image);
-
-  vulkan_buffer_copy_to_image(&context, 512, 512, staging_buffer,
-                              &texture_image);
-
-  vulkan_image_transition_layout(
-      &context, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, &texture_image);
-
-  vulkan_buffer_destroy(&context, &staging_buffer);
+b8 vulkan_renderer_get_gpu_frame_time(renderer_backend *backend,
+                                      f64 *out_submit_time,
+                                      f64 *out_frame_ms) {
+  vulkan_gpu_timer *timer = &context.gpu_timer;
+  if (!timer->has_result) {
+    return false;
+  }
+  timer->has_result = false;
+  *out_submit_time = timer->last_submit_time;
+  *out_frame_ms = timer->last_frame_ms;
+  return true;
+}
+
+b8 vulkan_renderer_create_texture(renderer_backend *backend, const u8 *pixels,
+                                  texture *texture) {
+  if (!pixels || texture->width == 0 || texture->height == 0) {
+    OERROR("vulkan_renderer_create_texture requires pixel data and non-zero "
+           "dimensions.");
+    return false;
+  }
+  if (texture->channel_count != 4) {
+    OERROR("vulkan_renderer_create_texture only supports RGBA8 textures, got "
+           "%u channels.",
+           texture->channel_count);
+    return false;
+  }
+
+  vulkan_texture *internal_data =
+      oallocate(sizeof(vulkan_texture), MEMORY_TAG_TEXTURE);
+  if (!vulkan_texture_create(&context, texture->width, texture->height, pixels,
+                             internal_data)) {
+    ofree(internal_data, sizeof(vulkan_texture), MEMORY_TAG_TEXTURE);
+    return false;
+  }
+  texture->internal_data = internal_data;
+  return true;
+}
+
+void vulkan_renderer_destroy_texture(renderer_backend *backend,
+                                     texture *texture) {
+  if (!texture->internal_data) {
+    return;
+  }
+  // The texture may still be referenced by frames in flight.
+  vkDeviceWaitIdle(context.device.logical_device);
+  vulkan_texture_destroy(&context, texture->internal_data);
+  ofree(texture->internal_data, sizeof(vulkan_texture), MEMORY_TAG_TEXTURE);
+  texture->internal_data = 0;
 }
 
 // ------------- START PRIVATE FUNCTIONS
@@ -654,7 +859,9 @@ void vulkan_renderer_backend_create_texture() {
  * @param out_texture the texture data in rgba format will be returned here.
  */
 u8 *create_sample_texture(u32 height, u32 width) {
-  u8 *texture_data = oallocate(sizeof(u8) * 512 * 512 * 4, MEMORY_TAG_RENDERER);
+  // Every byte is written below, so skip zeroing it first.
+  u8 *texture_data =
+      oallocate_uninit(sizeof(u8) * 512 * 512 * 4, MEMORY_TAG_RENDERER);
   oset_memory(texture_data, 0xFF, sizeof(u8) * 512 * 512 * 4);
   // row iteration
   for (u64 row = 0; row < height; ++row) {
@@ -721,8 +928,8 @@ i32 find_memory_index(u32 type_filter, u32 property_flags) {
 
 void create_command_buffers(renderer_backend *backend) {
   if (!context.graphics_command_buffers) {
-    context.graphics_command_buffers =
-        darray_reserve(vulkan_command_buffer, context.swapchain.image_count);
+    context.graphics_command_buffers = darray_create_with_capacity(
+        vulkan_command_buffer, context.swapchain.image_count);
     for (u32 i = 0; i < context.swapchain.image_count; ++i) {
       ozero_memory(&context.graphics_command_buffers[i],
                    sizeof(vulkan_command_buffer));
@@ -840,22 +1047,77 @@ b8 create_buffers(vulkan_context *context) {
           context, vertex_buffer_size,
           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-          memory_property_flags, true, &context->object_vertex_buffer)) {
+          memory_property_flags, true, true, &context->object_vertex_buffer)) {
     OERROR("Error creating vertex buffer.");
     return false;
   }
-  context->geometry_vertex_offset = 0;
 
   const u64 index_buffer_size = sizeof(u32) * 1024 * 1024;
   if (!vulkan_buffer_create(
           context, index_buffer_size,
           VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-          memory_property_flags, true, &context->object_index_buffer)) {
+          memory_property_flags, true, true, &context->object_index_buffer)) {
     OERROR("Error creating vertex buffer.");
     return false;
   }
-  context->geometry_index_offset = 0;
+
+  // Rewritten every frame, so kept host visible rather than staged.
+  const u64 instance_buffer_size = sizeof(mat4) * VULKAN_MAX_INSTANCE_COUNT *
+                                   context->swapchain.max_frames_in_flight;
+  if (!vulkan_buffer_create(context, instance_buffer_size,
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                            true, false, &context->instance_buffer)) {
+    OERROR("Error creating instance buffer.");
+    return false;
+  }
+  context->instance_buffer_mapped = vulkan_buffer_lock_memory(
+      context, &context->instance_buffer, 0, instance_buffer_size, 0);
 
   return true;
 }
+
+/**
+ * @brief Allocates a range from one of the object buffers. If no free block
+ * is large enough the buffer is grown (at least doubled) and the allocation
+ * retried, rather than failing.
+ */
+b8 allocate_geometry_range(vulkan_context *context, vulkan_buffer *buffer,
+                           u64 size, u64 *out_offset) {
+  if (vulkan_buffer_allocate(buffer, size, out_offset)) {
+    return true;
+  }
+
+  // Newly added space is always free, so make sure it alone fits the request.
+  u64 new_size = buffer->total_size * 2;
+  while (new_size - buffer->total_size < size) {
+    new_size *= 2;
+  }
+
+  OINFO("Growing geometry buffer from %lluB to %lluB.", buffer->total_size,
+        new_size);
+  // Pending copies target the current buffer handle, submit them before it is
+  // replaced.
+  if (!vulkan_staging_ring_flush(context, &context->staging)) {
+    return false;
+  }
+  if (!vulkan_buffer_resize(context, new_size, buffer,
+                            context->device.graphics_queue,
+                            context->device.graphics_command_pool)) {
+    OERROR("Failed to grow geometry buffer to %lluB.", new_size);
+    return false;
+  }
+
+  return vulkan_buffer_allocate(buffer, size, out_offset);
+}
+
+void release_pending_range_frees(vulkan_context *context, u32 frame) {
+  vulkan_pending_range_free *pending = context->pending_range_frees[frame];
+  u64 length = darray_length(pending);
+  for (u64 i = 0; i < length; ++i) {
+    vulkan_buffer_free(pending[i].buffer, pending[i].size, pending[i].offset);
+  }
+  darray_clear(pending);
+}
@@ -2,6 +2,7 @@
 
 #include "renderer/renderer_backend.h"
 #include "renderer/renderer_types.inl"
+#include "resources/resource_types.h"
 
 b8 vulkan_renderer_backend_initialize(renderer_backend *backend,
                                       const char *application_name,
@@ -18,8 +19,27 @@ void vulkan_renderer_backend_update_global_state(mat4 projection, mat4 view,
                                                  vec3 view_position,
                                                  vec4 ambient_color, i32 mode);
 
-void vulkan_renderer_draw_object(renderer_backend* backend, vertex_data* vert_data);
+b8 vulkan_renderer_create_geometry(renderer_backend *backend,
+                                   vertex_data *vert_data,
+                                   u32 *out_geometry_id);
 
-void vulkan_renderer_backend_create_texture();
+void vulkan_renderer_destroy_geometry(renderer_backend *backend,
+                                      u32 geometry_id);
+
+b8 vulkan_renderer_draw_instanced(renderer_backend *backend,
+                                  const mat4 *instance_transforms,
+                                  u32 instance_count,
+                                  const geometry_render_batch *batches,
+                                  u32 batch_count);
+
+b8 vulkan_renderer_get_gpu_frame_time(renderer_backend *backend,
+                                      f64 *out_submit_time,
+                                      f64 *out_frame_ms);
+
+b8 vulkan_renderer_create_texture(renderer_backend *backend, const u8 *pixels,
+                                  texture *texture);
+
+void vulkan_renderer_destroy_texture(renderer_backend *backend,
+                                     texture *texture);
 
 b8 vulkan_renderer_backend_end_frame(renderer_backend *backend, f32 delta_time);
@@ -9,11 +9,22 @@
 
 b8 vulkan_buffer_create(vulkan_context *context, u64 size,
                         VkBufferUsageFlagBits usage, u32 memory_property_flags,
-                        b8 bind_on_create, vulkan_buffer *out_buffer) {
+                        b8 bind_on_create, b8 use_freelist,
+                        vulkan_buffer *out_buffer) {
   ozero_memory(out_buffer, sizeof(vulkan_buffer));
   out_buffer->total_size = size;
   out_buffer->usage = usage;
   out_buffer->memory_property_flags = memory_property_flags;
+  out_buffer->has_freelist = use_freelist;
+
+  if (use_freelist) {
+    // Get the memory requirement, then create the freelist over the buffer.
+    freelist_create(size, &out_buffer->freelist_memory_requirement, 0, 0);
+    out_buffer->freelist_block = oallocate(
+        out_buffer->freelist_memory_requirement, MEMORY_TAG_RENDERER);
+    freelist_create(size, &out_buffer->freelist_memory_requirement,
+                    out_buffer->freelist_block, &out_buffer->buffer_freelist);
+  }
 
   VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
   buffer_info.size = size;
@@ -61,6 +72,14 @@ b8 vulkan_buffer_create(vulkan_context *context, u64 size,
 }
 
 void vulkan_buffer_destroy(vulkan_context *context, vulkan_buffer *buffer) {
+  if (buffer->freelist_block) {
+    freelist_destroy(&buffer->buffer_freelist);
+    ofree(buffer->freelist_block, buffer->freelist_memory_requirement,
+          MEMORY_TAG_RENDERER);
+    buffer->freelist_block = 0;
+    buffer->freelist_memory_requirement = 0;
+  }
+  buffer->has_freelist = false;
   if (buffer->memory) {
     vkFreeMemory(context->device.logical_device, buffer->memory,
                  context->allocator);
@@ -79,6 +98,12 @@ void vulkan_buffer_destroy(vulkan_context *context, vulkan_buffer *buffer) {
 b8 vulkan_buffer_resize(vulkan_context *context, u64 new_size,
                         vulkan_buffer *buffer, VkQueue queue,
                         VkCommandPool pool) {
+  if (new_size < buffer->total_size) {
+    OERROR("vulkan_buffer_resize requires that the new size be larger than "
+           "the old. Not doing this could lead to data loss.");
+    return false;
+  }
+
   // Create new buffer.
   VkBufferCreateInfo buffer_info = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
   buffer_info.size = new_size;
@@ -112,6 +137,17 @@ b8 vulkan_buffer_resize(vulkan_context *context, u64 new_size,
     return false;
   }
 
+  // Grow the freelist so the new space is available for allocation.
+  if (buffer->has_freelist &&
+      !freelist_resize(&buffer->buffer_freelist, new_size)) {
+    OERROR("vulkan_buffer_resize failed to resize the internal free list.");
+    vkFreeMemory(context->device.logical_device, new_memory,
+                 context->allocator);
+    vkDestroyBuffer(context->device.logical_device, new_buffer,
+                    context->allocator);
+    return false;
+  }
+
   // Bind the new buffer's memory
   VK_CHECK(vkBindBufferMemory(context->device.logical_device, new_buffer,
                               new_memory, 0));
@@ -143,6 +179,36 @@ b8 vulkan_buffer_resize(vulkan_context *context, u64 new_size,
   return true;
 }
 
+b8 vulkan_buffer_allocate(vulkan_buffer *buffer, u64 size, u64 *out_offset) {
+  if (!buffer || !size || !out_offset) {
+    OERROR("vulkan_buffer_allocate requires a valid buffer, a nonzero size and "
+           "a valid pointer to hold the offset.");
+    return false;
+  }
+
+  if (!buffer->has_freelist) {
+    OWARN("vulkan_buffer_allocate called on a buffer not using a freelist. "
+          "Offset will not be valid. Call vulkan_buffer_load_data instead.");
+    *out_offset = 0;
+    return true;
+  }
+  return freelist_allocate_block(&buffer->buffer_freelist, size, out_offset);
+}
+
+b8 vulkan_buffer_free(vulkan_buffer *buffer, u64 size, u64 offset) {
+  if (!buffer || !size) {
+    OERROR("vulkan_buffer_free requires a valid buffer and a nonzero size.");
+    return false;
+  }
+
+  if (!buffer->has_freelist) {
+    OWARN("vulkan_buffer_free called on a buffer not using a freelist. "
+          "Nothing was done.");
+    return true;
+  }
+  return freelist_free_block(&buffer->buffer_freelist, size, offset);
+}
+
 void vulkan_buffer_bind(vulkan_context *context, vulkan_buffer *buffer,
                         u64 offset) {
   VK_CHECK(vkBindBufferMemory(context->device.logical_device, buffer->handle,
@@ -176,7 +242,6 @@ void vulkan_buffer_copy_to(vulkan_context *context, VkCommandPool pool,
                            VkFence fence, VkQueue queue, VkBuffer source,
                            u64 source_offset, VkBuffer dest, u64 dest_offset,
                            u64 size) {
-  vkQueueWaitIdle(queue);
   // Create a one-time-use command buffer.
   vulkan_command_buffer temp_command_buffer;
   vulkan_command_buffer_allocate_and_begin_single_use(context, pool,
@@ -4,7 +4,8 @@
 
 b8 vulkan_buffer_create(vulkan_context *context, u64 size,
                         VkBufferUsageFlagBits usage, u32 memory_property_flags,
-                        b8 bind_on_create, vulkan_buffer *out_buffer);
+                        b8 bind_on_create, b8 use_freelist,
+                        vulkan_buffer *out_buffer);
 
 void vulkan_buffer_destroy(vulkan_context *context, vulkan_buffer *buffer);
 
@@ -12,6 +13,17 @@ b8 vulkan_buffer_resize(vulkan_context *context, u64 new_size,
                         vulkan_buffer *buffer, VkQueue queue,
                         VkCommandPool pool);
 
+/**
+ * @brief Reserves a range of size bytes within a buffer created with
+ * use_freelist. Does not grow the buffer; callers can resize and retry.
+ */
+b8 vulkan_buffer_allocate(vulkan_buffer *buffer, u64 size, u64 *out_offset);
+
+/**
+ * @brief Releases a range previously reserved with vulkan_buffer_allocate.
+ */
+b8 vulkan_buffer_free(vulkan_buffer *buffer, u64 size, u64 offset);
+
 void vulkan_buffer_bind(vulkan_context *context, vulkan_buffer *buffer,
                         u64 offset);
 
@@ -125,6 +125,14 @@ b8 vulkan_device_create(vulkan_context *context) {
                                &context->device.graphics_command_pool));
   OINFO("Graphics command pool created.");
 
+  // Create command pool for transfer queue. Used for uploads, which may run
+  // on a separate queue family to graphics.
+  pool_create_info.queueFamilyIndex = context->device.transfer_queue_index;
+  VK_CHECK(vkCreateCommandPool(context->device.logical_device,
+                               &pool_create_info, context->allocator,
+                               &context->device.transfer_command_pool));
+  OINFO("Transfer command pool created.");
+
   return true;
 }
 
@@ -138,6 +146,9 @@ void vulkan_device_destroy(vulkan_context *context) {
   vkDestroyCommandPool(context->device.logical_device,
                        context->device.graphics_command_pool,
                        context->allocator);
+  vkDestroyCommandPool(context->device.logical_device,
+                       context->device.transfer_command_pool,
+                       context->allocator);
 
   // Destroy logical device
   OINFO("Destroying logical device...");
@@ -0,0 +1,113 @@
+#include "vulkan_gpu_timer.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+#include "platform/platform.h"
+
+void vulkan_gpu_timer_create(vulkan_context *context, u32 frame_count,
+                             vulkan_gpu_timer *out_timer) {
+  ozero_memory(out_timer, sizeof(vulkan_gpu_timer));
+  if (frame_count > VULKAN_MAX_TIMED_FRAMES) {
+    OWARN("GPU timer supports at most %u frames in flight, got %u.",
+          VULKAN_MAX_TIMED_FRAMES, frame_count);
+    return;
+  }
+
+  // Not every queue family writes timestamps, and some write fewer bits.
+  u32 family_count = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(context->device.physical_device,
+                                           &family_count, 0);
+  VkQueueFamilyProperties families[32];
+  if (family_count > 32) {
+    family_count = 32;
+  }
+  vkGetPhysicalDeviceQueueFamilyProperties(context->device.physical_device,
+                                           &family_count, families);
+  u32 graphics_index = (u32)context->device.graphics_queue_index;
+  u32 valid_bits = graphics_index < family_count
+                       ? families[graphics_index].timestampValidBits
+                       : 0;
+  f32 period = context->device.properties.limits.timestampPeriod;
+  if (valid_bits == 0 || period <= 0.0f) {
+    OINFO("Graphics queue does not support timestamps; GPU frame times are "
+          "unavailable.");
+    return;
+  }
+
+  VkQueryPoolCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+  create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  create_info.queryCount = frame_count * 2;
+  VkResult result =
+      vkCreateQueryPool(context->device.logical_device, &create_info,
+                        context->allocator, &out_timer->query_pool);
+  if (result != VK_SUCCESS) {
+    OWARN("Failed to create timestamp query pool; GPU frame times are "
+          "unavailable.");
+    return;
+  }
+
+  out_timer->supported = true;
+  out_timer->frame_count = frame_count;
+  // timestampPeriod is in nanoseconds per tick.
+  out_timer->period_ms = (f64)period / 1000000.0;
+  out_timer->valid_mask =
+      valid_bits >= 64 ? ~(u64)0 : (((u64)1 << valid_bits) - 1);
+}
+
+void vulkan_gpu_timer_destroy(vulkan_context *context,
+                              vulkan_gpu_timer *timer) {
+  if (timer->query_pool) {
+    vkDestroyQueryPool(context->device.logical_device, timer->query_pool,
+                       context->allocator);
+  }
+  ozero_memory(timer, sizeof(vulkan_gpu_timer));
+}
+
+void vulkan_gpu_timer_collect(vulkan_context *context, vulkan_gpu_timer *timer,
+                              u32 frame) {
+  if (!timer->supported || !timer->pending[frame]) {
+    return;
+  }
+  timer->pending[frame] = false;
+
+  u64 timestamps[2];
+  VkResult result = vkGetQueryPoolResults(
+      context->device.logical_device, timer->query_pool, frame * 2, 2,
+      sizeof(timestamps), timestamps, sizeof(u64), VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS) {
+    return;
+  }
+
+  u64 begin = timestamps[0] & timer->valid_mask;
+  u64 end = timestamps[1] & timer->valid_mask;
+  // Account for the counter wrapping between the two writes.
+  u64 ticks = (end - begin) & timer->valid_mask;
+  timer->last_frame_ms = (f64)ticks * timer->period_ms;
+  timer->last_submit_time = timer->submit_times[frame];
+  timer->has_result = true;
+}
+
+void vulkan_gpu_timer_begin(vulkan_gpu_timer *timer,
+                            vulkan_command_buffer *command_buffer, u32 frame) {
+  if (!timer->supported) {
+    return;
+  }
+  vkCmdResetQueryPool(command_buffer->handle, timer->query_pool, frame * 2, 2);
+  vkCmdWriteTimestamp(command_buffer->handle,
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timer->query_pool,
+                      frame * 2);
+}
+
+void vulkan_gpu_timer_end(vulkan_gpu_timer *timer,
+                          vulkan_command_buffer *command_buffer, u32 frame) {
+  if (!timer->supported) {
+    return;
+  }
+  vkCmdWriteTimestamp(command_buffer->handle,
+                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timer->query_pool,
+                      frame * 2 + 1);
+  timer->pending[frame] = true;
+  // Close enough to the actual submit, which follows immediately.
+  timer->submit_times[frame] = platform_get_absolute_time();
+}
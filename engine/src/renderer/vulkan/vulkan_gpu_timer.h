@@ -0,0 +1,34 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * Creates a timer for frame_count frames in flight. If the graphics queue
+ * can't write timestamps the timer is left unsupported and every other call
+ * does nothing.
+ */
+void vulkan_gpu_timer_create(vulkan_context *context, u32 frame_count,
+                             vulkan_gpu_timer *out_timer);
+
+void vulkan_gpu_timer_destroy(vulkan_context *context,
+                              vulkan_gpu_timer *timer);
+
+/**
+ * Reads back the timestamps last written for frame. Must only be called once
+ * that frame's fence has been waited on.
+ */
+void vulkan_gpu_timer_collect(vulkan_context *context, vulkan_gpu_timer *timer,
+                              u32 frame);
+
+/**
+ * Resets frame's queries and writes the start timestamp. Call at the start of
+ * the frame's command buffer, outside of a render pass.
+ */
+void vulkan_gpu_timer_begin(vulkan_gpu_timer *timer,
+                            vulkan_command_buffer *command_buffer, u32 frame);
+
+/**
+ * Writes the end timestamp once all of the frame's commands have completed.
+ */
+void vulkan_gpu_timer_end(vulkan_gpu_timer *timer,
+                          vulkan_command_buffer *command_buffer, u32 frame);
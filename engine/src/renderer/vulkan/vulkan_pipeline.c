@@ -5,7 +5,8 @@
 #include "vulkan_utils.h"
 
 b8 vulkan_graphics_pipeline_create(
-    vulkan_context *context, vulkan_renderpass *renderpass, u32 attribute_count,
+    vulkan_context *context, vulkan_renderpass *renderpass, u32 binding_count,
+    VkVertexInputBindingDescription *bindings, u32 attribute_count,
     VkVertexInputAttributeDescription *attributes,
     u32 descriptor_set_layout_count,
     VkDescriptorSetLayout *descriptor_set_layouts, u32 stage_count,
@@ -90,18 +91,11 @@ b8 vulkan_graphics_pipeline_create(
   dynamic_state_create_info.dynamicStateCount = dynamic_state_count;
   dynamic_state_create_info.pDynamicStates = dynamic_states;
 
-  // Vertex input
-  VkVertexInputBindingDescription binding_description;
-  binding_description.binding = 0; // Binding index
-  binding_description.stride = sizeof(vertex_3d);
-  binding_description.inputRate =
-      VK_VERTEX_INPUT_RATE_VERTEX; // Move to next data entry for each vertex.
-
-  // Attributes
+  // Vertex input bindings and attributes
   VkPipelineVertexInputStateCreateInfo vertex_input_info = {
       VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-  vertex_input_info.vertexBindingDescriptionCount = 1;
-  vertex_input_info.pVertexBindingDescriptions = &binding_description;
+  vertex_input_info.vertexBindingDescriptionCount = binding_count;
+  vertex_input_info.pVertexBindingDescriptions = bindings;
   vertex_input_info.vertexAttributeDescriptionCount = attribute_count;
   vertex_input_info.pVertexAttributeDescriptions = attributes;
 
@@ -150,8 +144,8 @@ b8 vulkan_graphics_pipeline_create(
   pipeline_create_info.basePipelineIndex = -1;
 
   VkResult result = vkCreateGraphicsPipelines(
-      context->device.logical_device, VK_NULL_HANDLE, 1, &pipeline_create_info,
-      context->allocator, &out_pipeline->handle);
+      context->device.logical_device, context->pipeline_cache, 1,
+      &pipeline_create_info, context->allocator, &out_pipeline->handle);
 
   if (vulkan_result_is_success(result)) {
     ODEBUG("Graphics pipeline created!");
@@ -3,7 +3,8 @@
 #include "vulkan_types.inl"
 
 b8 vulkan_graphics_pipeline_create(
-    vulkan_context *context, vulkan_renderpass *renderpass, u32 attribute_count,
+    vulkan_context *context, vulkan_renderpass *renderpass, u32 binding_count,
+    VkVertexInputBindingDescription *bindings, u32 attribute_count,
     VkVertexInputAttributeDescription *attributes,
     u32 descriptor_set_layout_count,
     VkDescriptorSetLayout *descriptor_set_layouts, u32 stage_count,
@@ -0,0 +1,143 @@
+#include "vulkan_pipeline_cache.h"
+#include "vulkan_utils.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
+#include "platform/filesystem.h"
+
+// Size of VkPipelineCacheHeaderVersionOne: header size, header version,
+// vendor id and device id, followed by the cache UUID.
+#define PIPELINE_CACHE_HEADER_SIZE (sizeof(u32) * 4 + VK_UUID_SIZE)
+
+/**
+ * @brief Checks that data was produced by this driver and device, so it can
+ * be handed to vkCreatePipelineCache. Drivers are expected to reject bad data
+ * themselves, but not all of them do so gracefully.
+ */
+static b8 header_is_valid(vulkan_context *context, const u8 *data, u64 size) {
+  if (size < PIPELINE_CACHE_HEADER_SIZE) {
+    return false;
+  }
+
+  // Read field by field; the file data has no alignment guarantees.
+  u32 fields[4];
+  ocopy_memory(fields, data, sizeof(fields));
+  u32 header_size = fields[0];
+  u32 header_version = fields[1];
+  u32 vendor_id = fields[2];
+  u32 device_id = fields[3];
+  const u8 *uuid = data + sizeof(fields);
+
+  VkPhysicalDeviceProperties *properties = &context->device.properties;
+  if (header_size < PIPELINE_CACHE_HEADER_SIZE || header_size > size ||
+      header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+    OWARN("Pipeline cache header is malformed, ignoring cache.");
+    return false;
+  }
+  if (vendor_id != properties->vendorID ||
+      device_id != properties->deviceID) {
+    OINFO("Pipeline cache was created for a different device, ignoring "
+          "cache.");
+    return false;
+  }
+  for (u32 i = 0; i < VK_UUID_SIZE; ++i) {
+    if (uuid[i] != properties->pipelineCacheUUID[i]) {
+      OINFO("Pipeline cache was created by a different driver version, "
+            "ignoring cache.");
+      return false;
+    }
+  }
+  return true;
+}
+
+b8 vulkan_pipeline_cache_create(vulkan_context *context, const char *path) {
+  u8 *data = 0;
+  u64 size = 0;
+
+  if (path && filesystem_exists(path)) {
+    file_handle handle;
+    if (filesystem_open(path, FILE_MODE_READ, true, &handle)) {
+      if (!filesystem_read_all_bytes(&handle, &data, &size)) {
+        OWARN("Unable to read pipeline cache: %s.", path);
+      }
+      filesystem_close(&handle);
+    }
+  }
+
+  VkPipelineCacheCreateInfo create_info = {
+      VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+  if (data && header_is_valid(context, data, size)) {
+    create_info.initialDataSize = size;
+    create_info.pInitialData = data;
+    ODEBUG("Seeding pipeline cache with %lluB from %s.", size, path);
+  }
+
+  VkResult result =
+      vkCreatePipelineCache(context->device.logical_device, &create_info,
+                            context->allocator, &context->pipeline_cache);
+  if (result != VK_SUCCESS && create_info.pInitialData) {
+    // The data passed our checks but the driver still refused it.
+    OWARN("Pipeline cache data rejected, starting with an empty cache.");
+    create_info.initialDataSize = 0;
+    create_info.pInitialData = 0;
+    result = vkCreatePipelineCache(context->device.logical_device,
+                                   &create_info, context->allocator,
+                                   &context->pipeline_cache);
+  }
+
+  if (data) {
+    ofree(data, sizeof(u8) * size, MEMORY_TAG_STRING);
+  }
+
+  if (!vulkan_result_is_success(result)) {
+    OERROR("vkCreatePipelineCache failed with %s.",
+           vulkan_result_string(result, true));
+    context->pipeline_cache = VK_NULL_HANDLE;
+    return false;
+  }
+  return true;
+}
+
+b8 vulkan_pipeline_cache_save(vulkan_context *context, const char *path) {
+  if (!context->pipeline_cache || !path) {
+    return false;
+  }
+
+  VkDevice device = context->device.logical_device;
+  size_t size = 0;
+  VK_CHECK(vkGetPipelineCacheData(device, context->pipeline_cache, &size, 0));
+  if (size == 0) {
+    return true;
+  }
+
+  u8 *data = oallocate_uninit(size, MEMORY_TAG_RENDERER);
+  VkResult result =
+      vkGetPipelineCacheData(device, context->pipeline_cache, &size, data);
+  b8 saved = false;
+  if (vulkan_result_is_success(result)) {
+    file_handle handle;
+    if (filesystem_open(path, FILE_MODE_WRITE, true, &handle)) {
+      u64 written = 0;
+      saved = filesystem_write(&handle, size, data, &written) &&
+              written == size;
+      filesystem_close(&handle);
+    }
+  }
+  ofree(data, size, MEMORY_TAG_RENDERER);
+
+  if (!saved) {
+    OWARN("Unable to save pipeline cache to %s.", path);
+    return false;
+  }
+  ODEBUG("Saved %lluB pipeline cache to %s.", (u64)size, path);
+  return true;
+}
+
+void vulkan_pipeline_cache_destroy(vulkan_context *context) {
+  if (context->pipeline_cache) {
+    vkDestroyPipelineCache(context->device.logical_device,
+                           context->pipeline_cache, context->allocator);
+    context->pipeline_cache = VK_NULL_HANDLE;
+  }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+/**
+ * Creates the context's pipeline cache, seeded from the file at path if it
+ * exists and its header matches the current device. A missing or mismatched
+ * file just results in an empty cache.
+ */
+b8 vulkan_pipeline_cache_create(vulkan_context *context, const char *path);
+
+/**
+ * Writes the pipeline cache's current contents to path.
+ */
+b8 vulkan_pipeline_cache_save(vulkan_context *context, const char *path);
+
+void vulkan_pipeline_cache_destroy(vulkan_context *context);
@@ -0,0 +1,426 @@
+#include "vulkan_staging.h"
+
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_fence.h"
+#include "vulkan_utils.h"
+
+#include "containers/darray.h"
+#include "core/logger.h"
+#include "core/omemory.h"
+
+// Offsets into the ring are aligned to this, which satisfies the texel size
+// requirement of buffer to image copies.
+#define STAGING_ALIGNMENT 16
+
+// Stages the uploaded resources may be consumed at on the graphics queue.
+#define STAGING_CONSUMER_STAGES                                                \
+  (VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |  \
+   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
+
+static b8 reserve(vulkan_context *context, vulkan_staging_ring *ring, u64 size,
+                  u64 *out_offset);
+static b8 submit_with_ownership_transfer(vulkan_context *context,
+                                         vulkan_staging_ring *ring);
+
+b8 vulkan_staging_ring_create(vulkan_context *context, u64 region_size,
+                              u32 region_count,
+                              vulkan_staging_ring *out_ring) {
+  ozero_memory(out_ring, sizeof(vulkan_staging_ring));
+  if (region_count > VULKAN_MAX_STAGING_REGIONS) {
+    OWARN("vulkan_staging_ring_create - %u regions requested, clamping to %u.",
+          region_count, VULKAN_MAX_STAGING_REGIONS);
+    region_count = VULKAN_MAX_STAGING_REGIONS;
+  }
+  out_ring->region_size = region_size;
+  out_ring->region_count = region_count;
+
+  u64 total_size = region_size * region_count;
+  if (!vulkan_buffer_create(context, total_size,
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                            true, false, &out_ring->buffer)) {
+    OERROR("Failed to create staging ring buffer.");
+    return false;
+  }
+
+  // Mapped for the lifetime of the ring.
+  out_ring->mapped =
+      vulkan_buffer_lock_memory(context, &out_ring->buffer, 0, total_size, 0);
+
+  out_ring->needs_ownership_transfer = context->device.transfer_queue_index !=
+                                       context->device.graphics_queue_index;
+
+  for (u32 i = 0; i < region_count; ++i) {
+    vulkan_command_buffer_allocate(context,
+                                   context->device.transfer_command_pool, true,
+                                   &out_ring->command_buffers[i]);
+    // Signaled, as no region has been submitted yet.
+    vulkan_fence_create(context, true, &out_ring->fences[i]);
+
+    if (out_ring->needs_ownership_transfer) {
+      vulkan_command_buffer_allocate(context,
+                                     context->device.graphics_command_pool,
+                                     true,
+                                     &out_ring->acquire_command_buffers[i]);
+      VkSemaphoreCreateInfo semaphore_create_info = {
+          VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+      VK_CHECK(vkCreateSemaphore(context->device.logical_device,
+                                 &semaphore_create_info, context->allocator,
+                                 &out_ring->transfer_complete_semaphores[i]));
+    }
+  }
+
+  if (out_ring->needs_ownership_transfer) {
+    out_ring->pending_buffer_acquires = darray_create(VkBufferMemoryBarrier);
+    out_ring->pending_image_acquires = darray_create(VkImageMemoryBarrier);
+  }
+
+  ODEBUG("Staging ring created: %u regions of %lluB, %s transfer queue.",
+         region_count, region_size,
+         out_ring->needs_ownership_transfer ? "dedicated" : "shared");
+  return true;
+}
+
+void vulkan_staging_ring_destroy(vulkan_context *context,
+                                 vulkan_staging_ring *ring) {
+  for (u32 i = 0; i < ring->region_count; ++i) {
+    vulkan_fence_wait(context, &ring->fences[i], UINT64_MAX);
+    vulkan_fence_destroy(context, &ring->fences[i]);
+    if (ring->command_buffers[i].handle) {
+      vulkan_command_buffer_free(context,
+                                 context->device.transfer_command_pool,
+                                 &ring->command_buffers[i]);
+    }
+    if (ring->acquire_command_buffers[i].handle) {
+      vulkan_command_buffer_free(context,
+                                 context->device.graphics_command_pool,
+                                 &ring->acquire_command_buffers[i]);
+    }
+    if (ring->transfer_complete_semaphores[i]) {
+      vkDestroySemaphore(context->device.logical_device,
+                         ring->transfer_complete_semaphores[i],
+                         context->allocator);
+    }
+  }
+  if (ring->pending_buffer_acquires) {
+    darray_destroy(ring->pending_buffer_acquires);
+  }
+  if (ring->pending_image_acquires) {
+    darray_destroy(ring->pending_image_acquires);
+  }
+
+  if (ring->mapped) {
+    vulkan_buffer_unlock_memory(context, &ring->buffer);
+    ring->mapped = 0;
+  }
+  vulkan_buffer_destroy(context, &ring->buffer);
+  ozero_memory(ring, sizeof(vulkan_staging_ring));
+}
+
+b8 vulkan_staging_upload_buffer(vulkan_context *context,
+                                vulkan_staging_ring *ring,
+                                vulkan_buffer *dest, u64 dest_offset, u64 size,
+                                const void *data) {
+  // Split anything larger than a region into region sized chunks.
+  u64 copied = 0;
+  while (copied < size) {
+    u64 chunk_size = size - copied;
+    if (chunk_size > ring->region_size) {
+      chunk_size = ring->region_size;
+    }
+
+    u64 staging_offset;
+    if (!reserve(context, ring, chunk_size, &staging_offset)) {
+      OERROR("vulkan_staging_upload_buffer failed to reserve %lluB.",
+             chunk_size);
+      return false;
+    }
+    ocopy_memory(ring->mapped + staging_offset, (const u8 *)data + copied,
+                 chunk_size);
+
+    VkBufferCopy copy_region;
+    copy_region.srcOffset = staging_offset;
+    copy_region.dstOffset = dest_offset + copied;
+    copy_region.size = chunk_size;
+    vkCmdCopyBuffer(ring->command_buffers[ring->current_region].handle,
+                    ring->buffer.handle, dest->handle, 1, &copy_region);
+
+    if (ring->needs_ownership_transfer) {
+      // Hand the written range over to graphics when the region is flushed.
+      VkBufferMemoryBarrier acquire = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+      acquire.srcQueueFamilyIndex = context->device.transfer_queue_index;
+      acquire.dstQueueFamilyIndex = context->device.graphics_queue_index;
+      acquire.buffer = dest->handle;
+      acquire.offset = copy_region.dstOffset;
+      acquire.size = chunk_size;
+      darray_push(ring->pending_buffer_acquires, acquire);
+    }
+
+    copied += chunk_size;
+  }
+
+  return true;
+}
+
+b8 vulkan_staging_upload_image(vulkan_context *context,
+                               vulkan_staging_ring *ring, vulkan_image *image,
+                               u32 width, u32 height, const void *pixels) {
+  u64 size = (u64)width * height * 4;
+  if (size > ring->region_size) {
+    OERROR("vulkan_staging_upload_image - image of %lluB does not fit in a "
+           "staging region of %lluB.",
+           size, ring->region_size);
+    return false;
+  }
+
+  u64 staging_offset;
+  if (!reserve(context, ring, size, &staging_offset)) {
+    OERROR("vulkan_staging_upload_image failed to reserve %lluB.", size);
+    return false;
+  }
+  ocopy_memory(ring->mapped + staging_offset, pixels, size);
+
+  VkCommandBuffer command_buffer =
+      ring->command_buffers[ring->current_region].handle;
+
+  VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image->handle;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  // Undefined -> transfer destination
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1,
+                       &barrier);
+
+  VkBufferImageCopy region;
+  ozero_memory(&region, sizeof(VkBufferImageCopy));
+  region.bufferOffset = staging_offset;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent.width = width;
+  region.imageExtent.height = height;
+  region.imageExtent.depth = 1;
+  vkCmdCopyBufferToImage(command_buffer, ring->buffer.handle, image->handle,
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  // Transfer destination -> shader read
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  if (ring->needs_ownership_transfer) {
+    // The transition happens as part of the release/acquire pair on flush.
+    barrier.srcQueueFamilyIndex = context->device.transfer_queue_index;
+    barrier.dstQueueFamilyIndex = context->device.graphics_queue_index;
+    darray_push(ring->pending_image_acquires, barrier);
+  } else {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0,
+                         1, &barrier);
+  }
+
+  return true;
+}
+
+b8 vulkan_staging_ring_flush(vulkan_context *context,
+                             vulkan_staging_ring *ring) {
+  if (!ring->is_recording) {
+    return true;
+  }
+
+  if (ring->needs_ownership_transfer) {
+    if (!submit_with_ownership_transfer(context, ring)) {
+      return false;
+    }
+  } else {
+    vulkan_command_buffer *command_buffer =
+        &ring->command_buffers[ring->current_region];
+
+    // Same queue as graphics. Make the copies visible to anything submitted
+    // to it afterwards.
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+        VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer->handle,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         STAGING_CONSUMER_STAGES, 0, 1, &barrier, 0, 0, 0, 0);
+
+    vulkan_command_buffer_end(command_buffer);
+
+    vulkan_fence *fence = &ring->fences[ring->current_region];
+    vulkan_fence_reset(context, fence);
+
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer->handle;
+    VkResult result = vkQueueSubmit(context->device.transfer_queue, 1,
+                                    &submit_info, fence->handle);
+    if (result != VK_SUCCESS) {
+      OERROR("vulkan_staging_ring_flush vkQueueSubmit failed with result: %s",
+             vulkan_result_string(result, true));
+      return false;
+    }
+    vulkan_command_buffer_update_submitted(command_buffer);
+  }
+  ring->is_recording = false;
+
+  // Move on to the next region. It was submitted region_count flushes ago, so
+  // this is normally already signaled and doesn't block.
+  ring->current_region = (ring->current_region + 1) % ring->region_count;
+  ring->region_offset = 0;
+  if (!vulkan_fence_wait(context, &ring->fences[ring->current_region],
+                         UINT64_MAX)) {
+    OERROR("vulkan_staging_ring_flush failed waiting on staging region %u.",
+           ring->current_region);
+    return false;
+  }
+  vulkan_command_buffer_reset(&ring->command_buffers[ring->current_region]);
+  if (ring->needs_ownership_transfer) {
+    vulkan_command_buffer_reset(
+        &ring->acquire_command_buffers[ring->current_region]);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Releases everything uploaded in the current region from the transfer
+ * family and submits it, then acquires it on the graphics queue in a second
+ * submission that waits on the transfer's semaphore. The region's fence is
+ * signaled by the acquire, so covers both submissions.
+ */
+static b8 submit_with_ownership_transfer(vulkan_context *context,
+                                         vulkan_staging_ring *ring) {
+  u32 region = ring->current_region;
+  vulkan_command_buffer *transfer_buffer = &ring->command_buffers[region];
+  vulkan_command_buffer *acquire_buffer =
+      &ring->acquire_command_buffers[region];
+  u32 buffer_barrier_count = darray_length(ring->pending_buffer_acquires);
+  u32 image_barrier_count = darray_length(ring->pending_image_acquires);
+
+  // Release. The same barriers are recorded on both sides, only the access
+  // masks differ.
+  for (u32 i = 0; i < buffer_barrier_count; ++i) {
+    ring->pending_buffer_acquires[i].srcAccessMask =
+        VK_ACCESS_TRANSFER_WRITE_BIT;
+    ring->pending_buffer_acquires[i].dstAccessMask = 0;
+  }
+  for (u32 i = 0; i < image_barrier_count; ++i) {
+    ring->pending_image_acquires[i].srcAccessMask =
+        VK_ACCESS_TRANSFER_WRITE_BIT;
+    ring->pending_image_acquires[i].dstAccessMask = 0;
+  }
+  vkCmdPipelineBarrier(transfer_buffer->handle, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0,
+                       buffer_barrier_count, ring->pending_buffer_acquires,
+                       image_barrier_count, ring->pending_image_acquires);
+  vulkan_command_buffer_end(transfer_buffer);
+
+  VkSubmitInfo transfer_submit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  transfer_submit.commandBufferCount = 1;
+  transfer_submit.pCommandBuffers = &transfer_buffer->handle;
+  transfer_submit.signalSemaphoreCount = 1;
+  transfer_submit.pSignalSemaphores =
+      &ring->transfer_complete_semaphores[region];
+  VkResult result =
+      vkQueueSubmit(context->device.transfer_queue, 1, &transfer_submit, 0);
+  if (result != VK_SUCCESS) {
+    OERROR("vulkan_staging_ring_flush transfer vkQueueSubmit failed with "
+           "result: %s",
+           vulkan_result_string(result, true));
+    return false;
+  }
+  vulkan_command_buffer_update_submitted(transfer_buffer);
+
+  // Acquire
+  for (u32 i = 0; i < buffer_barrier_count; ++i) {
+    ring->pending_buffer_acquires[i].srcAccessMask = 0;
+    ring->pending_buffer_acquires[i].dstAccessMask =
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+        VK_ACCESS_TRANSFER_READ_BIT;
+  }
+  for (u32 i = 0; i < image_barrier_count; ++i) {
+    ring->pending_image_acquires[i].srcAccessMask = 0;
+    ring->pending_image_acquires[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  }
+  vulkan_command_buffer_begin(acquire_buffer, true, false, false);
+  vkCmdPipelineBarrier(acquire_buffer->handle,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       STAGING_CONSUMER_STAGES, 0, 0, 0, buffer_barrier_count,
+                       ring->pending_buffer_acquires, image_barrier_count,
+                       ring->pending_image_acquires);
+  vulkan_command_buffer_end(acquire_buffer);
+
+  darray_clear(ring->pending_buffer_acquires);
+  darray_clear(ring->pending_image_acquires);
+
+  vulkan_fence *fence = &ring->fences[region];
+  vulkan_fence_reset(context, fence);
+
+  VkPipelineStageFlags wait_stage = STAGING_CONSUMER_STAGES;
+  VkSubmitInfo acquire_submit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+  acquire_submit.commandBufferCount = 1;
+  acquire_submit.pCommandBuffers = &acquire_buffer->handle;
+  acquire_submit.waitSemaphoreCount = 1;
+  acquire_submit.pWaitSemaphores = &ring->transfer_complete_semaphores[region];
+  acquire_submit.pWaitDstStageMask = &wait_stage;
+  result = vkQueueSubmit(context->device.graphics_queue, 1, &acquire_submit,
+                         fence->handle);
+  if (result != VK_SUCCESS) {
+    OERROR("vulkan_staging_ring_flush acquire vkQueueSubmit failed with "
+           "result: %s",
+           vulkan_result_string(result, true));
+    return false;
+  }
+  vulkan_command_buffer_update_submitted(acquire_buffer);
+
+  return true;
+}
+
+/**
+ * @brief Reserves size bytes in the current region, flushing and moving to
+ * the next region if it doesn't fit. Begins recording if needed.
+ * @param out_offset The offset from the start of the ring buffer.
+ */
+static b8 reserve(vulkan_context *context, vulkan_staging_ring *ring, u64 size,
+                  u64 *out_offset) {
+  if (size > ring->region_size) {
+    return false;
+  }
+
+  u64 offset = (ring->region_offset + (STAGING_ALIGNMENT - 1)) &
+               ~((u64)STAGING_ALIGNMENT - 1);
+  if (offset + size > ring->region_size) {
+    if (!vulkan_staging_ring_flush(context, ring)) {
+      return false;
+    }
+    offset = 0;
+  }
+
+  if (!ring->is_recording) {
+    vulkan_command_buffer_begin(&ring->command_buffers[ring->current_region],
+                                true, false, false);
+    ring->is_recording = true;
+  }
+
+  ring->region_offset = offset + size;
+  *out_offset = (ring->current_region * ring->region_size) + offset;
+  return true;
+}
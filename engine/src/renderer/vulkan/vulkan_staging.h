@@ -0,0 +1,43 @@
+#pragma once
+
+#include "vulkan_types.inl"
+
+b8 vulkan_staging_ring_create(vulkan_context *context, u64 region_size,
+                              u32 region_count,
+                              vulkan_staging_ring *out_ring);
+
+/**
+ * Waits for any outstanding uploads and destroys the ring. Copies recorded but
+ * not yet flushed are discarded.
+ */
+void vulkan_staging_ring_destroy(vulkan_context *context,
+                                 vulkan_staging_ring *ring);
+
+/**
+ * Copies data into the ring and records a copy into dest at dest_offset. The
+ * copy is not executed until the next vulkan_staging_ring_flush. Uploads
+ * larger than a region are split across regions.
+ */
+b8 vulkan_staging_upload_buffer(vulkan_context *context,
+                                vulkan_staging_ring *ring,
+                                vulkan_buffer *dest, u64 dest_offset, u64 size,
+                                const void *data);
+
+/**
+ * Copies RGBA8 pixel data into the ring and records the layout transitions and
+ * copy to leave image ready for sampling after the next flush. The whole image
+ * must fit in one region.
+ */
+b8 vulkan_staging_upload_image(vulkan_context *context,
+                               vulkan_staging_ring *ring, vulkan_image *image,
+                               u32 width, u32 height, const void *pixels);
+
+/**
+ * Submits all uploads recorded in the current region as one batch on the
+ * transfer queue and moves on to the next region. Does not wait on the
+ * submission. Graphics work submitted afterwards is ordered after the copies,
+ * either by a barrier when the queue is shared, or by a queue family ownership
+ * transfer to the graphics queue synchronized with a semaphore.
+ */
+b8 vulkan_staging_ring_flush(vulkan_context *context,
+                             vulkan_staging_ring *ring);
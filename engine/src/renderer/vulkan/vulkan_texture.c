@@ -1,6 +1,12 @@
 
 #include "vulkan_texture.h"
 
+#include "vulkan_image.h"
+#include "vulkan_staging.h"
+
+#include "core/logger.h"
+#include "core/omemory.h"
+
 void vulkan_texture_create_sampler(vulkan_context *context,
                                    VkSampler *out_texture_sampler) {
   VkSamplerCreateInfo sampler_info = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
@@ -31,4 +37,32 @@ void vulkan_texture_create_sampler(vulkan_context *context,
                            context->allocator, out_texture_sampler));
 }
 
-void vulkan_texture_create() {}
\ No newline at end of file
+b8 vulkan_texture_create(vulkan_context *context, u32 width, u32 height,
+                         const u8 *pixels, vulkan_texture *out_texture) {
+  vulkan_image_create(
+      context, VK_IMAGE_TYPE_2D, width, height, VK_FORMAT_R8G8B8A8_SRGB,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_COLOR_BIT,
+      &out_texture->image);
+
+  // Executed with the next frame's uploads.
+  if (!vulkan_staging_upload_image(context, &context->staging,
+                                   &out_texture->image, width, height,
+                                   pixels)) {
+    OERROR("vulkan_texture_create failed to upload %ux%u pixels.", width,
+           height);
+    vulkan_image_destroy(context, &out_texture->image);
+    return false;
+  }
+
+  vulkan_texture_create_sampler(context, &out_texture->sampler);
+  return true;
+}
+
+void vulkan_texture_destroy(vulkan_context *context, vulkan_texture *texture) {
+  vkDestroySampler(context->device.logical_device, texture->sampler,
+                   context->allocator);
+  vulkan_image_destroy(context, &texture->image);
+  ozero_memory(texture, sizeof(vulkan_texture));
+}
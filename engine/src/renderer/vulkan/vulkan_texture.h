@@ -1,7 +1,15 @@
+#pragma once
+
 #include "vulkan_types.inl"
 
-void vulkan_texture_create();
+/**
+ * Creates a sampled RGBA8 texture and queues its pixels on the staging ring.
+ * The texture is ready for sampling once the ring is next flushed.
+ */
+b8 vulkan_texture_create(vulkan_context *context, u32 width, u32 height,
+                         const u8 *pixels, vulkan_texture *out_texture);
+
+void vulkan_texture_destroy(vulkan_context *context, vulkan_texture *texture);
 
 void vulkan_texture_create_sampler(vulkan_context *context,
                                    VkSampler* out_texture_sampler);
-
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "containers/freelist.h"
 #include "core/asserts.h"
 #include "defines.h"
 
@@ -19,6 +20,11 @@ typedef struct vulkan_buffer {
     VkDeviceMemory memory;
     i32 memory_index;
     u32 memory_property_flags;
+    // Sub-allocation of the buffer's range, only if created with use_freelist
+    b8 has_freelist;
+    u64 freelist_memory_requirement;
+    void *freelist_block;
+    freelist buffer_freelist;
 } vulkan_buffer;
 
 typedef struct vulkan_swapchain_support_info {
@@ -42,6 +48,7 @@ typedef struct vulkan_device {
   VkQueue transfer_queue;
 
   VkCommandPool graphics_command_pool;
+  VkCommandPool transfer_command_pool;
 
   VkPhysicalDeviceProperties properties;
   VkPhysicalDeviceFeatures features;
@@ -146,12 +153,18 @@ typedef struct vulkan_object_shader {
   // Descriptors
   VkDescriptorPool global_descriptor_pool;
   VkDescriptorSetLayout global_descriptor_set_layout; 
-  // One per frame - triple buffering
-  VkDescriptorSet global_descriptor_sets[3];
+  // Written once; the UBO region for each frame is picked with a dynamic
+  // offset when binding
+  VkDescriptorSet global_descriptor_set;
 
   global_uniform_object global_ubo;
 
-  vulkan_buffer global_uniform_buffer; // where the data actually is
+  // where the data actually is, one region per frame in flight
+  vulkan_buffer global_uniform_buffer;
+  // Persistently mapped global_uniform_buffer
+  u8 *global_uniform_buffer_mapped;
+  // Size of each frame's region, aligned to minUniformBufferOffsetAlignment
+  u64 global_ubo_stride;
 
   vulkan_pipeline pipeline;
 
@@ -159,6 +172,107 @@ typedef struct vulkan_object_shader {
   
 } vulkan_object_shader;
 
+/**
+ * @brief Internal record of a piece of geometry which has been uploaded once
+ * into the shared object vertex/index buffers.
+ * @param id - Index of this record in the context's geometry array, or
+ * INVALID_ID if the slot is free.
+ * @param generation - Incremented every time the slot is (re)used.
+ * @param vertex_buffer_offset - Offset in bytes into object_vertex_buffer.
+ * @param index_buffer_offset - Offset in bytes into object_index_buffer.
+ */
+typedef struct vulkan_geometry_data {
+  u32 id;
+  u32 generation;
+  u32 vertex_count;
+  u32 vertex_size;
+  u64 vertex_buffer_offset;
+  u32 index_count;
+  u32 index_size;
+  u64 index_buffer_offset;
+} vulkan_geometry_data;
+
+// Upper bound on frame slots with geometry ranges waiting to be freed
+#define VULKAN_MAX_PENDING_FREE_FRAMES 3
+
+/**
+ * @brief A range of a shared object buffer whose geometry was destroyed while
+ * in-flight frames could still read it.
+ */
+typedef struct vulkan_pending_range_free {
+  vulkan_buffer *buffer;
+  u64 size;
+  u64 offset;
+} vulkan_pending_range_free;
+
+// Upper bound on staging ring regions, one is used per frame in flight
+#define VULKAN_MAX_STAGING_REGIONS 3
+
+/**
+ * @brief Persistently mapped, host-visible staging memory split into one
+ * region per frame in flight. Uploads recorded while a region is current are
+ * batched into a single transfer queue submission, with a fence per region
+ * guarding reuse of its memory.
+ */
+typedef struct vulkan_staging_ring {
+  vulkan_buffer buffer;
+  u8 *mapped;
+  u64 region_size;
+  u32 region_count;
+  u32 current_region;
+  // Write head within the current region
+  u64 region_offset;
+  // True if copies have been recorded but not yet submitted
+  b8 is_recording;
+  // Recorded on and submitted to the transfer queue
+  vulkan_command_buffer command_buffers[VULKAN_MAX_STAGING_REGIONS];
+  vulkan_fence fences[VULKAN_MAX_STAGING_REGIONS];
+
+  // Set when the transfer and graphics queues are in different families, and
+  // ownership of uploaded resources has to be handed over to graphics.
+  b8 needs_ownership_transfer;
+  // Graphics queue side of the ownership transfer, waits on the semaphore
+  vulkan_command_buffer acquire_command_buffers[VULKAN_MAX_STAGING_REGIONS];
+  VkSemaphore transfer_complete_semaphores[VULKAN_MAX_STAGING_REGIONS];
+  // darrays of acquire barriers for the current region's uploads
+  VkBufferMemoryBarrier *pending_buffer_acquires;
+  VkImageMemoryBarrier *pending_image_acquires;
+} vulkan_staging_ring;
+
+// Upper bound on frames timed at once, one is used per frame in flight
+#define VULKAN_MAX_TIMED_FRAMES 3
+
+/**
+ * @brief Measures GPU time per frame with a pair of timestamp queries around
+ * each frame's commands. Results are read once the frame's fence has been
+ * waited on, so they arrive max_frames_in_flight frames late.
+ * @param period_ms - Milliseconds per timestamp tick.
+ * @param valid_mask - Mask of the bits the queue actually writes.
+ * @param submit_times - Absolute CPU time each frame slot was submitted.
+ */
+typedef struct vulkan_gpu_timer {
+  b8 supported;
+  VkQueryPool query_pool;
+  u32 frame_count;
+  f64 period_ms;
+  u64 valid_mask;
+  b8 pending[VULKAN_MAX_TIMED_FRAMES];
+  f64 submit_times[VULKAN_MAX_TIMED_FRAMES];
+
+  // Most recent result, and whether it hasn't been read yet
+  b8 has_result;
+  f64 last_submit_time;
+  f64 last_frame_ms;
+} vulkan_gpu_timer;
+
+// Max number of instances drawn per frame
+// TODO: make configurable
+#define VULKAN_MAX_INSTANCE_COUNT 16384
+
+// Max number of simultaneously uploaded geometries
+// TODO: make configurable
+#define VULKAN_MAX_GEOMETRY_COUNT 4096
+
 typedef struct vulkan_context {
 
   u32 framebuffer_width;
@@ -183,6 +297,14 @@ u64 framebuffer_size_last_generation;
   vulkan_buffer object_vertex_buffer;
   vulkan_buffer object_index_buffer;
 
+  // Per-instance model matrices, one region of VULKAN_MAX_INSTANCE_COUNT per
+  // frame in flight. Host visible and mapped for the lifetime of the context.
+  vulkan_buffer instance_buffer;
+  u8 *instance_buffer_mapped;
+
+  // All host to device uploads go through here
+  vulkan_staging_ring staging;
+
   // darray
   vulkan_command_buffer* graphics_command_buffers;
 
@@ -205,8 +327,20 @@ u64 framebuffer_size_last_generation;
 
   vulkan_object_shader object_shader;
 
-  u64 geometry_vertex_offset;
-  u64 geometry_index_offset;
+  // Shared by all pipeline creation, persisted to disk between runs
+  VkPipelineCache pipeline_cache;
+
+  vulkan_gpu_timer gpu_timer;
+
+  // Geometry uploaded to the object buffers, indexed by geometry id
+  vulkan_geometry_data geometries[VULKAN_MAX_GEOMETRY_COUNT];
+
+  // darrays of ranges freed per frame slot, released once that slot's fence
+  // has been waited on
+  vulkan_pending_range_free
+      *pending_range_frees[VULKAN_MAX_PENDING_FREE_FRAMES];
+  // Slot of the most recently begun frame, the last one that can read a range
+  u32 last_begun_frame;
 
   i32 (*find_memory_index)(u32 type_filter, u32 property_flags);
 
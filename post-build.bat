@@ -2,6 +2,7 @@
 
 REM Run from root directory!
 if not exist "%cd%\bin\assets\shaders\" mkdir "%cd%\bin\assets\shaders"
+if not exist "%cd%\bin\assets\cache\" mkdir "%cd%\bin\assets\cache"
 
 echo "Compiling shaders..."
 
@@ -3,6 +3,7 @@
 # Run from root directory!
 mkdir -p bin/assets
 mkdir -p bin/assets/shaders
+mkdir -p bin/assets/cache
 
 echo "Compiling shaders..."
 
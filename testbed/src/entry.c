@@ -10,6 +10,7 @@ b8 create_game(game* out_game) {
   out_game->app_config.start_width = 1280;
   out_game->app_config.start_height = 720;
   out_game->app_config.name = "Orion Engine Testbed";
+  out_game->app_config.track_allocations = true;
 
   out_game->update = game_update;
   out_game->render = game_render;
@@ -4,26 +4,42 @@
 #include <core/omemory.h>
 #include <renderer/renderer_frontend.h>
 #include <core/input.h>
+#include <math/omath.h>
+#include <core/profiler.h>
 
-static u32 mesh_data_id;
+static u32 mesh_data_id = INVALID_ID;
 b8 game_initialize(struct game* game_inst) {
   ODEBUG("game_initialize() called");
+  // The steady-state frame shouldn't allocate at all; loading is logged.
+  memory_set_frame_budget(0, 0, false);
   return true;
 }
 
   // Function pointer to game's update/loop
 b8 game_update(struct game* game_inst, f32 delta_time) {
-      static u64 alloc_count = 0;
-    u64 prev_alloc_count = alloc_count;
-    alloc_count = get_memory_alloc_count();
     if (input_is_key_up('M') && input_was_key_down('M')) {
-        ODEBUG("Allocations: %llu (%llu this frame)", alloc_count, alloc_count - prev_alloc_count);
+        memory_log_frame_report();
+    }
+    // Toggle a trace capture, logging frame stats when it ends
+    if (input_is_key_up('P') && input_was_key_down('P')) {
+      if (!profiler_is_capturing()) {
+        profiler_capture_begin();
+        ODEBUG("Profiler capture started.");
+      } else {
+        profiler_capture_end("profile_trace.json");
+        profiler_stats cpu, gpu;
+        profiler_get_cpu_frame_stats(&cpu);
+        profiler_get_gpu_frame_stats(&gpu);
+        ODEBUG("CPU frame ms: avg %.3f, p95 %.3f, max %.3f", cpu.avg, cpu.p95, cpu.max);
+        ODEBUG("GPU frame ms: avg %.3f, p95 %.3f, max %.3f", gpu.avg, gpu.p95, gpu.max);
+      }
     }
     // TODO: Temp code, remove after testing
     if (input_is_key_up('R') && input_was_key_down('R')) {
 
       f32 f = 2.0f;
-      vertex_3d plane[6];
+      vertex_3d plane[4];
+      ozero_memory(plane, sizeof(vertex_3d) * 4);
       plane[0].position.x = -0.5 * f;
       plane[0].position.y = -0.5 * f;
       plane[0].tex_coord.u = 0.0;
@@ -43,9 +59,18 @@ b8 game_update(struct game* game_inst, f32 delta_time) {
       plane[3].position.y = -0.5 * f;
       plane[3].tex_coord.u = 1.0;
       plane[3].tex_coord.v = 0.0;
-      mesh_data_id = renderer_load_mesh(plane, 3);
+      u32 indices[6] = {0, 1, 2, 0, 3, 1};
+      // Drop the previous mesh; objects still referencing it are skipped
+      if (mesh_data_id != INVALID_ID) {
+        renderer_unload_mesh(mesh_data_id);
+      }
+      mesh_data_id = renderer_load_mesh(plane, 4, indices, 6);
       ODEBUG("%d", mesh_data_id);
-      renderer_register_object(mesh_data_id, 2);
+      // Several instances of the same mesh, drawn as a single batch
+      for (u32 i = 0; i < 4; ++i) {
+        mat4 model = mat4_translation((vec3){-1.5f + i, 0, -2.0f});
+        renderer_register_object(mesh_data_id, INVALID_ID, model);
+      }
     }
 
 
@@ -53,7 +78,16 @@ b8 game_update(struct game* game_inst, f32 delta_time) {
 }
 
   // Function pointer to game's render pass
-b8 game_render(struct game* game_inst, f32 delta_time) {
+b8 game_render(struct game* game_inst, f32 delta_time, struct render_packet* packet) {
+  // TODO: Temp code, remove after testing
+  // A transient draw, submitted through the packet every frame instead of
+  // being registered with the renderer
+  if (mesh_data_id != INVALID_ID) {
+    static f32 angle = 0.0f;
+    angle += delta_time;
+    mat4 model = mat4_mul(mat4_euler_z(angle), mat4_translation((vec3){0, 1.0f, -2.0f}));
+    render_packet_push_draw(packet, mesh_data_id, INVALID_ID, model);
+  }
   return true;
 }
 
@@ -14,7 +14,7 @@ b8 game_initialize(struct game* game_inst);
 b8 game_update(struct game* game_inst, f32 delta_time);
 
   // Function pointer to game's render pass
-b8 game_render(struct game* game_inst, f32 delta_time);
+b8 game_render(struct game* game_inst, f32 delta_time, struct render_packet* packet);
 
   // Function pointer to handle resize, if applicable
 void game_on_resize(struct game* game_inst, u32 width, u32 height);
@@ -0,0 +1,397 @@
+#include "container_benchmarks.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/darray.h>
+#include <containers/hashtable.h>
+#include <containers/ring_queue.h>
+#include <containers/soa.h>
+#include <core/clock.h>
+#include <core/logger.h>
+#include <core/omemory.h>
+#include <core/ostring.h>
+#include <math/omath.h>
+
+#include <platform/platform.h>
+
+#define BENCH_NAMED_COUNT 1000
+#define BENCH_LOOKUPS 100000
+
+typedef struct named_entry {
+    char name[32];
+    u32 id;
+} named_entry;
+
+u8 container_benchmark_hashtable_lookup() {
+    // Resources looked up by name, as textures and shaders are.
+    named_entry* entries = darray_create_with_capacity(named_entry, BENCH_NAMED_COUNT);
+    hashtable table;
+    expect_to_be_true(hashtable_create(sizeof(u32), BENCH_NAMED_COUNT, HASHTABLE_KEY_STRING, &table));
+    for (u32 i = 0; i < BENCH_NAMED_COUNT; ++i) {
+        named_entry entry;
+        string_format(entry.name, "texture_%u", i);
+        entry.id = i;
+        darray_push(entries, entry);
+        hashtable_set(&table, entry.name, &i);
+    }
+
+    // Look names up in a scattered order; every lookup hits.
+    char names[64][32];
+    for (u32 i = 0; i < 64; ++i) {
+        string_format(names[i], "texture_%u", (i * 7919) % BENCH_NAMED_COUNT);
+    }
+
+    u64 scan_sum = 0;
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_LOOKUPS; ++i) {
+        const char* name = names[i % 64];
+        u64 length = darray_length(entries);
+        for (u64 j = 0; j < length; ++j) {
+            if (strings_equal(entries[j].name, name)) {
+                scan_sum += entries[j].id;
+                break;
+            }
+        }
+    }
+    clock_update(&timer);
+    f64 scan = timer.elapsed;
+
+    u64 table_sum = 0;
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_LOOKUPS; ++i) {
+        u32* id = hashtable_get(&table, names[i % 64]);
+        table_sum += *id;
+    }
+    clock_update(&timer);
+    f64 lookup = timer.elapsed;
+    expect_should_be(scan_sum, table_sum);
+
+    hashtable_destroy(&table);
+    darray_destroy(entries);
+
+    OINFO("%u name lookups over %u entries, darray scan: %.3fms, hashtable: %.3fms",
+          BENCH_LOOKUPS, BENCH_NAMED_COUNT, scan * 1000.0, lookup * 1000.0);
+    return true;
+}
+
+#define BENCH_PUSH_COUNT (1024 * 1024)
+#define BENCH_SHIFT_COUNT 20000
+
+// The darray as it was before the inline header accessors and minimum growth
+// capacity, kept as the baseline: every field access is a call into the
+// engine, and growth starts from a capacity of 1.
+static void* legacy_darray_resize(void* array) {
+    u64 length = _darray_field_get(array, DARRAY_LENGTH);
+    u64 stride = _darray_field_get(array, DARRAY_STRIDE);
+    void* temp = _darray_create_uninit(DARRAY_RESIZE_FACTOR * _darray_field_get(array, DARRAY_CAPACITY), stride);
+    ocopy_memory(temp, array, length * stride);
+    _darray_field_set(temp, DARRAY_LENGTH, length);
+    _darray_destroy(array);
+    return temp;
+}
+
+static void* legacy_darray_push(void* array, const void* value_ptr) {
+    u64 length = _darray_field_get(array, DARRAY_LENGTH);
+    u64 stride = _darray_field_get(array, DARRAY_STRIDE);
+    if (length >= _darray_field_get(array, DARRAY_CAPACITY)) {
+        array = legacy_darray_resize(array);
+    }
+    ocopy_memory((u8*)array + length * stride, value_ptr, stride);
+    _darray_field_set(array, DARRAY_LENGTH, length + 1);
+    return array;
+}
+
+static void legacy_darray_pop(void* array, void* dest) {
+    u64 length = _darray_field_get(array, DARRAY_LENGTH);
+    u64 stride = _darray_field_get(array, DARRAY_STRIDE);
+    ocopy_memory(dest, (u8*)array + (length - 1) * stride, stride);
+    _darray_field_set(array, DARRAY_LENGTH, length - 1);
+}
+
+static void* legacy_darray_insert_at(void* array, u64 index, const void* value_ptr) {
+    u64 length = _darray_field_get(array, DARRAY_LENGTH);
+    u64 stride = _darray_field_get(array, DARRAY_STRIDE);
+    if (length >= _darray_field_get(array, DARRAY_CAPACITY)) {
+        array = legacy_darray_resize(array);
+    }
+    u8* addr = array;
+    // The original used ocopy_memory here, which is undefined for these
+    // overlapping ranges; the baseline moves the same bytes correctly.
+    if (index != length - 1) {
+        omove_memory(addr + (index + 1) * stride, addr + index * stride, stride * (length - index));
+    }
+    ocopy_memory(addr + index * stride, value_ptr, stride);
+    _darray_field_set(array, DARRAY_LENGTH, length + 1);
+    return array;
+}
+
+u8 container_benchmark_darray() {
+    clock timer;
+
+    // Push one at a time from an empty array.
+    u32* legacy = darray_create(u32);
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; ++i) {
+        legacy = legacy_darray_push(legacy, &i);
+    }
+    clock_update(&timer);
+    f64 legacy_push = timer.elapsed;
+
+    u32* current = darray_create(u32);
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; ++i) {
+        darray_push(current, i);
+    }
+    clock_update(&timer);
+    f64 push = timer.elapsed;
+    expect_should_be(BENCH_PUSH_COUNT, darray_length(current));
+
+    // The same elements in bulk, 256 at a time.
+    u32 batch[256];
+    for (u32 i = 0; i < 256; ++i) {
+        batch[i] = i;
+    }
+    u32* bulk = darray_create(u32);
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; i += 256) {
+        darray_push_n(bulk, batch, 256);
+    }
+    clock_update(&timer);
+    f64 push_n = timer.elapsed;
+    expect_should_be(BENCH_PUSH_COUNT, darray_length(bulk));
+
+    // Pop everything back off.
+    u64 legacy_sum = 0;
+    u64 sum = 0;
+    u32 value;
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; ++i) {
+        legacy_darray_pop(legacy, &value);
+        legacy_sum += value;
+    }
+    clock_update(&timer);
+    f64 legacy_pop = timer.elapsed;
+
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; ++i) {
+        darray_pop(current, &value);
+        sum += value;
+    }
+    clock_update(&timer);
+    f64 pop = timer.elapsed;
+    expect_should_be(legacy_sum, sum);
+
+    // Insert at the front; both shift every element, so growth is the
+    // difference.
+    u32 zero = 0;
+    legacy = legacy_darray_push(legacy, &zero);
+    darray_push(current, zero);
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_SHIFT_COUNT; ++i) {
+        legacy = legacy_darray_insert_at(legacy, 0, &i);
+    }
+    clock_update(&timer);
+    f64 legacy_insert = timer.elapsed;
+
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_SHIFT_COUNT; ++i) {
+        darray_insert_at(current, 0, i);
+    }
+    clock_update(&timer);
+    f64 insert = timer.elapsed;
+
+    // Remove from the front, keeping order or not.
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_SHIFT_COUNT; ++i) {
+        darray_pop_at(legacy, 0, &value);
+    }
+    clock_update(&timer);
+    f64 pop_at = timer.elapsed;
+
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_SHIFT_COUNT; ++i) {
+        darray_remove_swap(current, 0, &value);
+    }
+    clock_update(&timer);
+    f64 remove_swap = timer.elapsed;
+    expect_should_be(1, darray_length(current));
+
+    darray_destroy(bulk);
+    darray_destroy(current);
+    darray_destroy(legacy);
+
+    OINFO("darray %u pushes, old: %.3fms, new: %.3fms, push_n: %.3fms; pops, old: %.3fms, new: %.3fms",
+          BENCH_PUSH_COUNT, legacy_push * 1000.0, push * 1000.0, push_n * 1000.0, legacy_pop * 1000.0,
+          pop * 1000.0);
+    OINFO("darray %u front inserts, old: %.3fms, new: %.3fms; front removals, pop_at: %.3fms, remove_swap: %.3fms",
+          BENCH_SHIFT_COUNT, legacy_insert * 1000.0, insert * 1000.0, pop_at * 1000.0, remove_swap * 1000.0);
+    return true;
+}
+
+#define BENCH_ENTITY_COUNT (1024 * 1024)
+#define BENCH_ENTITY_FRAMES 10
+
+// A typical game object; the update below only reads velocity and writes
+// position.
+typedef struct bench_entity {
+    vec3 position;
+    vec3 velocity;
+    quat rotation;
+    vec3 scale;
+    u32 id;
+    f32 health;
+} bench_entity;
+
+enum { ENTITY_X, ENTITY_Y, ENTITY_Z, ENTITY_VX, ENTITY_VY, ENTITY_VZ, ENTITY_FIELD_COUNT };
+
+u8 container_benchmark_soa_iteration() {
+    bench_entity* entities = darray_create_with_capacity(bench_entity, BENCH_ENTITY_COUNT);
+    u64 strides[ENTITY_FIELD_COUNT];
+    for (u32 i = 0; i < ENTITY_FIELD_COUNT; ++i) {
+        strides[i] = sizeof(f32);
+    }
+    soa s;
+    expect_to_be_true(soa_create(ENTITY_FIELD_COUNT, strides, BENCH_ENTITY_COUNT, &s));
+    for (u32 i = 0; i < BENCH_ENTITY_COUNT; ++i) {
+        bench_entity entity = {0};
+        entity.velocity = vec3_create(1.0f, (f32)(i % 7), -0.5f);
+        entity.rotation = (quat){0.0f, 0.0f, 0.0f, 1.0f};
+        entity.scale = vec3_one();
+        entity.id = i;
+        darray_push(entities, entity);
+
+        u64 index;
+        soa_push(&s, &index);
+        soa_vec3_set(soa_field_as(&s, f32, ENTITY_VX), soa_field_as(&s, f32, ENTITY_VY),
+                     soa_field_as(&s, f32, ENTITY_VZ), index, entity.velocity);
+    }
+
+    f32 dt = 1.0f / 60.0f;
+    clock timer;
+    clock_start(&timer);
+    for (u32 frame = 0; frame < BENCH_ENTITY_FRAMES; ++frame) {
+        u64 length = darray_length(entities);
+        for (u64 i = 0; i < length; ++i) {
+            entities[i].position = vec3_add(entities[i].position, vec3_mul_scalar(entities[i].velocity, dt));
+        }
+    }
+    clock_update(&timer);
+    f64 aos = timer.elapsed;
+
+    f32* x = soa_field_as(&s, f32, ENTITY_X);
+    f32* y = soa_field_as(&s, f32, ENTITY_Y);
+    f32* z = soa_field_as(&s, f32, ENTITY_Z);
+    clock_start(&timer);
+    for (u32 frame = 0; frame < BENCH_ENTITY_FRAMES; ++frame) {
+        soa_f32_add_scaled(x, soa_field_as(&s, f32, ENTITY_VX), dt, s.length);
+        soa_f32_add_scaled(y, soa_field_as(&s, f32, ENTITY_VY), dt, s.length);
+        soa_f32_add_scaled(z, soa_field_as(&s, f32, ENTITY_VZ), dt, s.length);
+    }
+    clock_update(&timer);
+    f64 soa_time = timer.elapsed;
+
+    b8 matches = true;
+    for (u32 i = 0; i < BENCH_ENTITY_COUNT; i += 4099) {
+        matches = matches && vec3_compare(entities[i].position, soa_vec3_get(x, y, z, i), 0.001f);
+    }
+    expect_to_be_true(matches);
+
+    soa_destroy(&s);
+    darray_destroy(entities);
+
+    OINFO("%u frames over %u entities (%u-byte structs), AoS darray: %.3fms, SoA: %.3fms", BENCH_ENTITY_FRAMES,
+          BENCH_ENTITY_COUNT, (u32)sizeof(bench_entity), aos * 1000.0, soa_time * 1000.0);
+    return true;
+}
+
+#define BENCH_QUEUE_ITEMS (1024 * 1024)
+#define BENCH_QUEUE_PRODUCERS 4
+
+typedef struct queue_producer {
+    ring_queue* queue;
+    u64 count;
+} queue_producer;
+
+static void bench_produce(void* arg) {
+    queue_producer* producer = arg;
+    for (u64 i = 0; i < producer->count; ++i) {
+        while (!ring_queue_push(producer->queue, &i)) {
+        }
+    }
+}
+
+/**
+ * @brief Pushes BENCH_QUEUE_ITEMS through a queue from producer_count threads
+ * to this one, returning the elapsed seconds.
+ */
+static f64 time_queue_throughput(ring_queue_mode mode, u32 producer_count, u64* out_sum) {
+    ring_queue queue;
+    ring_queue_create(sizeof(u64), 4096, mode, &queue);
+    platform_thread threads[BENCH_QUEUE_PRODUCERS];
+    queue_producer producers[BENCH_QUEUE_PRODUCERS];
+
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < producer_count; ++i) {
+        producers[i] = (queue_producer){&queue, BENCH_QUEUE_ITEMS / producer_count};
+        platform_thread_create(bench_produce, &producers[i], &threads[i]);
+    }
+    u64 item;
+    for (u64 received = 0; received < BENCH_QUEUE_ITEMS;) {
+        if (ring_queue_pop(&queue, &item)) {
+            *out_sum += item;
+            received++;
+        }
+    }
+    clock_update(&timer);
+    for (u32 i = 0; i < producer_count; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+    ring_queue_destroy(&queue);
+    return timer.elapsed;
+}
+
+u8 container_benchmark_ring_queue() {
+    // Single-threaded baseline: push and pop in batches on one thread.
+    ring_queue queue;
+    expect_to_be_true(ring_queue_create(sizeof(u64), 4096, RING_QUEUE_MODE_SINGLE_THREADED, &queue));
+    u64 single_sum = 0;
+    u64 item;
+    clock timer;
+    clock_start(&timer);
+    for (u64 i = 0; i < BENCH_QUEUE_ITEMS; i += 4096) {
+        for (u64 j = 0; j < 4096; ++j) {
+            ring_queue_push(&queue, &j);
+        }
+        while (ring_queue_pop(&queue, &item)) {
+            single_sum += item;
+        }
+    }
+    clock_update(&timer);
+    f64 single = timer.elapsed;
+    ring_queue_destroy(&queue);
+
+    u64 spsc_sum = 0;
+    u64 mpsc_sum = 0;
+    f64 spsc = time_queue_throughput(RING_QUEUE_MODE_SPSC, 1, &spsc_sum);
+    f64 mpsc = time_queue_throughput(RING_QUEUE_MODE_MPSC, BENCH_QUEUE_PRODUCERS, &mpsc_sum);
+    u64 n = BENCH_QUEUE_ITEMS;
+    expect_should_be(n * (n - 1) / 2, spsc_sum);
+    u64 per_producer = n / BENCH_QUEUE_PRODUCERS;
+    expect_should_be(BENCH_QUEUE_PRODUCERS * (per_producer * (per_producer - 1) / 2), mpsc_sum);
+
+    f64 millions = BENCH_QUEUE_ITEMS / 1000000.0;
+    OINFO("ring_queue throughput (Mitems/s), single-threaded: %.1f, SPSC: %.1f, MPSC (%u producers): %.1f",
+          millions / single, millions / spsc, BENCH_QUEUE_PRODUCERS, millions / mpsc);
+    return true;
+}
+
+void container_register_benchmarks() {
+    test_manager_register_test(container_benchmark_darray, "Benchmark darray push, insert and pop");
+    test_manager_register_test(container_benchmark_hashtable_lookup, "Benchmark hashtable vs darray scan lookup");
+    test_manager_register_test(container_benchmark_soa_iteration, "Benchmark AoS darray vs SoA iteration");
+    test_manager_register_test(container_benchmark_ring_queue, "Benchmark ring queue throughput");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void container_register_benchmarks();
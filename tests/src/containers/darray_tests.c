@@ -0,0 +1,314 @@
+#include "darray_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/darray.h>
+#include <core/omemory.h>
+
+u8 darray_virtual_should_keep_element_addresses() {
+    u64 max_length = 1024 * 1024;
+    u64* array = darray_create_virtual(u64, max_length);
+    expect_should_not_be(0, array);
+
+    darray_push(array, (u64)0);
+    u64* first = &array[0];
+    u64* base = array;
+
+    // Grow well past the first page; nothing may move.
+    u64 count = 200000;
+    for (u64 i = 1; i < count; ++i) {
+        darray_push(array, i);
+    }
+    expect_should_be(base, array);
+    expect_should_be(first, &array[0]);
+    expect_should_be(count, darray_length(array));
+    b8 has_capacity = darray_capacity(array) >= count;
+    expect_to_be_true(has_capacity);
+
+    b8 values_intact = true;
+    for (u64 i = 0; i < count; ++i) {
+        values_intact = values_intact && array[i] == i;
+    }
+    expect_to_be_true(values_intact);
+
+    // Insertion shifts values but not the storage.
+    darray_insert_at(array, 0, (u64)42);
+    expect_should_be(base, array);
+    expect_should_be(42, array[0]);
+    expect_should_be(0, array[1]);
+
+    darray_destroy(array);
+    return true;
+}
+
+u8 darray_virtual_should_refuse_to_grow_past_reservation() {
+    // Elements larger than a page, so every push past the first commits.
+    typedef struct big_element {
+        u8 bytes[6000];
+    } big_element;
+
+    big_element* array = darray_create_virtual(big_element, 3);
+    expect_should_not_be(0, array);
+
+    big_element element = {0};
+    for (u32 i = 0; i < 3; ++i) {
+        element.bytes[5999] = (u8)i;
+        darray_push(array, element);
+    }
+    expect_should_be(3, darray_length(array));
+    expect_should_be(3, darray_capacity(array));
+
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    darray_push(array, element);
+    expect_should_be(3, darray_length(array));
+    expect_should_be(2, array[2].bytes[5999]);
+
+    darray_destroy(array);
+    return true;
+}
+
+u8 darray_should_push_n_and_append_arrays() {
+    u32* array = darray_create(u32);
+    u32 values[100];
+    for (u32 i = 0; i < 100; ++i) {
+        values[i] = i;
+    }
+    darray_push_n(array, values, 100);
+    expect_should_be(100, darray_length(array));
+    b8 has_capacity = darray_capacity(array) >= 100;
+    expect_to_be_true(has_capacity);
+
+    u32* other = darray_create(u32);
+    darray_push(other, (u32)100);
+    darray_push(other, (u32)101);
+    darray_append_array(array, other);
+    expect_should_be(102, darray_length(array));
+    expect_should_be(101, array[101]);
+
+    // Appending to itself copies the original contents once.
+    darray_append_array(array, array);
+    expect_should_be(204, darray_length(array));
+    b8 values_intact = true;
+    for (u32 i = 0; i < 204; ++i) {
+        values_intact = values_intact && array[i] == i % 102;
+    }
+    expect_to_be_true(values_intact);
+
+    darray_destroy(other);
+    darray_destroy(array);
+    return true;
+}
+
+u8 darray_remove_swap_should_move_last_element() {
+    u32* array = darray_create(u32);
+    for (u32 i = 0; i < 5; ++i) {
+        darray_push(array, i);
+    }
+
+    u32 removed = 0;
+    darray_remove_swap(array, 1, &removed);
+    expect_should_be(1, removed);
+    expect_should_be(4, darray_length(array));
+    expect_should_be(4, array[1]);
+    expect_should_be(3, array[3]);
+
+    // Removing the last element just shortens the array.
+    darray_remove_swap(array, 3, 0);
+    expect_should_be(3, darray_length(array));
+    expect_should_be(0, array[0]);
+    expect_should_be(4, array[1]);
+    expect_should_be(2, array[2]);
+
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    darray_remove_swap(array, 3, &removed);
+    expect_should_be(3, darray_length(array));
+
+    darray_destroy(array);
+    return true;
+}
+
+u8 darray_reserve_and_shrink_should_keep_contents() {
+    u64* array = darray_create(u64);
+    darray_push(array, (u64)7);
+    darray_push(array, (u64)8);
+
+    darray_reserve(array, 1000);
+    expect_should_be(1000, darray_capacity(array));
+    expect_should_be(2, darray_length(array));
+    expect_should_be(8, array[1]);
+
+    // No reallocation while pushing within the reserved capacity.
+    u64* base = array;
+    for (u64 i = 2; i < 1000; ++i) {
+        darray_push(array, i);
+    }
+    expect_should_be(base, array);
+
+    // Reserving less than the capacity does nothing.
+    darray_reserve(array, 10);
+    expect_should_be(1000, darray_capacity(array));
+
+    for (u32 i = 0; i < 990; ++i) {
+        u64 value;
+        darray_pop(array, &value);
+    }
+    darray_shrink_to_fit(array);
+    expect_should_be(10, darray_capacity(array));
+    expect_should_be(10, darray_length(array));
+    expect_should_be(7, array[0]);
+    expect_should_be(9, array[9]);
+
+    darray_clear(array);
+    darray_shrink_to_fit(array);
+    expect_should_be(0, darray_capacity(array));
+    // An empty array still grows from nothing.
+    darray_push(array, (u64)3);
+    expect_should_be(3, array[0]);
+
+    darray_destroy(array);
+    return true;
+}
+
+u8 darray_insert_at_should_append_at_length() {
+    u32* array = darray_create(u32);
+    darray_insert_at(array, 0, (u32)1);
+    darray_insert_at(array, 1, (u32)3);
+    darray_insert_at(array, 1, (u32)2);
+    expect_should_be(3, darray_length(array));
+    expect_should_be(1, array[0]);
+    expect_should_be(2, array[1]);
+    expect_should_be(3, array[2]);
+
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    darray_insert_at(array, 4, (u32)5);
+    expect_should_be(3, darray_length(array));
+
+    darray_destroy(array);
+    return true;
+}
+
+// An odd stride, so an off-by-one in bytes shows up as well as in elements.
+typedef struct fuzz_element {
+    u8 bytes[7];
+} fuzz_element;
+
+#define FUZZ_OPERATIONS 20000
+#define FUZZ_MAX_LENGTH 256
+#define FUZZ_CANARY 0xA5
+
+static u32 fuzz_state = 0x2545F491;
+
+static u32 fuzz_next(u32 bound) {
+    // xorshift32; fixed seed so failures reproduce.
+    fuzz_state ^= fuzz_state << 13;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= fuzz_state << 5;
+    return fuzz_state % bound;
+}
+
+static fuzz_element fuzz_make(u32 value) {
+    fuzz_element element;
+    for (u32 i = 0; i < 7; ++i) {
+        element.bytes[i] = (u8)(value >> (i * 4));
+    }
+    return element;
+}
+
+static b8 fuzz_equal(const fuzz_element* a, const fuzz_element* b, u64 size) {
+    const u8* left = (const u8*)a;
+    const u8* right = (const u8*)b;
+    for (u64 i = 0; i < size; ++i) {
+        if (left[i] != right[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Whether the canary past the first length elements is untouched. */
+static b8 fuzz_slack_intact(fuzz_element* array, u64 length) {
+    u8* slack = (u8*)(array + length);
+    u64 size = (darray_capacity(array) - length) * sizeof(fuzz_element);
+    for (u64 i = 0; i < size; ++i) {
+        if (slack[i] != FUZZ_CANARY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+u8 darray_should_match_reference_model_under_random_edits() {
+    fuzz_element* array = darray_create(fuzz_element);
+    fuzz_element model[FUZZ_MAX_LENGTH + 1];
+    u32 model_length = 0;
+
+    b8 matches = true;
+    b8 slack_intact = true;
+    for (u32 op = 0; op < FUZZ_OPERATIONS && matches && slack_intact; ++op) {
+        // Nothing past the longer of the old and new lengths may be written,
+        // so fill it with a canary and check it afterwards, unless the array
+        // grew and moved.
+        u64 capacity = darray_capacity(array);
+        u32 length_before = model_length;
+        oset_memory(array + model_length, FUZZ_CANARY, (capacity - model_length) * sizeof(fuzz_element));
+        fuzz_element* before = array;
+
+        u32 choice = fuzz_next(4);
+        if (model_length == 0 || (choice == 0 && model_length < FUZZ_MAX_LENGTH)) {
+            u32 index = fuzz_next(model_length + 1);
+            fuzz_element element = fuzz_make(fuzz_next(0x7FFFFFFF));
+            darray_insert_at(array, index, element);
+            for (u32 i = model_length; i > index; --i) {
+                model[i] = model[i - 1];
+            }
+            model[index] = element;
+            model_length++;
+        } else if (choice == 1 && model_length < FUZZ_MAX_LENGTH) {
+            fuzz_element element = fuzz_make(fuzz_next(0x7FFFFFFF));
+            darray_push(array, element);
+            model[model_length++] = element;
+        } else if (choice == 2) {
+            u32 index = fuzz_next(model_length);
+            fuzz_element removed;
+            darray_pop_at(array, index, &removed);
+            matches = matches && fuzz_equal(&removed, &model[index], sizeof(fuzz_element));
+            for (u32 i = index; i + 1 < model_length; ++i) {
+                model[i] = model[i + 1];
+            }
+            model_length--;
+        } else {
+            u32 index = fuzz_next(model_length);
+            fuzz_element removed;
+            darray_remove_swap(array, index, &removed);
+            matches = matches && fuzz_equal(&removed, &model[index], sizeof(fuzz_element));
+            model[index] = model[model_length - 1];
+            model_length--;
+        }
+
+        matches = matches && darray_length(array) == model_length;
+        for (u32 i = 0; i < model_length && matches; ++i) {
+            matches = fuzz_equal(&array[i], &model[i], sizeof(fuzz_element));
+        }
+        if (array == before && darray_capacity(array) == capacity) {
+            u32 written = model_length > length_before ? model_length : length_before;
+            slack_intact = fuzz_slack_intact(array, written);
+        }
+    }
+    expect_to_be_true(matches);
+    expect_to_be_true(slack_intact);
+
+    darray_destroy(array);
+    return true;
+}
+
+void darray_register_tests() {
+    test_manager_register_test(darray_virtual_should_keep_element_addresses, "Virtual darray should keep element addresses while growing");
+    test_manager_register_test(darray_virtual_should_refuse_to_grow_past_reservation, "Virtual darray should refuse to grow past its reservation");
+    test_manager_register_test(darray_should_push_n_and_append_arrays, "Darray should push many elements and append arrays");
+    test_manager_register_test(darray_remove_swap_should_move_last_element, "Darray remove_swap should move the last element into the gap");
+    test_manager_register_test(darray_reserve_and_shrink_should_keep_contents, "Darray reserve and shrink_to_fit should keep contents");
+    test_manager_register_test(darray_insert_at_should_append_at_length, "Darray insert_at should append at the length");
+    test_manager_register_test(darray_should_match_reference_model_under_random_edits, "Darray should match a reference model under random edits");
+}
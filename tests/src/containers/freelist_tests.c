@@ -0,0 +1,200 @@
+#include "freelist_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/freelist.h>
+#include <core/omemory.h>
+
+u8 freelist_should_create_and_destroy() {
+    freelist list;
+    u64 memory_requirement = 0;
+    freelist_create(40, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(40, &memory_requirement, block, &list);
+
+    expect_should_not_be(0, list.memory);
+    u64 free_space = freelist_free_space(&list);
+    expect_should_be(40, free_space);
+
+    freelist_destroy(&list);
+    expect_should_be(0, list.memory);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 freelist_should_allocate_one_and_free_one() {
+    freelist list;
+    u64 memory_requirement = 0;
+    u64 total_size = 512;
+    freelist_create(total_size, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    u64 offset = INVALID_ID;
+    b8 result = freelist_allocate_block(&list, 64, &offset);
+    expect_to_be_true(result);
+    expect_should_be(0, offset);
+    u64 free_space = freelist_free_space(&list);
+    expect_should_be(total_size - 64, free_space);
+
+    result = freelist_free_block(&list, 64, offset);
+    expect_to_be_true(result);
+    free_space = freelist_free_space(&list);
+    expect_should_be(total_size, free_space);
+
+    freelist_destroy(&list);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 freelist_should_coalesce_neighbours() {
+    freelist list;
+    u64 memory_requirement = 0;
+    u64 total_size = 512;
+    freelist_create(total_size, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    u64 offsets[4];
+    for (u32 i = 0; i < 4; ++i) {
+        b8 result = freelist_allocate_block(&list, 64, &offsets[i]);
+        expect_to_be_true(result);
+        expect_should_be(i * 64, offsets[i]);
+    }
+
+    // Free 0 and 2, leaving holes either side of 1.
+    expect_to_be_true(freelist_free_block(&list, 64, offsets[0]));
+    expect_to_be_true(freelist_free_block(&list, 64, offsets[2]));
+
+    freelist_stats stats;
+    freelist_get_stats(&list, &stats);
+    expect_should_be(3, stats.free_block_count);
+    expect_should_be(total_size - 128, stats.free_space);
+
+    // Freeing 1 should join 0, 1, 2 and the tail into a single block.
+    expect_to_be_true(freelist_free_block(&list, 64, offsets[1]));
+    freelist_get_stats(&list, &stats);
+    expect_should_be(2, stats.free_block_count);
+
+    expect_to_be_true(freelist_free_block(&list, 64, offsets[3]));
+    freelist_get_stats(&list, &stats);
+    expect_should_be(1, stats.free_block_count);
+    expect_should_be(total_size, stats.largest_free_block);
+    expect_float_to_be(0.0f, stats.fragmentation);
+
+    freelist_destroy(&list);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 freelist_should_reuse_freed_space_first_fit() {
+    freelist list;
+    u64 memory_requirement = 0;
+    u64 total_size = 512;
+    freelist_create(total_size, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    u64 a, b, c;
+    expect_to_be_true(freelist_allocate_block(&list, 64, &a));
+    expect_to_be_true(freelist_allocate_block(&list, 64, &b));
+    expect_to_be_true(freelist_allocate_block(&list, 64, &c));
+
+    expect_to_be_true(freelist_free_block(&list, 64, b));
+
+    // Smaller allocation lands in the hole left by b.
+    u64 d;
+    expect_to_be_true(freelist_allocate_block(&list, 32, &d));
+    expect_should_be(b, d);
+
+    // Larger one doesn't fit the remaining 32 byte hole, goes to the tail.
+    u64 e;
+    expect_to_be_true(freelist_allocate_block(&list, 64, &e));
+    expect_should_be(192, e);
+
+    freelist_stats stats;
+    freelist_get_stats(&list, &stats);
+    expect_should_be(2, stats.free_block_count);
+    expect_should_be(total_size - 256 + 32, stats.free_space);
+    // 32 of the free bytes are not part of the largest block
+    expect_float_to_be(32.0f / stats.free_space, stats.fragmentation);
+
+    freelist_destroy(&list);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 freelist_should_fail_when_full_and_reject_double_free() {
+    freelist list;
+    u64 memory_requirement = 0;
+    u64 total_size = 128;
+    freelist_create(total_size, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    u64 a, b;
+    expect_to_be_true(freelist_allocate_block(&list, 64, &a));
+    expect_to_be_true(freelist_allocate_block(&list, 64, &b));
+    expect_should_be(0, freelist_free_space(&list));
+
+    ODEBUG("Note: The following warning is intentionally caused by this test.");
+    u64 c = INVALID_ID;
+    expect_to_be_false(freelist_allocate_block(&list, 1, &c));
+
+    expect_to_be_true(freelist_free_block(&list, 64, a));
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    expect_to_be_false(freelist_free_block(&list, 64, a));
+    expect_should_be(64, freelist_free_space(&list));
+
+    freelist_destroy(&list);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 freelist_should_grow_on_resize() {
+    freelist list;
+    u64 memory_requirement = 0;
+    u64 total_size = 128;
+    freelist_create(total_size, &memory_requirement, 0, &list);
+    void* block = oallocate(memory_requirement, MEMORY_TAG_ARRAY);
+    freelist_create(total_size, &memory_requirement, block, &list);
+
+    // Fill it, then grow.
+    u64 a;
+    expect_to_be_true(freelist_allocate_block(&list, 128, &a));
+    expect_to_be_true(freelist_resize(&list, 256));
+    expect_should_be(128, freelist_free_space(&list));
+
+    u64 b;
+    expect_to_be_true(freelist_allocate_block(&list, 64, &b));
+    expect_should_be(128, b);
+
+    // Growing again should merge into the existing tail block.
+    expect_to_be_true(freelist_resize(&list, 512));
+    freelist_stats stats;
+    freelist_get_stats(&list, &stats);
+    expect_should_be(1, stats.free_block_count);
+    expect_should_be(512 - 192, stats.free_space);
+    expect_should_be(512, stats.total_size);
+
+    freelist_destroy(&list);
+    ofree(block, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+void freelist_register_tests() {
+    test_manager_register_test(freelist_should_create_and_destroy, "Freelist should create and destroy");
+    test_manager_register_test(freelist_should_allocate_one_and_free_one, "Freelist allocate and free one");
+    test_manager_register_test(freelist_should_coalesce_neighbours, "Freelist should coalesce neighbouring free blocks");
+    test_manager_register_test(freelist_should_reuse_freed_space_first_fit, "Freelist should reuse freed space first fit");
+    test_manager_register_test(freelist_should_fail_when_full_and_reject_double_free, "Freelist should fail when full and reject double free");
+    test_manager_register_test(freelist_should_grow_on_resize, "Freelist should grow on resize");
+}
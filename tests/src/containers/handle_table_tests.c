@@ -0,0 +1,152 @@
+#include "handle_table_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/handle_table.h>
+
+typedef struct test_element {
+    u32 value;
+    f32 weight;
+} test_element;
+
+u8 handle_table_should_create_and_destroy() {
+    handle_table table;
+    expect_to_be_true(handle_table_create(sizeof(test_element), 4, &table));
+    expect_should_not_be(0, table.elements);
+    expect_should_be(4, table.capacity);
+    expect_should_be(0, table.count);
+
+    handle_table_destroy(&table);
+    expect_should_be(0, table.elements);
+    expect_should_be(0, table.capacity);
+
+    return true;
+}
+
+u8 handle_table_should_insert_and_get() {
+    handle_table table;
+    handle_table_create(sizeof(test_element), 4, &table);
+
+    test_element a = {7, 0.5f};
+    test_element b = {9, 1.5f};
+    u32 handle_a = handle_table_insert(&table, &a);
+    u32 handle_b = handle_table_insert(&table, &b);
+    expect_should_not_be(INVALID_ID, handle_a);
+    expect_should_not_be(INVALID_ID, handle_b);
+    expect_should_not_be(handle_a, handle_b);
+    expect_should_be(2, table.count);
+
+    test_element* got = handle_table_get(&table, handle_a);
+    expect_should_not_be(0, got);
+    expect_should_be(7, got->value);
+    got = handle_table_get(&table, handle_b);
+    expect_should_be(9, got->value);
+
+    // Handles that were never issued should not resolve.
+    expect_should_be(0, handle_table_get(&table, 0));
+    expect_should_be(0, handle_table_get(&table, INVALID_ID));
+    expect_should_be(0, handle_table_get(&table, HANDLE_INDEX(handle_a) + 3));
+
+    handle_table_destroy(&table);
+
+    return true;
+}
+
+u8 handle_table_should_invalidate_stale_handles() {
+    handle_table table;
+    handle_table_create(sizeof(test_element), 4, &table);
+
+    test_element a = {1, 0};
+    u32 old_handle = handle_table_insert(&table, &a);
+    expect_to_be_true(handle_table_remove(&table, old_handle, 0));
+    expect_to_be_false(handle_table_is_valid(&table, old_handle));
+    expect_should_be(0, handle_table_get(&table, old_handle));
+    // Double remove should fail.
+    expect_to_be_false(handle_table_remove(&table, old_handle, 0));
+
+    // The slot is reused, but with a new generation.
+    test_element b = {2, 0};
+    u32 new_handle = handle_table_insert(&table, &b);
+    expect_should_be(HANDLE_INDEX(old_handle), HANDLE_INDEX(new_handle));
+    expect_should_not_be(old_handle, new_handle);
+    expect_should_be(0, handle_table_get(&table, old_handle));
+    test_element* got = handle_table_get(&table, new_handle);
+    expect_should_be(2, got->value);
+
+    handle_table_destroy(&table);
+
+    return true;
+}
+
+u8 handle_table_should_keep_elements_dense_on_remove() {
+    handle_table table;
+    handle_table_create(sizeof(test_element), 4, &table);
+
+    u32 handles[4];
+    for (u32 i = 0; i < 4; ++i) {
+        test_element e = {i * 10, 0};
+        handles[i] = handle_table_insert(&table, &e);
+    }
+
+    test_element removed;
+    expect_to_be_true(handle_table_remove(&table, handles[1], &removed));
+    expect_should_be(10, removed.value);
+    expect_should_be(3, table.count);
+
+    // Remaining elements are contiguous and still reachable by handle.
+    u32 sum = 0;
+    test_element* elements = table.elements;
+    for (u32 i = 0; i < table.count; ++i) {
+        sum += elements[i].value;
+    }
+    expect_should_be(0 + 20 + 30, sum);
+    expect_should_be(0, ((test_element*)handle_table_get(&table, handles[0]))->value);
+    expect_should_be(20, ((test_element*)handle_table_get(&table, handles[2]))->value);
+    expect_should_be(30, ((test_element*)handle_table_get(&table, handles[3]))->value);
+
+    handle_table_destroy(&table);
+
+    return true;
+}
+
+u8 handle_table_should_grow_and_keep_handles() {
+    handle_table table;
+    handle_table_create(sizeof(test_element), 2, &table);
+
+    const u32 count = 100;
+    u32 handles[100];
+    for (u32 i = 0; i < count; ++i) {
+        test_element e = {i, 0};
+        handles[i] = handle_table_insert(&table, &e);
+        expect_should_not_be(INVALID_ID, handles[i]);
+    }
+    expect_should_be(count, table.count);
+    b8 grew = table.capacity >= count;
+    expect_to_be_true(grew);
+
+    for (u32 i = 0; i < count; ++i) {
+        test_element* got = handle_table_get(&table, handles[i]);
+        expect_should_not_be(0, got);
+        expect_should_be(i, got->value);
+    }
+
+    handle_table_clear(&table);
+    expect_should_be(0, table.count);
+    for (u32 i = 0; i < count; ++i) {
+        expect_to_be_false(handle_table_is_valid(&table, handles[i]));
+    }
+
+    handle_table_destroy(&table);
+
+    return true;
+}
+
+void handle_table_register_tests() {
+    test_manager_register_test(handle_table_should_create_and_destroy, "Handle table should create and destroy");
+    test_manager_register_test(handle_table_should_insert_and_get, "Handle table should insert and get");
+    test_manager_register_test(handle_table_should_invalidate_stale_handles, "Handle table should invalidate stale handles");
+    test_manager_register_test(handle_table_should_keep_elements_dense_on_remove, "Handle table should keep elements dense on remove");
+    test_manager_register_test(handle_table_should_grow_and_keep_handles, "Handle table should grow and keep handles");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void handle_table_register_tests();
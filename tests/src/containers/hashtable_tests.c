@@ -0,0 +1,156 @@
+#include "hashtable_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/hashtable.h>
+#include <core/ostring.h>
+
+typedef struct test_value {
+    u32 id;
+    f32 weight;
+} test_value;
+
+u8 hashtable_should_set_get_and_replace_string_keys() {
+    hashtable table;
+    expect_to_be_true(hashtable_create(sizeof(test_value), 0, HASHTABLE_KEY_STRING, &table));
+
+    test_value a = {1, 0.5f};
+    test_value b = {2, 1.5f};
+    expect_to_be_true(hashtable_set(&table, "albedo", &a));
+    expect_to_be_true(hashtable_set(&table, "normal", &b));
+    expect_should_be(2, table.count);
+
+    test_value* found = hashtable_get(&table, "albedo");
+    expect_should_not_be(0, found);
+    expect_should_be(1, found->id);
+    expect_should_be(0, hashtable_get(&table, "roughness"));
+
+    // Keys are copied, so the caller's buffer can change afterwards.
+    char key[16] = "specular";
+    hashtable_set_value(&table, key, ((test_value){3, 2.5f}));
+    key[0] = 'x';
+    found = hashtable_get(&table, "specular");
+    expect_should_not_be(0, found);
+    expect_should_be(3, found->id);
+
+    // Setting an existing key replaces its value in place.
+    hashtable_set_value(&table, "albedo", ((test_value){4, 0.0f}));
+    expect_should_be(3, table.count);
+    expect_should_be(4, ((test_value*)hashtable_get(&table, "albedo"))->id);
+
+    hashtable_destroy(&table);
+    expect_should_be(0, table.keys);
+    return true;
+}
+
+u8 hashtable_should_remove_and_reuse_slots() {
+    hashtable table;
+    expect_to_be_true(hashtable_create(sizeof(u32), 0, HASHTABLE_KEY_U64, &table));
+    u32 capacity = table.capacity;
+
+    // Churn far more keys through the table than it has slots; tombstones
+    // must be reclaimed rather than forcing growth.
+    for (u32 round = 0; round < 100; ++round) {
+        for (u64 key = 0; key < 4; ++key) {
+            u32 value = round;
+            expect_to_be_true(hashtable_set_u64(&table, round * 1000 + key, &value));
+        }
+        for (u64 key = 0; key < 4; ++key) {
+            u32 removed = 0;
+            expect_to_be_true(hashtable_remove_u64(&table, round * 1000 + key, &removed));
+            expect_should_be(round, removed);
+        }
+    }
+    expect_should_be(0, table.count);
+    expect_should_be(capacity, table.capacity);
+    expect_to_be_false(hashtable_remove_u64(&table, 0, 0));
+
+    // Removing from the middle of a probe chain keeps later keys reachable.
+    for (u64 key = 0; key < 6; ++key) {
+        hashtable_set_value_u64(&table, key, (u32)key);
+    }
+    expect_to_be_true(hashtable_remove_u64(&table, 2, 0));
+    b8 others_found = true;
+    for (u64 key = 0; key < 6; ++key) {
+        if (key != 2) {
+            u32* value = hashtable_get_u64(&table, key);
+            others_found = others_found && value && *value == key;
+        }
+    }
+    expect_to_be_true(others_found);
+    expect_should_be(0, hashtable_get_u64(&table, 2));
+
+    hashtable_destroy(&table);
+    return true;
+}
+
+u8 hashtable_should_grow_and_iterate_every_entry() {
+    hashtable table;
+    expect_to_be_true(hashtable_create(sizeof(u64), 0, HASHTABLE_KEY_STRING, &table));
+
+    u32 count = 5000;
+    char key[32];
+    for (u64 i = 0; i < count; ++i) {
+        string_format(key, "texture_%llu", i);
+        expect_to_be_true(hashtable_set(&table, key, &i));
+    }
+    expect_should_be(count, table.count);
+    b8 under_max_load = table.count * 4 <= table.capacity * 3;
+    expect_to_be_true(under_max_load);
+
+    b8 all_found = true;
+    for (u64 i = 0; i < count; ++i) {
+        string_format(key, "texture_%llu", i);
+        u64* value = hashtable_get(&table, key);
+        all_found = all_found && value && *value == i;
+    }
+    expect_to_be_true(all_found);
+
+    // Every entry is visited exactly once.
+    u64 visited = 0;
+    u64 value_sum = 0;
+    hashtable_iterator it = {0};
+    while (hashtable_next(&table, &it)) {
+        visited++;
+        value_sum += *(u64*)it.value;
+    }
+    expect_should_be(count, visited);
+    expect_should_be((u64)count * (count - 1) / 2, value_sum);
+
+    hashtable_clear(&table);
+    expect_should_be(0, table.count);
+    it = (hashtable_iterator){0};
+    expect_to_be_false(hashtable_next(&table, &it));
+
+    hashtable_destroy(&table);
+    return true;
+}
+
+u8 hashtable_reserve_should_prevent_regrowth() {
+    hashtable table;
+    expect_to_be_true(hashtable_create(sizeof(u32), 0, HASHTABLE_KEY_U64, &table));
+    expect_to_be_true(hashtable_reserve(&table, 1000));
+    u32 capacity = table.capacity;
+    void* keys = table.keys;
+    for (u32 i = 0; i < 1000; ++i) {
+        hashtable_set_u64(&table, hash_u64(i), &i);
+    }
+    expect_should_be(capacity, table.capacity);
+    expect_should_be(keys, table.keys);
+
+    // Reserving less than the current capacity is a no-op.
+    expect_to_be_true(hashtable_reserve(&table, 10));
+    expect_should_be(capacity, table.capacity);
+
+    hashtable_destroy(&table);
+    return true;
+}
+
+void hashtable_register_tests() {
+    test_manager_register_test(hashtable_should_set_get_and_replace_string_keys, "Hashtable should set, get and replace string keys");
+    test_manager_register_test(hashtable_should_remove_and_reuse_slots, "Hashtable should remove keys and reuse their slots");
+    test_manager_register_test(hashtable_should_grow_and_iterate_every_entry, "Hashtable should grow and iterate every entry");
+    test_manager_register_test(hashtable_reserve_should_prevent_regrowth, "Hashtable reserve should prevent regrowth");
+}
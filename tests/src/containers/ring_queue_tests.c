@@ -0,0 +1,143 @@
+#include "ring_queue_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/ring_queue.h>
+
+#include <platform/platform.h>
+
+#define STRESS_PRODUCERS 4
+#define STRESS_ITEMS_PER_PRODUCER 200000
+
+u8 ring_queue_should_be_fifo_and_wrap() {
+    ring_queue queue;
+    expect_to_be_true(ring_queue_create(sizeof(u32), 6, RING_QUEUE_MODE_SINGLE_THREADED, &queue));
+    // Rounded up to a power of two.
+    expect_should_be(8, queue.capacity);
+
+    u32 value = 0;
+    expect_to_be_false(ring_queue_pop(&queue, &value));
+
+    // Several laps, so head and tail wrap around the ring.
+    u32 next_push = 0;
+    u32 next_pop = 0;
+    for (u32 lap = 0; lap < 5; ++lap) {
+        while (ring_queue_push(&queue, &next_push)) {
+            next_push++;
+        }
+        expect_should_be(8, ring_queue_count(&queue));
+        for (u32 i = 0; i < 5; ++i) {
+            expect_to_be_true(ring_queue_pop(&queue, &value));
+            expect_should_be(next_pop, value);
+            next_pop++;
+        }
+    }
+    while (ring_queue_pop(&queue, &value)) {
+        expect_should_be(next_pop, value);
+        next_pop++;
+    }
+    expect_should_be(next_push, next_pop);
+    expect_should_be(0, ring_queue_count(&queue));
+
+    ring_queue_destroy(&queue);
+    return true;
+}
+
+u8 ring_queue_modes_should_agree_single_threaded() {
+    ring_queue_mode modes[] = {RING_QUEUE_MODE_SPSC, RING_QUEUE_MODE_MPSC};
+    for (u32 m = 0; m < 2; ++m) {
+        ring_queue queue;
+        expect_to_be_true(ring_queue_create(sizeof(u64), 4, modes[m], &queue));
+        for (u64 i = 0; i < 4; ++i) {
+            expect_to_be_true(ring_queue_push(&queue, &i));
+        }
+        u64 extra = 99;
+        expect_to_be_false(ring_queue_push(&queue, &extra));
+        u64 value = 0;
+        for (u64 i = 0; i < 4; ++i) {
+            expect_to_be_true(ring_queue_pop(&queue, &value));
+            expect_should_be(i, value);
+        }
+        expect_to_be_false(ring_queue_pop(&queue, &value));
+        ring_queue_destroy(&queue);
+    }
+    return true;
+}
+
+typedef struct producer_args {
+    ring_queue* queue;
+    u64 id;
+} producer_args;
+
+static void produce(void* arg) {
+    producer_args* args = arg;
+    for (u64 i = 0; i < STRESS_ITEMS_PER_PRODUCER; ++i) {
+        // Producer id in the high bits, sequence in the low bits.
+        u64 item = (args->id << 32) | i;
+        while (!ring_queue_push(args->queue, &item)) {
+        }
+    }
+}
+
+/**
+ * @brief Runs producer_count producers against one consumer, checking every
+ * item arrives exactly once and in order per producer.
+ */
+static b8 run_stress(ring_queue_mode mode, u32 producer_count) {
+    ring_queue queue;
+    if (!ring_queue_create(sizeof(u64), 1024, mode, &queue)) {
+        return false;
+    }
+
+    platform_thread threads[STRESS_PRODUCERS];
+    producer_args args[STRESS_PRODUCERS];
+    for (u32 i = 0; i < producer_count; ++i) {
+        args[i] = (producer_args){&queue, i};
+        platform_thread_create(produce, &args[i], &threads[i]);
+    }
+
+    u64 next_expected[STRESS_PRODUCERS] = {0};
+    u64 total = (u64)producer_count * STRESS_ITEMS_PER_PRODUCER;
+    b8 ordered = true;
+    for (u64 received = 0; received < total;) {
+        u64 item;
+        if (!ring_queue_pop(&queue, &item)) {
+            continue;
+        }
+        u64 producer = item >> 32;
+        u64 sequence = item & 0xFFFFFFFF;
+        if (producer >= producer_count || sequence != next_expected[producer]) {
+            ordered = false;
+            break;
+        }
+        next_expected[producer]++;
+        received++;
+    }
+
+    for (u32 i = 0; i < producer_count; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+    u64 leftover;
+    b8 drained = !ring_queue_pop(&queue, &leftover);
+    ring_queue_destroy(&queue);
+    return ordered && drained;
+}
+
+u8 ring_queue_spsc_should_survive_stress() {
+    expect_to_be_true(run_stress(RING_QUEUE_MODE_SPSC, 1));
+    return true;
+}
+
+u8 ring_queue_mpsc_should_survive_stress() {
+    expect_to_be_true(run_stress(RING_QUEUE_MODE_MPSC, STRESS_PRODUCERS));
+    return true;
+}
+
+void ring_queue_register_tests() {
+    test_manager_register_test(ring_queue_should_be_fifo_and_wrap, "Ring queue should be FIFO across wraparound");
+    test_manager_register_test(ring_queue_modes_should_agree_single_threaded, "Ring queue lock-free modes should behave on one thread");
+    test_manager_register_test(ring_queue_spsc_should_survive_stress, "Ring queue SPSC should deliver every item in order across threads");
+    test_manager_register_test(ring_queue_mpsc_should_survive_stress, "Ring queue MPSC should deliver every item in order per producer");
+}
@@ -0,0 +1,127 @@
+#include "soa_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <containers/soa.h>
+#include <math/omath.h>
+
+enum { FIELD_ID, FIELD_WEIGHT, FIELD_NAME };
+
+u8 soa_should_grow_fields_together() {
+    // Fields of different strides, including one that isn't a multiple of 4.
+    u64 strides[] = {sizeof(u32), sizeof(f32), 3};
+    soa s;
+    expect_to_be_true(soa_create(3, strides, 2, &s));
+
+    for (u32 i = 0; i < 1000; ++i) {
+        u64 index;
+        expect_to_be_true(soa_push(&s, &index));
+        expect_should_be(i, index);
+        soa_field_as(&s, u32, FIELD_ID)[index] = i;
+        soa_field_as(&s, f32, FIELD_WEIGHT)[index] = i * 0.5f;
+        soa_field_as(&s, u8, FIELD_NAME)[index * 3 + 2] = (u8)i;
+    }
+    expect_should_be(1000, s.length);
+    b8 has_capacity = s.capacity >= 1000;
+    expect_to_be_true(has_capacity);
+
+    b8 aligned = true;
+    for (u32 f = 0; f < 3; ++f) {
+        aligned = aligned && ((u64)soa_field(&s, f) % SOA_ALIGNMENT) == 0;
+    }
+    expect_to_be_true(aligned);
+
+    b8 values_intact = true;
+    for (u32 i = 0; i < 1000; ++i) {
+        values_intact = values_intact && soa_field_as(&s, u32, FIELD_ID)[i] == i &&
+                        soa_field_as(&s, f32, FIELD_WEIGHT)[i] == i * 0.5f &&
+                        soa_field_as(&s, u8, FIELD_NAME)[i * 3 + 2] == (u8)i;
+    }
+    expect_to_be_true(values_intact);
+
+    soa_destroy(&s);
+    return true;
+}
+
+u8 soa_remove_swap_should_move_last_element_in_every_field() {
+    u64 strides[] = {sizeof(u32), sizeof(f32)};
+    soa s;
+    expect_to_be_true(soa_create(2, strides, 4, &s));
+    for (u32 i = 0; i < 4; ++i) {
+        u64 index;
+        soa_push(&s, &index);
+        soa_field_as(&s, u32, FIELD_ID)[index] = i;
+        soa_field_as(&s, f32, FIELD_WEIGHT)[index] = (f32)i;
+    }
+
+    soa_remove_swap(&s, 1);
+    expect_should_be(3, s.length);
+    expect_should_be(3, soa_field_as(&s, u32, FIELD_ID)[1]);
+    expect_float_to_be(3.0f, soa_field_as(&s, f32, FIELD_WEIGHT)[1]);
+
+    soa_remove_swap(&s, 2);
+    expect_should_be(2, s.length);
+    expect_should_be(0, soa_field_as(&s, u32, FIELD_ID)[0]);
+    expect_should_be(3, soa_field_as(&s, u32, FIELD_ID)[1]);
+
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    soa_remove_swap(&s, 2);
+    expect_should_be(2, s.length);
+
+    // Pushed elements come back zeroed, even over removed ones.
+    u64 index;
+    soa_push(&s, &index);
+    expect_should_be(0, soa_field_as(&s, u32, FIELD_ID)[index]);
+
+    soa_destroy(&s);
+    return true;
+}
+
+u8 soa_kernels_should_match_math_library() {
+    enum { X, Y, Z, VX, VY, VZ, FIELD_COUNT };
+    u64 strides[FIELD_COUNT];
+    for (u32 i = 0; i < FIELD_COUNT; ++i) {
+        strides[i] = sizeof(f32);
+    }
+    soa s;
+    expect_to_be_true(soa_create(FIELD_COUNT, strides, 37, &s));
+    f32* x = 0;
+    f32* y = 0;
+    f32* z = 0;
+    for (u32 i = 0; i < 37; ++i) {
+        u64 index;
+        soa_push(&s, &index);
+        x = soa_field_as(&s, f32, X);
+        y = soa_field_as(&s, f32, Y);
+        z = soa_field_as(&s, f32, Z);
+        soa_vec3_set(x, y, z, index, vec3_create((f32)i, i * 2.0f, -(f32)i));
+        soa_vec3_set(soa_field_as(&s, f32, VX), soa_field_as(&s, f32, VY), soa_field_as(&s, f32, VZ), index,
+                     vec3_one());
+    }
+
+    // Integrate velocity over half a second.
+    soa_f32_add_scaled(x, soa_field_as(&s, f32, VX), 0.5f, s.length);
+    soa_f32_add_scaled(y, soa_field_as(&s, f32, VY), 0.5f, s.length);
+    soa_f32_add_scaled(z, soa_field_as(&s, f32, VZ), 0.5f, s.length);
+
+    mat4 translation = mat4_translation(vec3_create(1.0f, 2.0f, 3.0f));
+    soa_vec3_transform_points(&translation, x, y, z, s.length);
+
+    b8 matches = true;
+    for (u32 i = 0; i < 37; ++i) {
+        vec3 expected = vec3_create(i + 1.5f, i * 2.0f + 2.5f, -(f32)i + 3.5f);
+        matches = matches && vec3_compare(expected, soa_vec3_get(x, y, z, i), 0.0001f);
+    }
+    expect_to_be_true(matches);
+
+    soa_destroy(&s);
+    return true;
+}
+
+void soa_register_tests() {
+    test_manager_register_test(soa_should_grow_fields_together, "SoA should grow all fields together, aligned");
+    test_manager_register_test(soa_remove_swap_should_move_last_element_in_every_field, "SoA remove_swap should move the last element in every field");
+    test_manager_register_test(soa_kernels_should_match_math_library, "SoA kernels should match the math library");
+}
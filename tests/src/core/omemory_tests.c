@@ -0,0 +1,213 @@
+#include "omemory_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/logger.h>
+#include <core/omemory.h>
+#include <core/ostring.h>
+
+#include <platform/platform.h>
+
+u8 omemory_should_track_peak_and_tag_counts() {
+    expect_to_be_true(initialize_memory(1024 * 1024));
+
+    u64 base_count = get_memory_alloc_count();
+    void* a = oallocate(1000, MEMORY_TAG_GAME);
+    void* b = oallocate(3000, MEMORY_TAG_GAME);
+    void* c = oallocate(500, MEMORY_TAG_STRING);
+    expect_should_be(base_count + 3, get_memory_alloc_count());
+    expect_should_be(2, get_memory_tag_alloc_count(MEMORY_TAG_GAME));
+    expect_should_be(1, get_memory_tag_alloc_count(MEMORY_TAG_STRING));
+    expect_should_be(4000, get_memory_tag_usage(MEMORY_TAG_GAME));
+    expect_should_be(4500, get_memory_peak_usage());
+
+    // Freeing lowers usage but not the peak or the counts.
+    ofree(b, 3000, MEMORY_TAG_GAME);
+    expect_should_be(1000, get_memory_tag_usage(MEMORY_TAG_GAME));
+    expect_should_be(4500, get_memory_peak_usage());
+    expect_should_be(2, get_memory_tag_alloc_count(MEMORY_TAG_GAME));
+
+    // A new peak only once usage passes the old one.
+    void* d = oallocate(3500, MEMORY_TAG_ARRAY);
+    expect_should_be(5000, get_memory_peak_usage());
+
+    char* usage = get_memory_usage_str();
+    expect_should_not_be(0, usage);
+    ofree(usage, string_length(usage) + 1, MEMORY_TAG_STRING);
+
+    ofree(a, 1000, MEMORY_TAG_GAME);
+    ofree(c, 500, MEMORY_TAG_STRING);
+    ofree(d, 3500, MEMORY_TAG_ARRAY);
+    expect_should_be(0, get_memory_tag_usage(MEMORY_TAG_GAME));
+
+    shutdown_memory();
+    expect_should_be(0, get_memory_alloc_count());
+
+    return true;
+}
+
+u8 omemory_tracking_should_catch_bad_frees_and_leaks() {
+#if OMEMORY_TRACKING == 1
+    expect_to_be_true(initialize_memory(1024 * 1024));
+    expect_to_be_true(memory_tracking_enable());
+
+    void* a = oallocate(256, MEMORY_TAG_GAME);
+    void* b = oallocate(128, MEMORY_TAG_GAME);
+    void* leaked = oallocate(64, MEMORY_TAG_STRING);
+    expect_should_be(3, memory_tracking_live_count());
+
+    // A double free is reported and ignored rather than corrupting the arena.
+    ofree(a, 256, MEMORY_TAG_GAME);
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    ofree(a, 256, MEMORY_TAG_GAME);
+    expect_should_be(2, memory_tracking_live_count());
+    expect_should_be(128, get_memory_tag_usage(MEMORY_TAG_GAME));
+
+    // A size mismatch is reported; the stats use the allocated size.
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    ofree(b, 100, MEMORY_TAG_GAME);
+    expect_should_be(0, get_memory_tag_usage(MEMORY_TAG_GAME));
+
+    // Enough allocations to grow the table past its initial size.
+    void* blocks[5000];
+    for (u32 i = 0; i < 5000; ++i) {
+        blocks[i] = oallocate(16, MEMORY_TAG_ARRAY);
+    }
+    expect_should_be(5001, memory_tracking_live_count());
+    for (u32 i = 0; i < 5000; ++i) {
+        ofree(blocks[i], 16, MEMORY_TAG_ARRAY);
+    }
+    expect_should_be(0, get_memory_tag_usage(MEMORY_TAG_ARRAY));
+
+    ODEBUG("Note: The following leak report is intentionally caused by this test.");
+    expect_should_be(1, memory_tracking_report_leaks());
+    ofree(leaked, 64, MEMORY_TAG_STRING);
+    expect_should_be(0, memory_tracking_report_leaks());
+
+    shutdown_memory();
+    return true;
+#else
+    return BYPASS;
+#endif
+}
+
+u8 omemory_should_keep_per_frame_history() {
+    expect_to_be_true(initialize_memory(1024 * 1024));
+    // Call sites are only recorded while tracking; the history doesn't need it.
+    if (OMEMORY_TRACKING) {
+        expect_to_be_true(memory_tracking_enable());
+    }
+
+    // Frame 0 allocates twice, frame 1 not at all, frame 2 once.
+    void* a = oallocate(100, MEMORY_TAG_GAME);
+    void* b = oallocate(50, MEMORY_TAG_STRING);
+    memory_frame_end();
+    memory_frame_end();
+    void* c = oallocate(300, MEMORY_TAG_GAME);
+    memory_frame_end();
+
+    memory_frame_stats stats;
+    memory_get_frame_stats(&stats);
+    expect_should_be(3, stats.sample_count);
+    expect_should_be(2, stats.allocating_frames);
+    expect_should_be(0, stats.over_budget_frames);
+    expect_should_be(1, stats.last_alloc_count);
+    expect_should_be(300, stats.last_alloc_bytes);
+    expect_should_be(2, stats.max_alloc_count);
+    expect_should_be(300, stats.max_alloc_bytes);
+    expect_float_to_be(1.0f, (f32)stats.avg_alloc_count);
+    expect_should_be(2, stats.tagged_counts[MEMORY_TAG_GAME]);
+    expect_should_be(400, stats.tagged_bytes[MEMORY_TAG_GAME]);
+    expect_should_be(1, stats.tagged_counts[MEMORY_TAG_STRING]);
+
+    // Frees don't count against a frame.
+    ofree(a, 100, MEMORY_TAG_GAME);
+    ofree(b, 50, MEMORY_TAG_STRING);
+    memory_set_frame_budget(0, 0, false);
+    memory_frame_end();
+    memory_get_frame_stats(&stats);
+    expect_should_be(0, stats.last_alloc_count);
+    expect_should_be(0, stats.over_budget_frames);
+
+    ODEBUG("Note: The following warnings are intentionally caused by this test.");
+    void* d = oallocate(16, MEMORY_TAG_ARRAY);
+    memory_frame_end();
+    memory_get_frame_stats(&stats);
+    expect_should_be(1, stats.over_budget_frames);
+
+    // The window only holds the last MEMORY_FRAME_HISTORY frames.
+    memory_clear_frame_budget();
+    for (u32 i = 0; i < MEMORY_FRAME_HISTORY; ++i) {
+        memory_frame_end();
+    }
+    memory_get_frame_stats(&stats);
+    expect_should_be(MEMORY_FRAME_HISTORY, stats.sample_count);
+    expect_should_be(0, stats.allocating_frames);
+    expect_should_be(0, stats.over_budget_frames);
+
+    memory_log_frame_report();
+
+    ofree(c, 300, MEMORY_TAG_GAME);
+    ofree(d, 16, MEMORY_TAG_ARRAY);
+    shutdown_memory();
+    return true;
+}
+
+#define THREADED_ALLOCATORS 4
+#define THREADED_ITERATIONS 20000
+#define THREADED_LIVE_BLOCKS 32
+
+static void allocate_and_free(void* arg) {
+    u32 seed = *(u32*)arg;
+    void* blocks[THREADED_LIVE_BLOCKS] = {0};
+    u64 sizes[THREADED_LIVE_BLOCKS] = {0};
+    for (u32 i = 0; i < THREADED_ITERATIONS; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        u32 slot = (seed >> 8) % THREADED_LIVE_BLOCKS;
+        if (blocks[slot]) {
+            ofree(blocks[slot], sizes[slot], MEMORY_TAG_JOB);
+        }
+        sizes[slot] = 16 + (seed >> 16) % 512;
+        blocks[slot] = oallocate_uninit(sizes[slot], MEMORY_TAG_JOB);
+    }
+    for (u32 i = 0; i < THREADED_LIVE_BLOCKS; ++i) {
+        if (blocks[i]) {
+            ofree(blocks[i], sizes[i], MEMORY_TAG_JOB);
+        }
+    }
+}
+
+u8 omemory_should_allocate_from_many_threads() {
+    expect_to_be_true(initialize_memory(8 * 1024 * 1024));
+
+    platform_thread threads[THREADED_ALLOCATORS];
+    u32 seeds[THREADED_ALLOCATORS];
+    for (u32 i = 0; i < THREADED_ALLOCATORS; ++i) {
+        seeds[i] = i + 1;
+        expect_to_be_true(platform_thread_create(allocate_and_free, &seeds[i], &threads[i]));
+    }
+    for (u32 i = 0; i < THREADED_ALLOCATORS; ++i) {
+        platform_thread_join(&threads[i]);
+    }
+
+    expect_should_be(0, get_memory_tag_usage(MEMORY_TAG_JOB));
+    expect_should_be(THREADED_ALLOCATORS * THREADED_ITERATIONS, get_memory_tag_alloc_count(MEMORY_TAG_JOB));
+
+    // With every block back, the arena must have merged into one free block
+    // again; a corrupted free list wouldn't fit this.
+    void* large = oallocate(7 * 1024 * 1024, MEMORY_TAG_JOB);
+    expect_should_not_be(0, large);
+    ofree(large, 7 * 1024 * 1024, MEMORY_TAG_JOB);
+
+    shutdown_memory();
+    return true;
+}
+
+void omemory_register_tests() {
+    test_manager_register_test(omemory_should_track_peak_and_tag_counts, "Memory system should track peak usage and per-tag counts");
+    test_manager_register_test(omemory_tracking_should_catch_bad_frees_and_leaks, "Memory tracking should catch bad frees and report leaks");
+    test_manager_register_test(omemory_should_allocate_from_many_threads, "Memory system should allocate and free from many threads");
+    test_manager_register_test(omemory_should_keep_per_frame_history, "Memory system should keep per-frame allocation history");
+}
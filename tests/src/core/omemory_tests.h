@@ -0,0 +1,3 @@
+#pragma once
+
+void omemory_register_tests();
@@ -0,0 +1,118 @@
+#include "profiler_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/omemory.h>
+#include <core/profiler.h>
+
+static void* create_profiler(u64* out_size) {
+    initialize_profiler(out_size, 0);
+    void* state = oallocate(*out_size, MEMORY_TAG_APPLICATION);
+    initialize_profiler(out_size, state);
+    return state;
+}
+
+static void destroy_profiler(void* state, u64 size) {
+    shutdown_profiler(state);
+    ofree(state, size, MEMORY_TAG_APPLICATION);
+}
+
+u8 profiler_should_report_empty_stats() {
+    u64 size = 0;
+    void* state = create_profiler(&size);
+
+    profiler_stats stats;
+    profiler_get_gpu_frame_stats(&stats);
+    expect_should_be(0, stats.sample_count);
+    expect_float_to_be(0.0f, stats.max);
+
+    destroy_profiler(state, size);
+
+    return true;
+}
+
+u8 profiler_should_compute_rolling_stats() {
+    u64 size = 0;
+    void* state = create_profiler(&size);
+
+    // 1..100 ms, shuffled a bit so sorting matters.
+    for (u32 i = 0; i < 100; ++i) {
+        f64 sample = (f64)(((i * 37) % 100) + 1);
+        profiler_report_gpu_frame(0, sample);
+    }
+
+    profiler_stats stats;
+    profiler_get_gpu_frame_stats(&stats);
+    expect_should_be(100, stats.sample_count);
+    expect_float_to_be(1.0f, stats.min);
+    expect_float_to_be(100.0f, stats.max);
+    expect_float_to_be(50.5f, stats.avg);
+    expect_float_to_be(50.0f, stats.p50);
+    expect_float_to_be(95.0f, stats.p95);
+    expect_float_to_be(99.0f, stats.p99);
+
+    destroy_profiler(state, size);
+
+    return true;
+}
+
+u8 profiler_should_keep_only_recent_frames() {
+    u64 size = 0;
+    void* state = create_profiler(&size);
+
+    // Old, slow frames should age out of the window.
+    for (u32 i = 0; i < PROFILER_FRAME_HISTORY; ++i) {
+        profiler_report_gpu_frame(0, 100.0);
+    }
+    for (u32 i = 0; i < PROFILER_FRAME_HISTORY; ++i) {
+        profiler_report_gpu_frame(0, 2.0);
+    }
+
+    profiler_stats stats;
+    profiler_get_gpu_frame_stats(&stats);
+    expect_should_be(PROFILER_FRAME_HISTORY, stats.sample_count);
+    expect_float_to_be(2.0f, stats.max);
+    expect_float_to_be(2.0f, stats.avg);
+
+    destroy_profiler(state, size);
+
+    return true;
+}
+
+u8 profiler_should_track_nested_frames() {
+    u64 size = 0;
+    void* state = create_profiler(&size);
+
+    for (u32 i = 0; i < 3; ++i) {
+        profiler_frame_begin();
+        OPROFILE_ZONE_BEGIN("outer");
+        OPROFILE_ZONE_BEGIN("inner");
+        OPROFILE_ZONE_END();
+        OPROFILE_ZONE_END();
+        profiler_frame_end();
+    }
+    // Unbalanced ends are ignored.
+    profiler_zone_end();
+
+    profiler_stats stats;
+    profiler_get_cpu_frame_stats(&stats);
+    expect_should_be(3, stats.sample_count);
+    b8 ordered = stats.min <= stats.p50 && stats.p50 <= stats.max;
+    expect_to_be_true(ordered);
+
+    // Ending a capture that never started fails.
+    expect_to_be_false(profiler_capture_end("unused_trace.json"));
+
+    destroy_profiler(state, size);
+
+    return true;
+}
+
+void profiler_register_tests() {
+    test_manager_register_test(profiler_should_report_empty_stats, "Profiler should report empty stats");
+    test_manager_register_test(profiler_should_compute_rolling_stats, "Profiler should compute rolling stats");
+    test_manager_register_test(profiler_should_keep_only_recent_frames, "Profiler should keep only recent frames");
+    test_manager_register_test(profiler_should_track_nested_frames, "Profiler should track nested frames");
+}
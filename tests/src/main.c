@@ -1,6 +1,21 @@
 #include "test_manager.h"
 
 #include "memory/linear_allocator_tests.h"
+#include "memory/dynamic_allocator_tests.h"
+#include "memory/pool_allocator_tests.h"
+#include "memory/stack_allocator_tests.h"
+#include "memory/frame_allocator_tests.h"
+#include "memory/virtual_arena_tests.h"
+#include "memory/memory_benchmarks.h"
+#include "containers/darray_tests.h"
+#include "containers/freelist_tests.h"
+#include "containers/handle_table_tests.h"
+#include "containers/hashtable_tests.h"
+#include "containers/ring_queue_tests.h"
+#include "containers/soa_tests.h"
+#include "containers/container_benchmarks.h"
+#include "core/profiler_tests.h"
+#include "core/omemory_tests.h"
 
 #include <core/logger.h>
 
@@ -10,6 +25,23 @@ int main() {
 
     // TODO: add test registrations here.
     linear_allocator_register_tests();
+    dynamic_allocator_register_tests();
+    pool_allocator_register_tests();
+    stack_allocator_register_tests();
+    frame_allocator_register_tests();
+    virtual_arena_register_tests();
+    darray_register_tests();
+    freelist_register_tests();
+    handle_table_register_tests();
+    hashtable_register_tests();
+    ring_queue_register_tests();
+    soa_register_tests();
+    profiler_register_tests();
+    omemory_register_tests();
+
+    // Benchmarks log their timings and only fail on errors.
+    memory_register_benchmarks();
+    container_register_benchmarks();
 
 
     ODEBUG("Starting tests...");
@@ -0,0 +1,207 @@
+#include "dynamic_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/omemory.h>
+#include <memory/dynamic_allocator.h>
+
+static void* create_allocator(u64 total_size, u64* memory_requirement, dynamic_allocator* alloc) {
+    dynamic_allocator_create(total_size, memory_requirement, 0, alloc);
+    void* memory = oallocate(*memory_requirement, MEMORY_TAG_ARRAY);
+    dynamic_allocator_create(total_size, memory_requirement, memory, alloc);
+    return memory;
+}
+
+u8 dynamic_allocator_should_create_and_destroy() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(4096, &memory_requirement, &alloc);
+
+    expect_should_not_be(0, alloc.memory);
+    dynamic_allocator_stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(1, stats.free_block_count);
+    expect_should_be(stats.total_size, stats.free_space);
+    expect_should_be(stats.total_size, stats.largest_free_block);
+    expect_float_to_be(0.0f, stats.fragmentation);
+
+    dynamic_allocator_destroy(&alloc);
+    expect_should_be(0, alloc.memory);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_allocate_aligned_and_free() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(4096, &memory_requirement, &alloc);
+    u64 total = dynamic_allocator_free_space(&alloc);
+
+    void* blocks[8];
+    for (u32 i = 0; i < 8; ++i) {
+        blocks[i] = dynamic_allocator_allocate(&alloc, 1 + i * 13);
+        expect_should_not_be(0, blocks[i]);
+        expect_should_be(0, (u64)blocks[i] % DYNAMIC_ALLOCATOR_ALIGNMENT);
+        expect_to_be_true(dynamic_allocator_owns(&alloc, blocks[i]));
+    }
+    b8 used_space = dynamic_allocator_free_space(&alloc) < total;
+    expect_to_be_true(used_space);
+
+    for (u32 i = 0; i < 8; ++i) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    // Everything merged back into a single block.
+    dynamic_allocator_stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(total, stats.free_space);
+    expect_should_be(1, stats.free_block_count);
+
+    dynamic_allocator_destroy(&alloc);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_coalesce_and_reuse() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(4096, &memory_requirement, &alloc);
+    u64 total = dynamic_allocator_free_space(&alloc);
+
+    void* a = dynamic_allocator_allocate(&alloc, 128);
+    void* b = dynamic_allocator_allocate(&alloc, 128);
+    void* c = dynamic_allocator_allocate(&alloc, 128);
+
+    // a is isolated, c merges with the free tail.
+    dynamic_allocator_free(&alloc, a);
+    dynamic_allocator_free(&alloc, c);
+    dynamic_allocator_stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(2, stats.free_block_count);
+    b8 fragmented = stats.fragmentation > 0.0f;
+    expect_to_be_true(fragmented);
+
+    // Same size as a freed block should land in its hole.
+    void* d = dynamic_allocator_allocate(&alloc, 128);
+    expect_should_be(a, d);
+
+    dynamic_allocator_free(&alloc, d);
+    dynamic_allocator_free(&alloc, b);
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(1, stats.free_block_count);
+    expect_should_be(total, stats.free_space);
+    expect_float_to_be(0.0f, stats.fragmentation);
+
+    dynamic_allocator_destroy(&alloc);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_fail_when_full_and_reject_bad_frees() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(4096, &memory_requirement, &alloc);
+    u64 total = dynamic_allocator_free_space(&alloc);
+
+    // The whole arena in one allocation, then nothing is left.
+    void* block = dynamic_allocator_allocate(&alloc, total);
+    expect_should_not_be(0, block);
+    expect_should_be(0, dynamic_allocator_free_space(&alloc));
+    void* over = dynamic_allocator_allocate(&alloc, 16);
+    expect_should_be(0, over);
+
+    expect_to_be_true(dynamic_allocator_free(&alloc, block));
+    expect_to_be_false(dynamic_allocator_free(&alloc, block));
+
+    u64 outside = 0;
+    expect_to_be_false(dynamic_allocator_owns(&alloc, &outside));
+    expect_to_be_false(dynamic_allocator_free(&alloc, &outside));
+
+    over = dynamic_allocator_allocate(&alloc, total + 1);
+    expect_should_be(0, over);
+    expect_should_be(total, dynamic_allocator_free_space(&alloc));
+
+    dynamic_allocator_destroy(&alloc);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_survive_mixed_sizes() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(1024 * 1024, &memory_requirement, &alloc);
+    u64 total = dynamic_allocator_free_space(&alloc);
+
+    // Small and large sizes, freed out of order.
+    void* blocks[64];
+    for (u32 i = 0; i < 64; ++i) {
+        u64 size = (i % 4 == 0) ? 4096 + i * 100 : 16 + i * 7;
+        blocks[i] = dynamic_allocator_allocate(&alloc, size);
+        expect_should_not_be(0, blocks[i]);
+        oset_memory(blocks[i], (i32)i, size);
+    }
+    for (u32 i = 0; i < 64; i += 2) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    // Surviving blocks must not have been overwritten.
+    for (u32 i = 1; i < 64; i += 2) {
+        expect_should_be(i, ((u8*)blocks[i])[0]);
+    }
+    for (u32 i = 1; i < 64; i += 2) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    expect_should_be(total, dynamic_allocator_free_space(&alloc));
+
+    dynamic_allocator_destroy(&alloc);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_honour_large_alignments() {
+    dynamic_allocator alloc;
+    u64 memory_requirement = 0;
+    void* memory = create_allocator(64 * 1024, &memory_requirement, &alloc);
+    u64 total = dynamic_allocator_free_space(&alloc);
+
+    u64 alignments[5] = {32, 64, 128, 256, 4096};
+    void* blocks[5];
+    // Offset the arena head so the aligned blocks can't land by chance.
+    void* offset = dynamic_allocator_allocate(&alloc, 16);
+    for (u32 i = 0; i < 5; ++i) {
+        blocks[i] = dynamic_allocator_allocate_aligned(&alloc, 100, alignments[i]);
+        expect_should_not_be(0, blocks[i]);
+        expect_should_be(0, (u64)blocks[i] % alignments[i]);
+        oset_memory(blocks[i], 0xFF, 100);
+    }
+    expect_should_be(0, dynamic_allocator_allocate_aligned(&alloc, 16, 48));
+
+    // Aligned blocks free like any other, and the gaps merge back.
+    expect_to_be_true(dynamic_allocator_free(&alloc, offset));
+    for (u32 i = 0; i < 5; ++i) {
+        expect_to_be_true(dynamic_allocator_free(&alloc, blocks[i]));
+    }
+    dynamic_allocator_stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(total, stats.free_space);
+    expect_should_be(1, stats.free_block_count);
+
+    dynamic_allocator_destroy(&alloc);
+    ofree(memory, memory_requirement, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+void dynamic_allocator_register_tests() {
+    test_manager_register_test(dynamic_allocator_should_create_and_destroy, "Dynamic allocator should create and destroy");
+    test_manager_register_test(dynamic_allocator_should_allocate_aligned_and_free, "Dynamic allocator allocate aligned blocks and free");
+    test_manager_register_test(dynamic_allocator_should_coalesce_and_reuse, "Dynamic allocator should coalesce and reuse freed blocks");
+    test_manager_register_test(dynamic_allocator_should_fail_when_full_and_reject_bad_frees, "Dynamic allocator should fail when full and reject bad frees");
+    test_manager_register_test(dynamic_allocator_should_survive_mixed_sizes, "Dynamic allocator should survive mixed sizes");
+    test_manager_register_test(dynamic_allocator_should_honour_large_alignments, "Dynamic allocator should honour large alignments");
+}
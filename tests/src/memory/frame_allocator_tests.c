@@ -0,0 +1,40 @@
+#include "frame_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <memory/frame_allocator.h>
+
+u8 frame_allocator_should_keep_last_frame_until_swap() {
+    frame_allocator alloc;
+    frame_allocator_create(256, 0, &alloc);
+
+    stack_allocator* frame0 = frame_allocator_current(&alloc);
+    u64* value = stack_allocator_allocate(frame0, sizeof(u64));
+    expect_should_not_be(0, value);
+    *value = 1234;
+
+    // The next frame gets the other stack; last frame's data is intact.
+    frame_allocator_swap(&alloc);
+    stack_allocator* frame1 = frame_allocator_current(&alloc);
+    expect_should_not_be(frame0, frame1);
+    expect_should_be(0, frame1->allocated);
+    stack_allocator_allocate(frame1, 64);
+    expect_should_be(1234, *value);
+    expect_should_be(sizeof(u64), frame0->allocated);
+
+    // Swapping back releases frame0's allocations.
+    frame_allocator_swap(&alloc);
+    expect_should_be(frame0, frame_allocator_current(&alloc));
+    expect_should_be(0, frame0->allocated);
+    expect_should_be(64, frame1->allocated);
+
+    frame_allocator_destroy(&alloc);
+
+    return true;
+}
+
+void frame_allocator_register_tests() {
+    test_manager_register_test(frame_allocator_should_keep_last_frame_until_swap, "Frame allocator should keep last frame until swap");
+}
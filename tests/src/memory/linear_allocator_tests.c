@@ -5,6 +5,7 @@
 #include <defines.h>
 
 #include <memory/linear_allocator.h>
+#include <platform/platform.h>
 
 u8 linear_allocator_should_create_and_destroy() {
     linear_allocator alloc;
@@ -108,6 +109,80 @@ u8 linear_allocator_multi_allocation_all_space_then_free() {
     return true;
 }
 
+u8 linear_allocator_aligned_allocation_pads_head() {
+    linear_allocator alloc;
+    linear_allocator_create(1024, 0, &alloc);
+
+    // Knock the head off alignment first.
+    void* block = linear_allocator_allocate(&alloc, 1);
+    expect_should_not_be(0, block);
+
+    block = linear_allocator_allocate_aligned(&alloc, 64, 64);
+    expect_should_not_be(0, block);
+    expect_should_be(0, (u64)block % 64);
+    u64 end = (u64)((u8*)block + 64 - (u8*)alloc.memory);
+    expect_should_be(end, alloc.allocated);
+
+    // Padding counts against the remaining space.
+    linear_allocator_allocate(&alloc, 1);
+    block = linear_allocator_allocate_aligned(&alloc, 1024 - alloc.allocated, 16);
+    expect_should_be(0, block);
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 linear_allocator_reserved_commits_on_demand() {
+    linear_allocator alloc;
+    u64 total_size = 4 * 1024 * 1024;
+    expect_to_be_true(linear_allocator_create_reserved(total_size, false, &alloc));
+    expect_should_be(total_size, alloc.total_size);
+    expect_should_be(0, alloc.committed);
+
+    // The first allocation commits one chunk, and the memory reads as zero.
+    u8* block = linear_allocator_allocate(&alloc, 100);
+    expect_should_not_be(0, block);
+    expect_should_be(LINEAR_ALLOCATOR_COMMIT_SIZE, alloc.committed);
+    expect_should_be(0, block[99]);
+    block[99] = 1;
+
+    // Crossing into later chunks commits only up to the new head.
+    u8* large = linear_allocator_allocate(&alloc, LINEAR_ALLOCATOR_COMMIT_SIZE * 2);
+    expect_should_not_be(0, large);
+    expect_should_be(LINEAR_ALLOCATOR_COMMIT_SIZE * 3, alloc.committed);
+    large[LINEAR_ALLOCATOR_COMMIT_SIZE * 2 - 1] = 1;
+
+    // Running past the reservation still fails cleanly.
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    expect_should_be(0, linear_allocator_allocate(&alloc, total_size));
+
+    linear_allocator_free_all(&alloc);
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(0, block[99]);
+
+    linear_allocator_destroy(&alloc);
+    expect_should_be(0, alloc.memory);
+
+    return true;
+}
+
+u8 linear_allocator_reserved_huge_pages_align_to_huge_page() {
+    linear_allocator alloc;
+    expect_to_be_true(linear_allocator_create_reserved(1024, true, &alloc));
+    expect_should_be(PLATFORM_HUGE_PAGE_SIZE, alloc.total_size);
+    expect_should_be(0, (u64)alloc.memory % PLATFORM_HUGE_PAGE_SIZE);
+
+    u8* block = linear_allocator_allocate(&alloc, 1024);
+    expect_should_not_be(0, block);
+    expect_should_be(PLATFORM_HUGE_PAGE_SIZE, alloc.committed);
+    block[1023] = 1;
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
 void linear_allocator_register_tests() {
     test_manager_register_test(linear_allocator_should_create_and_destroy, "Linear allocator should create and destroy");
     test_manager_register_test(linear_allocator_single_allocation_all_space, "Linear allocator single alloc for all space");
@@ -115,4 +190,7 @@ void linear_allocator_register_tests() {
     test_manager_register_test(linear_allocator_multi_allocation_all_space, "Linear allocator multi alloc for all space");
     test_manager_register_test(linear_allocator_multi_allocation_over_allocate, "Linear allocator try over allocate");
     test_manager_register_test(linear_allocator_multi_allocation_all_space_then_free, "Linear allocator allocated should be 0 after free_all");
+    test_manager_register_test(linear_allocator_aligned_allocation_pads_head, "Linear allocator aligned alloc pads the head");
+    test_manager_register_test(linear_allocator_reserved_commits_on_demand, "Linear allocator over reserved memory commits on demand");
+    test_manager_register_test(linear_allocator_reserved_huge_pages_align_to_huge_page, "Linear allocator with huge pages aligns its reservation");
 } 
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "memory_benchmarks.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <core/clock.h>
+#include <core/logger.h>
+#include <core/omemory.h>
+#include <memory/linear_allocator.h>
+#include <memory/pool_allocator.h>
+
+#define BENCH_BUFFER_SIZE (4 * 1024 * 1024)
+#define BENCH_ITERATIONS 64
+
+/**
+ * @brief Allocates a buffer, fills it the way create_sample_texture does and
+ * frees it again, returning the elapsed seconds.
+ */
+static f64 time_fill_buffers(b8 zeroed, u64* checksum) {
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < BENCH_ITERATIONS; ++i) {
+        u8* buffer = zeroed ? oallocate(BENCH_BUFFER_SIZE, MEMORY_TAG_RENDERER)
+                            : oallocate_uninit(BENCH_BUFFER_SIZE, MEMORY_TAG_RENDERER);
+        oset_memory(buffer, (i32)i, BENCH_BUFFER_SIZE);
+        *checksum += buffer[i];
+        ofree(buffer, BENCH_BUFFER_SIZE, MEMORY_TAG_RENDERER);
+    }
+    clock_update(&timer);
+    return timer.elapsed;
+}
+
+u8 memory_benchmark_uninit_allocation() {
+    // Run against the arena, as the engine does.
+    expect_to_be_true(initialize_memory(64 * 1024 * 1024));
+
+    u64 checksum = 0;
+    // Warm up so both runs see faulted-in pages.
+    time_fill_buffers(true, &checksum);
+    f64 zeroed = time_fill_buffers(true, &checksum);
+    f64 uninit = time_fill_buffers(false, &checksum);
+
+    shutdown_memory();
+
+    OINFO("oallocate + fill: %.3fms, oallocate_uninit + fill: %.3fms (%d x %dKiB, checksum %llu)",
+          zeroed * 1000.0, uninit * 1000.0, BENCH_ITERATIONS, BENCH_BUFFER_SIZE / 1024, checksum);
+    return true;
+}
+
+u8 memory_benchmark_linear_allocator_reset() {
+    u64 total_size = 2 * 1024 * 1024;
+    linear_allocator alloc;
+    linear_allocator_create(total_size, 0, &alloc);
+
+    // A typical frame: a handful of small allocations, then release them all.
+    u32 frames = 1000;
+    clock timer;
+    clock_start(&timer);
+    for (u32 i = 0; i < frames; ++i) {
+        for (u32 j = 0; j < 16; ++j) {
+            linear_allocator_allocate(&alloc, 256);
+        }
+        linear_allocator_free_all(&alloc);
+    }
+    clock_update(&timer);
+    f64 free_all = timer.elapsed;
+
+    clock_start(&timer);
+    for (u32 i = 0; i < frames; ++i) {
+        for (u32 j = 0; j < 16; ++j) {
+            linear_allocator_allocate(&alloc, 256);
+        }
+        linear_allocator_reset(&alloc);
+    }
+    clock_update(&timer);
+    f64 reset = timer.elapsed;
+    expect_should_be(0, alloc.allocated);
+
+    linear_allocator_destroy(&alloc);
+
+    OINFO("linear_allocator free_all: %.3fms, reset: %.3fms (%u frames, %lluKiB)",
+          free_all * 1000.0, reset * 1000.0, frames, total_size / 1024);
+    return true;
+}
+
+#define BENCH_SYSTEMS_SIZE (64 * 1024 * 1024)
+#define BENCH_SYSTEMS_USED (4 * 1024 * 1024)
+
+/**
+ * @brief Sets up a systems allocator the way application_create does and
+ * writes to the part the systems use, returning the elapsed seconds.
+ */
+static f64 time_systems_startup(b8 reserved, linear_allocator* alloc) {
+    clock timer;
+    clock_start(&timer);
+    if (reserved) {
+        linear_allocator_create_reserved(BENCH_SYSTEMS_SIZE, true, alloc);
+    } else {
+        linear_allocator_create(BENCH_SYSTEMS_SIZE, 0, alloc);
+    }
+    u8* block = linear_allocator_allocate(alloc, BENCH_SYSTEMS_USED);
+    oset_memory(block, 1, BENCH_SYSTEMS_USED);
+    clock_update(&timer);
+    return timer.elapsed;
+}
+
+u8 memory_benchmark_reserved_linear_allocator() {
+    u32 rounds = 4;
+    f64 arena = 0;
+    f64 reserved = 0;
+    for (u32 i = 0; i < rounds; ++i) {
+        // A fresh arena each round, so its pages start untouched as they
+        // would at startup.
+        expect_to_be_true(initialize_memory(BENCH_SYSTEMS_SIZE * 2));
+        linear_allocator alloc;
+        arena += time_systems_startup(false, &alloc);
+        expect_should_not_be(0, alloc.memory);
+        linear_allocator_destroy(&alloc);
+        shutdown_memory();
+
+        reserved += time_systems_startup(true, &alloc);
+        expect_should_not_be(0, alloc.memory);
+        linear_allocator_destroy(&alloc);
+    }
+
+    OINFO("systems allocator startup, oallocate: %.3fms, reserved: %.3fms (%lluMiB, %lluMiB used, avg of %u)",
+          arena * 1000.0 / rounds, reserved * 1000.0 / rounds, (u64)BENCH_SYSTEMS_SIZE / (1024 * 1024),
+          (u64)BENCH_SYSTEMS_USED / (1024 * 1024), rounds);
+    return true;
+}
+
+#define BENCH_OBJECT_SIZE 64
+#define BENCH_OBJECT_COUNT 10000
+
+u8 memory_benchmark_pool_allocator() {
+    expect_to_be_true(initialize_memory(64 * 1024 * 1024));
+
+    void** objects = oallocate(sizeof(void*) * BENCH_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    u32 rounds = 20;
+
+    // Allocate a batch, then free every other object and refill the holes,
+    // the way short-lived objects churn.
+    clock timer;
+    clock_start(&timer);
+    for (u32 r = 0; r < rounds; ++r) {
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; ++i) {
+            objects[i] = oallocate(BENCH_OBJECT_SIZE, MEMORY_TAG_ENTITY);
+        }
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; i += 2) {
+            ofree(objects[i], BENCH_OBJECT_SIZE, MEMORY_TAG_ENTITY);
+            objects[i] = oallocate(BENCH_OBJECT_SIZE, MEMORY_TAG_ENTITY);
+        }
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; ++i) {
+            ofree(objects[i], BENCH_OBJECT_SIZE, MEMORY_TAG_ENTITY);
+        }
+    }
+    clock_update(&timer);
+    f64 general = timer.elapsed;
+
+    pool_allocator pool;
+    pool_allocator_create(BENCH_OBJECT_SIZE, 1024, true, MEMORY_TAG_ENTITY, false, &pool);
+    clock_start(&timer);
+    for (u32 r = 0; r < rounds; ++r) {
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; ++i) {
+            objects[i] = pool_allocator_allocate(&pool);
+        }
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; i += 2) {
+            pool_allocator_free(&pool, objects[i]);
+            objects[i] = pool_allocator_allocate(&pool);
+        }
+        for (u32 i = 0; i < BENCH_OBJECT_COUNT; ++i) {
+            pool_allocator_free(&pool, objects[i]);
+        }
+    }
+    clock_update(&timer);
+    f64 pooled = timer.elapsed;
+    expect_should_be(0, pool.allocated_count);
+
+    pool_allocator_destroy(&pool);
+    ofree(objects, sizeof(void*) * BENCH_OBJECT_COUNT, MEMORY_TAG_ARRAY);
+    shutdown_memory();
+
+    OINFO("oallocate: %.3fms, pool_allocator: %.3fms (%u rounds of %d x %dB objects)",
+          general * 1000.0, pooled * 1000.0, rounds, BENCH_OBJECT_COUNT, BENCH_OBJECT_SIZE);
+    return true;
+}
+
+void memory_register_benchmarks() {
+    test_manager_register_test(memory_benchmark_uninit_allocation, "Benchmark oallocate vs oallocate_uninit");
+    test_manager_register_test(memory_benchmark_linear_allocator_reset, "Benchmark linear allocator free_all vs reset");
+    test_manager_register_test(memory_benchmark_pool_allocator, "Benchmark pool allocator vs oallocate");
+    test_manager_register_test(memory_benchmark_reserved_linear_allocator, "Benchmark reserved vs oallocate systems allocator");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void memory_register_benchmarks();
@@ -0,0 +1,145 @@
+#include "pool_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <memory/pool_allocator.h>
+
+typedef struct test_object {
+    u64 id;
+    f32 values[5];
+} test_object;
+
+u8 pool_allocator_should_create_and_destroy() {
+    pool_allocator pool;
+    expect_to_be_true(pool_allocator_create(sizeof(test_object), 16, false, MEMORY_TAG_ENTITY, false, &pool));
+
+    expect_should_not_be(0, pool.chunks);
+    expect_should_not_be(0, pool.free_list);
+    expect_should_be(1, pool.chunk_count);
+    expect_should_be(0, pool.allocated_count);
+    expect_should_be(0, pool.slot_size % sizeof(void*));
+
+    pool_allocator_destroy(&pool);
+    expect_should_be(0, pool.chunks);
+    expect_should_be(0, pool.chunk_count);
+
+    return true;
+}
+
+u8 pool_allocator_should_reuse_freed_slots() {
+    pool_allocator pool;
+    pool_allocator_create(sizeof(test_object), 4, false, MEMORY_TAG_ENTITY, false, &pool);
+
+    test_object* a = pool_allocator_allocate(&pool);
+    test_object* b = pool_allocator_allocate(&pool);
+    expect_should_not_be(0, a);
+    expect_should_not_be(0, b);
+    expect_should_not_be(a, b);
+    expect_should_be(2, pool.allocated_count);
+    a->id = 42;
+    b->id = 43;
+
+    // The most recently freed slot comes back first, zeroed.
+    expect_to_be_true(pool_allocator_free(&pool, a));
+    test_object* c = pool_allocator_allocate(&pool);
+    expect_should_be(a, c);
+    expect_should_be(0, c->id);
+    expect_should_be(43, b->id);
+
+    pool_allocator_destroy(&pool);
+
+    return true;
+}
+
+u8 pool_allocator_should_fail_when_full_without_growth() {
+    pool_allocator pool;
+    pool_allocator_create(sizeof(test_object), 4, false, MEMORY_TAG_ENTITY, false, &pool);
+
+    void* slots[4];
+    for (u32 i = 0; i < 4; ++i) {
+        slots[i] = pool_allocator_allocate(&pool);
+        expect_should_not_be(0, slots[i]);
+    }
+    void* over = pool_allocator_allocate(&pool);
+    expect_should_be(0, over);
+    expect_should_be(1, pool.chunk_count);
+
+    // Freeing one makes room again.
+    pool_allocator_free(&pool, slots[2]);
+    over = pool_allocator_allocate(&pool);
+    expect_should_be(slots[2], over);
+
+    pool_allocator_destroy(&pool);
+
+    return true;
+}
+
+u8 pool_allocator_should_grow_by_chunk() {
+    pool_allocator pool;
+    pool_allocator_create(sizeof(test_object), 8, true, MEMORY_TAG_ENTITY, false, &pool);
+
+    test_object* objects[20];
+    for (u32 i = 0; i < 20; ++i) {
+        objects[i] = pool_allocator_allocate(&pool);
+        expect_should_not_be(0, objects[i]);
+        objects[i]->id = i;
+    }
+    expect_should_be(3, pool.chunk_count);
+    expect_should_be(20, pool.allocated_count);
+
+    // Slots from earlier chunks are untouched by growth.
+    for (u32 i = 0; i < 20; ++i) {
+        expect_should_be(i, objects[i]->id);
+        expect_to_be_true(pool_allocator_owns(&pool, objects[i]));
+    }
+    for (u32 i = 0; i < 20; ++i) {
+        expect_to_be_true(pool_allocator_free(&pool, objects[i]));
+    }
+    expect_should_be(0, pool.allocated_count);
+
+    pool_allocator_destroy(&pool);
+
+    return true;
+}
+
+u8 pool_allocator_poison_should_catch_bad_frees() {
+    pool_allocator pool;
+    pool_allocator_create(sizeof(test_object), 4, false, MEMORY_TAG_ENTITY, true, &pool);
+    expect_to_be_true(pool.poison_freed);
+
+    test_object* a = pool_allocator_allocate(&pool);
+    // Freed slots are poisoned past the free list link.
+    pool_allocator_free(&pool, a);
+    u8* bytes = (u8*)a;
+    expect_should_be(POOL_ALLOCATOR_POISON_BYTE, bytes[pool.slot_size - 1]);
+
+    // Pointers into a slot, or from elsewhere, are rejected.
+    a = pool_allocator_allocate(&pool);
+    expect_to_be_false(pool_allocator_free(&pool, (u8*)a + 4));
+    test_object outside;
+    expect_to_be_false(pool_allocator_free(&pool, &outside));
+    expect_should_be(1, pool.allocated_count);
+
+    // A second free is rejected, so the slot isn't handed out twice.
+    expect_to_be_true(pool_allocator_free(&pool, a));
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    expect_to_be_false(pool_allocator_free(&pool, a));
+    expect_should_be(0, pool.allocated_count);
+    test_object* b = pool_allocator_allocate(&pool);
+    test_object* c = pool_allocator_allocate(&pool);
+    expect_should_not_be(b, c);
+
+    pool_allocator_destroy(&pool);
+
+    return true;
+}
+
+void pool_allocator_register_tests() {
+    test_manager_register_test(pool_allocator_should_create_and_destroy, "Pool allocator should create and destroy");
+    test_manager_register_test(pool_allocator_should_reuse_freed_slots, "Pool allocator should reuse freed slots");
+    test_manager_register_test(pool_allocator_should_fail_when_full_without_growth, "Pool allocator should fail when full without growth");
+    test_manager_register_test(pool_allocator_should_grow_by_chunk, "Pool allocator should grow by chunk");
+    test_manager_register_test(pool_allocator_poison_should_catch_bad_frees, "Pool allocator poison should catch bad frees");
+}
@@ -0,0 +1,81 @@
+#include "stack_allocator_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <memory/stack_allocator.h>
+
+u8 stack_allocator_should_create_and_destroy() {
+    stack_allocator alloc;
+    stack_allocator_create(1024, 0, &alloc);
+
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(1024, alloc.total_size);
+    expect_should_be(0, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.total_size);
+
+    return true;
+}
+
+u8 stack_allocator_should_free_to_marker() {
+    stack_allocator alloc;
+    stack_allocator_create(1024, 0, &alloc);
+
+    void* kept = stack_allocator_allocate(&alloc, 100);
+    expect_should_not_be(0, kept);
+    stack_allocator_marker marker = stack_allocator_get_marker(&alloc);
+    expect_should_be(100, marker);
+
+    // Scoped temporaries, released together.
+    void* temp0 = stack_allocator_allocate(&alloc, 200);
+    void* temp1 = stack_allocator_allocate(&alloc, 300);
+    expect_should_not_be(0, temp0);
+    expect_should_not_be(0, temp1);
+    expect_should_be(600, alloc.allocated);
+
+    stack_allocator_free_to_marker(&alloc, marker);
+    expect_should_be(100, alloc.allocated);
+
+    // The next allocation reuses the released space.
+    void* again = stack_allocator_allocate(&alloc, 200);
+    expect_should_be(temp0, again);
+
+    // A marker above the top is rejected.
+    stack_allocator_free_to_marker(&alloc, 1000);
+    expect_should_be(300, alloc.allocated);
+
+    stack_allocator_free_all(&alloc);
+    expect_should_be(0, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 stack_allocator_should_align_and_fail_when_full() {
+    stack_allocator alloc;
+    stack_allocator_create(256, 0, &alloc);
+
+    stack_allocator_allocate(&alloc, 1);
+    void* block = stack_allocator_allocate_aligned(&alloc, 64, 64);
+    expect_should_not_be(0, block);
+    expect_should_be(0, (u64)block % 64);
+
+    void* over = stack_allocator_allocate(&alloc, 256);
+    expect_should_be(0, over);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+void stack_allocator_register_tests() {
+    test_manager_register_test(stack_allocator_should_create_and_destroy, "Stack allocator should create and destroy");
+    test_manager_register_test(stack_allocator_should_free_to_marker, "Stack allocator should free to marker");
+    test_manager_register_test(stack_allocator_should_align_and_fail_when_full, "Stack allocator should align and fail when full");
+}
@@ -0,0 +1,50 @@
+#include "virtual_arena_tests.h"
+#include "../test_manager.h"
+#include "../expect.h"
+
+#include <defines.h>
+
+#include <memory/virtual_arena.h>
+#include <platform/platform.h>
+
+u8 virtual_arena_should_commit_on_demand() {
+    u64 page_size = platform_get_page_size();
+    virtual_arena arena;
+    expect_to_be_true(virtual_arena_create(page_size * 64, &arena));
+    expect_should_be(page_size * 64, arena.reserved_size);
+    expect_should_be(0, arena.committed_size);
+
+    // Commits round up to whole pages.
+    expect_to_be_true(virtual_arena_commit(&arena, 1));
+    expect_should_be(page_size, arena.committed_size);
+    u8* memory = arena.memory;
+    expect_should_be(0, memory[page_size - 1]);
+    memory[page_size - 1] = 7;
+
+    // Growing keeps the base address and existing contents.
+    void* base = arena.memory;
+    expect_to_be_true(virtual_arena_commit(&arena, page_size * 10));
+    expect_should_be(base, arena.memory);
+    expect_should_be(page_size * 10, arena.committed_size);
+    expect_should_be(7, memory[page_size - 1]);
+    memory[page_size * 10 - 1] = 7;
+
+    // Decommitted pages read as zero once committed again.
+    virtual_arena_decommit(&arena, page_size);
+    expect_should_be(page_size, arena.committed_size);
+    expect_to_be_true(virtual_arena_commit(&arena, page_size * 10));
+    expect_should_be(0, memory[page_size * 10 - 1]);
+    expect_should_be(7, memory[page_size - 1]);
+
+    ODEBUG("Note: The following error is intentionally caused by this test.");
+    expect_to_be_false(virtual_arena_commit(&arena, page_size * 65));
+
+    virtual_arena_destroy(&arena);
+    expect_should_be(0, arena.memory);
+
+    return true;
+}
+
+void virtual_arena_register_tests() {
+    test_manager_register_test(virtual_arena_should_commit_on_demand, "Virtual arena should commit on demand");
+}